@@ -638,7 +638,9 @@ class mphf {
             collisions.atomic_test_and_set(hashl);
     }
 
-    void processHash(internal_hash_t val, unsigned i, bitVector &collisions) {
+    // Single-range builds are sequential and do not touch OpenMP at all, so
+    // they are safe in forked processes
+    void processHash(internal_hash_t val, unsigned i, bitVector &collisions, bool concurrent) {
         unsigned level; uint64_t level_hash;
         level_hash = getLevel(val, &level, i);
 
@@ -660,27 +662,32 @@ class mphf {
             uint64_t hashidx =  __sync_fetch_and_add(&_final_hashidx, 1);
 
             // calc rank de fin  precedent level qq part, puis init hashidx avec ce rank, direct minimal, pas besoin inser ds bitset et rank
-#           pragma omp critical
-            {
-                if (_final_hash.count(val)) { // key already in final hash
-                    if (_policy == ConflictPolicy::Ignore) {
-                        _final_hash[val] = NOT_FOUND;
-                    } else {
-                        fprintf(stderr,"The impossible happened : collision on 128 bit hashes... please switch to safe branch, and play the lottery.");
-                        fprintf(stderr,"Another more likely explanation might be that you have duplicate keys in your input.\
-                                        If so, you can ignore this message, but be aware that too many duplicate keys will increase ram usage\n");
-                        if (_policy == ConflictPolicy::Error)
-                            abort();
-                    }
-                } else {
-                    _final_hash[val] = hashidx;
-                }
-            }
+            if (concurrent) {
+#               pragma omp critical
+                insertIntoFinalHash(val, hashidx);
+            } else
+                insertIntoFinalHash(val, hashidx);
         } else {
             insertIntoLevel(level_hash, i, collisions); //should be safe
         }
     }
 
+    void insertIntoFinalHash(internal_hash_t val, uint64_t hashidx) {
+        if (_final_hash.count(val)) { // key already in final hash
+            if (_policy == ConflictPolicy::Ignore) {
+                _final_hash[val] = NOT_FOUND;
+            } else {
+                fprintf(stderr,"The impossible happened : collision on 128 bit hashes... please switch to safe branch, and play the lottery.");
+                fprintf(stderr,"Another more likely explanation might be that you have duplicate keys in your input.\
+                                If so, you can ignore this message, but be aware that too many duplicate keys will increase ram usage\n");
+                if (_policy == ConflictPolicy::Error)
+                    abort();
+            }
+        } else {
+            _final_hash[val] = hashidx;
+        }
+    }
+
     template<typename Range>
     void processLevel(Range const& input_range,
                       unsigned level, bitVector &collisions) {
@@ -691,10 +698,10 @@ class mphf {
 
         if (_fastmode && level > _fastModeLevel) {
             for (const auto &entry : setLevelFastmode)
-                processHash(_hasher.hashpair128(entry), level, collisions);
+                processHash(_hasher.hashpair128(entry), level, collisions, /* concurrent */ false);
         } else {
             for (const auto &entry : input_range)
-                processHash(_hasher.hashpair128(entry), level, collisions);
+                processHash(_hasher.hashpair128(entry), level, collisions, /* concurrent */ false);
         }
 
         if (_fastmode && level == _fastModeLevel) { //shrink to actual number of elements in set
@@ -714,13 +721,13 @@ class mphf {
         if (_fastmode && level > _fastModeLevel) {
 #           pragma omp parallel for num_threads(nthreads)
             for (size_t i = 0; i < setLevelFastmode.size(); ++i) {
-                processHash(_hasher.hashpair128(setLevelFastmode[i]), level, collisions);
+                processHash(_hasher.hashpair128(setLevelFastmode[i]), level, collisions, /* concurrent */ true);
             }
         } else {
 #           pragma omp parallel for num_threads(nthreads)
             for (size_t i = 0; i < ranges.size(); ++i) {
                 for (const auto &entry : ranges[i])
-                    processHash(_hasher.hashpair128(entry), level, collisions);
+                    processHash(_hasher.hashpair128(entry), level, collisions, /* concurrent */ true);
             }
         }
 
@@ -342,8 +342,8 @@ inline std::size_t ThreadPool::get_dispatch_worker()
 {
   // For now we dispatch at random. If the random index is on a worker that is
   // stopped but now yet cleaned, return another idx;
-  static std::random_device seeder;
-  static std::mt19937 engine(seeder());
+  // The engine is per thread: tasks may be submitted from several threads
+  static thread_local std::mt19937 engine(std::random_device{}());
   std::uniform_int_distribution<int> dist(0, pool.size() - 1);
   return dist(engine);
 }
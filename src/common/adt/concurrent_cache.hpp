@@ -0,0 +1,132 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+namespace adt {
+
+// Fixed-size set-associative cache safe for concurrent use. Every slot is
+// guarded by its own version counter (seqlock): readers never block and treat
+// a slot being rewritten as a miss, a writer drops the value if another one
+// holds the slot. Inserting into a full set evicts its entries in round-robin
+// order, so the memory footprint is fixed at construction. The set is chosen
+// by the low bits of the hash, so the hash has to mix them well.
+template<class Key, class Value, class Hash = std::hash<Key>, size_t Ways = 4>
+class concurrent_cache {
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value,
+                  "concurrent_cache keeps keys and values as raw words");
+
+    static constexpr size_t WORDS = (sizeof(Key) + sizeof(Value) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct slot {
+        // Zero for an empty slot, odd while the slot is being written
+        std::atomic<uint64_t> version{0};
+        std::atomic<uint64_t> words[WORDS];
+    };
+
+    struct alignas(64) set {
+        slot slots[Ways];
+        std::atomic<uint32_t> victim{0};
+    };
+
+public:
+    explicit concurrent_cache(size_t capacity, const Hash &hash = Hash())
+            : hash_(hash) {
+        size_t sets = 1;
+        while (sets * Ways < capacity)
+            sets <<= 1;
+        mask_ = sets - 1;
+        sets_.reset(new set[sets]);
+    }
+
+    size_t capacity() const { return (mask_ + 1) * Ways; }
+
+    bool find(const Key &key, Value &value) const {
+        const set &s = sets_[hash_(key) & mask_];
+        for (const slot &sl : s.slots) {
+            if (Match(sl, key, value))
+                return true;
+        }
+
+        return false;
+    }
+
+    // Returns false if the value was dropped due to a concurrent write
+    bool insert(const Key &key, const Value &value) {
+        set &s = sets_[hash_(key) & mask_];
+
+        // Overwrite the same key or fill an empty slot, if any
+        slot *target = nullptr;
+        for (slot &sl : s.slots) {
+            uint64_t version = sl.version.load(std::memory_order_acquire);
+            if (version == 0) {
+                if (!target)
+                    target = &sl;
+                continue;
+            }
+
+            Value v;
+            if (Match(sl, key, v)) {
+                target = &sl;
+                break;
+            }
+        }
+
+        if (!target)
+            target = &s.slots[s.victim.fetch_add(1, std::memory_order_relaxed) % Ways];
+
+        uint64_t version = target->version.load(std::memory_order_relaxed);
+        if (version & 1 ||
+            !target->version.compare_exchange_strong(version, version + 1, std::memory_order_acquire))
+            return false;
+        std::atomic_thread_fence(std::memory_order_release);
+
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &key, sizeof(Key));
+        std::memcpy(reinterpret_cast<char*>(words) + sizeof(Key), &value, sizeof(Value));
+        for (size_t i = 0; i < WORDS; ++i)
+            target->words[i].store(words[i], std::memory_order_relaxed);
+
+        target->version.store(version + 2, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // Reads a consistent snapshot of the slot, a slot being written never matches
+    bool Match(const slot &sl, const Key &key, Value &value) const {
+        uint64_t version = sl.version.load(std::memory_order_acquire);
+        if (version == 0 || version & 1)
+            return false;
+
+        uint64_t words[WORDS];
+        for (size_t i = 0; i < WORDS; ++i)
+            words[i] = sl.words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sl.version.load(std::memory_order_relaxed) != version)
+            return false;
+
+        Key k;
+        std::memcpy(&k, words, sizeof(Key));
+        if (!(k == key))
+            return false;
+
+        std::memcpy(&value, reinterpret_cast<const char*>(words) + sizeof(Key), sizeof(Value));
+        return true;
+    }
+
+    Hash hash_;
+    size_t mask_;
+    std::unique_ptr<set[]> sets_;
+};
+
+} // namespace adt
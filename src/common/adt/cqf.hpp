@@ -8,6 +8,7 @@
 #pragma once
 
 #include "gqf/gqf.h"
+#include <algorithm>
 #include <mutex>
 #include <cmath>
 #include <cstring>
@@ -28,7 +29,7 @@ class cqf {
 
     cqf(uint64_t maxn)
             : insertions_(0) {
-        unsigned qbits = std::max(7u, unsigned(ceil(log2(double(maxn))))) + 1;
+        unsigned qbits = quotient_bits(maxn);
         num_hash_bits_ = qbits + 8;
         num_slots_ = (1ULL << qbits);
         qf_init(&qf_, num_slots_, num_hash_bits_, 0, 42);
@@ -36,6 +37,12 @@ class cqf {
         assert((range_mask_ & qf_.metadata->range) == 0);
         // fprintf(stderr, "%llu %llu %u %llu\n", maxn, num_slots_, num_hash_bits_, qf_.metadata->range);
     }
+    // Memory allocated by cqf(maxn): a block of 64 slots takes 64 bytes of
+    // remainders and 17 bytes of metadata
+    static uint64_t memory_estimate(uint64_t maxn) {
+        return (1ULL << quotient_bits(maxn)) * 81 / 64;
+    }
+
     cqf(uint64_t num_slots, unsigned hash_bits)
             : num_hash_bits_(hash_bits), num_slots_(num_slots), insertions_(0) {
         qf_init(&qf_, num_slots_, num_hash_bits_, 0, 239);
@@ -101,6 +108,10 @@ class cqf {
     }
 
 private:
+    static unsigned quotient_bits(uint64_t maxn) {
+        return std::max(7u, unsigned(ceil(log2(double(maxn))))) + 1;
+    }
+
     void merge(QF *qf, QF *other) {
         QFi other_cfi;
 
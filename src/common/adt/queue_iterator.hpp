@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <queue>
+#include <type_traits>
 #include <vector>
 
 namespace {
@@ -186,9 +187,197 @@ public:
 
     template <class InputIterator>
     void insert(InputIterator begin, InputIterator end) {
+        auto &storage = queue_.c;
+        size_t old_size = storage.size();
         for (; begin != end; ++begin) {
-            push(*begin);
+            auto p = get_stored(*begin);
+            storage.push_back(p);
+            set_.insert(p);
+        }
+
+        // Heapify the bulk at once instead of sifting up every element
+        if (old_size == 0)
+            std::make_heap(storage.begin(), storage.end(), simple_greater());
+        else
+            for (size_t i = old_size; i < storage.size(); ++i)
+                std::push_heap(storage.begin(), storage.begin() + i + 1, simple_greater());
+    }
+};
+
+// Priority queue for small unsigned priorities (e.g. edge length). Elements
+// are kept in buckets indexed by priority, the ones with priority beyond the
+// bucket range go to a binary heap. The order of elements is the same as for
+// erasable_priority_queue_key_dirty_heap: by priority, then by key. Bulk
+// insertion is a single pass, buckets are sorted only when they reach the top.
+// Deletion is lazy: erased elements are only dropped from the index of live
+// ones and skipped once they reach the top.
+template<typename T, typename Priority>
+class bucket_priority_queue {
+private:
+    using PriorityValue = std::decay_t<decltype(std::declval<Priority>()(T()))>;
+    static_assert(std::is_unsigned<PriorityValue>::value, "bucket queue requires unsigned priorities");
+    using StoredType = std::pair<PriorityValue, T>;
+
+    Priority priority_;
+    size_t max_buckets_;
+    // Clean buckets are sorted in descending order, so the top is at the back
+    std::vector<std::vector<T>> buckets_;
+    std::vector<uint8_t> dirty_;
+    // All the buckets before the current one are empty
+    size_t current_ = 0;
+    std::priority_queue<StoredType, std::vector<StoredType>, simple_greater> overflow_;
+    // Live elements together with the priority they were pushed with
+    phmap::flat_hash_map<T, PriorityValue> live_;
+    // Number of stored entries including the erased ones
+    size_t stored_ = 0;
+
+    bool is_live(const T &key, PriorityValue p) const {
+        auto it = live_.find(key);
+        return it != live_.end() && it->second == p;
+    }
+
+    void append(const T &key, PriorityValue p) {
+        ++stored_;
+        if (p >= max_buckets_) {
+            overflow_.emplace(p, key);
+            return;
+        }
+
+        if (p >= buckets_.size()) {
+            buckets_.resize(p + 1);
+            dirty_.resize(p + 1, false);
+        }
+        buckets_[p].push_back(key);
+        dirty_[p] = true;
+        current_ = std::min(current_, size_t(p));
+    }
+
+    void skip() {
+        for (; current_ < buckets_.size(); ++current_) {
+            auto &bucket = buckets_[current_];
+            if (dirty_[current_]) {
+                std::sort(bucket.begin(), bucket.end(), simple_greater());
+                dirty_[current_] = false;
+            }
+            while (!bucket.empty() && !is_live(bucket.back(), PriorityValue(current_))) {
+                bucket.pop_back();
+                --stored_;
+            }
+            if (!bucket.empty())
+                return;
+        }
+
+        while (!overflow_.empty() && !is_live(overflow_.top().second, overflow_.top().first)) {
+            overflow_.pop();
+            --stored_;
+        }
+    }
+
+    // Returns false if the element is already there with the same priority
+    bool update_live(const T &key, PriorityValue p) {
+        auto res = live_.emplace(key, p);
+        if (res.second)
+            return true;
+        if (res.first->second == p)
+            return false;
+
+        // The entry with the old priority becomes stale
+        res.first->second = p;
+        return true;
+    }
+
+public:
+    bucket_priority_queue(size_t max_buckets = 1 << 16)
+            : max_buckets_(max_buckets) {}
+    bucket_priority_queue(Priority priority, size_t max_buckets = 1 << 16)
+            : priority_(std::move(priority)), max_buckets_(max_buckets) {}
+
+    template<typename InputIterator>
+    bucket_priority_queue(InputIterator begin, InputIterator end,
+                          Priority priority, size_t max_buckets = 1 << 16)
+            : priority_(std::move(priority)), max_buckets_(max_buckets) {
+        insert(begin, end);
+    }
+
+    void pop() {
+        VERIFY(!live_.empty());
+        if (current_ < buckets_.size()) {
+            live_.erase(buckets_[current_].back());
+            buckets_[current_].pop_back();
+        } else {
+            live_.erase(overflow_.top().second);
+            overflow_.pop();
         }
+        --stored_;
+        skip();
+    }
+
+    const T& top() const {
+        VERIFY(!live_.empty());
+        return current_ < buckets_.size() ? buckets_[current_].back() : overflow_.top().second;
+    }
+
+    // Pushing an element which is already there updates its priority
+    void push(const T &key) {
+        PriorityValue p = priority_(key);
+        if (!update_live(key, p))
+            return;
+
+        if (p == current_ && current_ < buckets_.size() && !dirty_[current_]) {
+            // Keep the top bucket sorted
+            auto &bucket = buckets_[current_];
+            bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), key, simple_greater()), key);
+            ++stored_;
+        } else {
+            append(key, p);
+        }
+        skip();
+    }
+
+    bool erase(const T &key) {
+        bool res = live_.erase(key) > 0;
+        skip();
+        if (2 * live_.size() < stored_)
+            compress();
+        return res;
+    }
+
+    void clear() {
+        buckets_.clear();
+        dirty_.clear();
+        current_ = 0;
+        overflow_ = decltype(overflow_)();
+        live_.clear();
+        stored_ = 0;
+    }
+
+    void compress() {
+        for (auto &bucket : buckets_)
+            bucket.clear();
+        overflow_ = decltype(overflow_)();
+        current_ = buckets_.size();
+        stored_ = 0;
+        for (const auto &entry : live_)
+            append(entry.first, entry.second);
+        skip();
+    }
+
+    bool empty() const {
+        return live_.empty();
+    }
+
+    size_t size() const {
+        return live_.size();
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator begin, InputIterator end) {
+        for (; begin != end; ++begin) {
+            PriorityValue p = priority_(*begin);
+            if (update_live(*begin, p))
+                append(*begin, p);
+        }
+        skip();
     }
 };
 
@@ -519,9 +708,10 @@ public:
 };
 
 // Iterator over queue that is ordered using Priority
-template<typename T, typename Priority = identity>
-class DynamicQueueIteratorKey : public DynamicQueueIteratorBase<T, erasable_priority_queue_key_dirty_heap<T, Priority>> {
-    using base = DynamicQueueIteratorBase<T, erasable_priority_queue_key_dirty_heap<T, Priority>>;
+template<typename T, typename Priority = identity,
+         typename Queue = erasable_priority_queue_key_dirty_heap<T, Priority>>
+class DynamicQueueIteratorKey : public DynamicQueueIteratorBase<T, Queue> {
+    using base = DynamicQueueIteratorBase<T, Queue>;
 public:
     DynamicQueueIteratorKey(const Priority &priority = Priority())
             : base(priority) {}
@@ -52,28 +52,49 @@ void DijkstraGraphSequenceBase::Update(const QueueState &state, const QueueState
     }
 }
 
+const MyersProfile &DijkstraGraphSequenceBase::SuffixProfile(int from) {
+    if (from == 0)
+        return ss_profile_;
+    if (from != suffix_from_) {
+        suffix_profile_ = MyersProfile(ss_profile_, from, ss_.size() - from);
+        suffix_from_ = from;
+    }
+    return suffix_profile_;
+}
+
+const MyersProfile &DijkstraGraphSequenceBase::EdgeProfile(EdgeId e) {
+    auto it = edge_profiles_.find(e);
+    if (it == edge_profiles_.end())
+        it = edge_profiles_.emplace(e, MyersProfile(g_.EdgeNucls(e).Subseq(0, g_.length(e)))).first;
+    return it->second;
+}
+
 void DijkstraGraphSequenceBase::AddNewEdge(const GraphState &gs, const QueueState &prev_state, int ed) {
-    string edge_str = g_.EdgeNucls(gs.e).Subseq(gs.start_pos, gs.end_pos).str();
-    if (0 == edge_str.size()) {
+    int edge_len = gs.end_pos - gs.start_pos;
+    if (0 == edge_len) {
         QueueState state(gs, prev_state.i);
         Update(state, prev_state,  ed);
         return;
     }
     if (path_max_length_ - ed >= 0) {
-        if (path_max_length_ - ed >= (int) edge_str.size()) {
+        if (path_max_length_ - ed >= edge_len) {
             QueueState state(gs, prev_state.i);
-            Update(state, prev_state,  ed + (int) edge_str.size());
+            Update(state, prev_state,  ed + edge_len);
         }
     }
     if (ss_.size() - prev_state.i > 0) {
         // len - is a maximum length of substring to align on current edge
         int len = min( (int) g_.length(gs.e) - gs.start_pos + path_max_length_, // length of current edge + maximum insertion size
                        (int) ss_.size() - prev_state.i  ); // length of suffix left
-        string seq_str = ss_.substr(prev_state.i, len);
         vector<int> positions;
         vector<int> scores;
         if (path_max_length_ - ed >= 0) {
-            SHWDistanceExtended(seq_str, edge_str, path_max_length_ - ed, positions, scores);
+            // Whole edges are aligned over and over from different states, so their profiles are kept
+            if (gs.start_pos == 0 && gs.end_pos == (int) g_.length(gs.e))
+                EdgeProfile(gs.e).PrefixScores(ss_codes_.data() + prev_state.i, len, path_max_length_ - ed, positions, scores);
+            else
+                MyersProfile(g_.EdgeNucls(gs.e).Subseq(gs.start_pos, gs.end_pos))
+                        .PrefixScores(ss_codes_.data() + prev_state.i, len, path_max_length_ - ed, positions, scores);
             int prev_score = numeric_limits<int>::max();
             for (size_t i = 0; i < positions.size(); ++ i) {
                 if (positions[i] >= 0 && scores[i] >= 0) {
@@ -196,10 +217,9 @@ bool DijkstraEndsReconstructor::AddState(const QueueState &cur_state, EdgeId e,
     VERIFY(ss_.size() >= (size_t) cur_state.i)
     size_t remaining = ss_.size() - cur_state.i;
     if (g_.length(e) + g_.k() + path_max_length_ - ed > remaining && path_max_length_ - ed >= 0) {
-        string seq_str = ss_.substr(cur_state.i);
-        string edge_str = g_.EdgeNucls(e).str();
+        const Sequence &edge_seq = g_.EdgeNucls(e);
         int position = -1;
-        int score = SHWDistance(seq_str, edge_str, path_max_length_ - ed, position);
+        int score = SuffixProfile(cur_state.i).BestPrefix(edge_seq, edge_seq.size(), path_max_length_ - ed, position);
         if (score != numeric_limits<int>::max()) {
             path_max_length_ = min(path_max_length_, ed + score);
             QueueState state(GraphState(e, 0, position + 1), (int) ss_.size());
@@ -9,6 +9,7 @@
 
 #include "assembly_graph/core/graph.hpp"
 #include "assembly_graph/paths/mapping_path.hpp"
+#include "sequence/myers_profile.hpp"
 #include "sequence/sequence_tools.hpp"
 #include "utils/perf/perfcounter.hpp"
 
@@ -152,6 +153,8 @@ class DijkstraGraphSequenceBase {
         : g_(g)
         , gap_cfg_(gap_cfg)
         , ss_(ss)
+        , ss_codes_(NuclCodes(ss))
+        , ss_profile_(ss_codes_.data(), ss_codes_.size())
         , start_e_(start_e)
         , start_p_(start_p)
         , path_max_length_(path_max_length)
@@ -215,12 +218,28 @@ class DijkstraGraphSequenceBase {
 
     virtual bool IsEndPosition(const QueueState &cur_state) = 0;
 
+    // Profile of the sequence suffix starting at from. Consecutive requests
+    // usually share the suffix (all outgoing edges of the same state)
+    const MyersProfile &SuffixProfile(int from);
+
+    // Profile of the whole edge without the trailing k-mer
+    const MyersProfile &EdgeProfile(EdgeId e);
+
+    static std::vector<uint8_t> NuclCodes(const std::string &s) {
+        std::vector<uint8_t> res(s.size());
+        for (size_t i = 0; i < s.size(); ++i)
+            res[i] = is_nucl(s[i]) ? (uint8_t) dignucl(s[i]) : 4;
+        return res;
+    }
+
     omnigraph::MappingPath<EdgeId> mapping_path_;
 
 
     const debruijn_graph::Graph &g_;
     const DijkstraParams gap_cfg_;
     const std::string ss_;
+    const std::vector<uint8_t> ss_codes_;
+    const MyersProfile ss_profile_;
     const EdgeId start_e_;
     const int start_p_;
 
@@ -242,6 +261,10 @@ class DijkstraGraphSequenceBase {
     const size_t queue_limit_;
     const size_t iter_limit_;
     size_t updates_;
+
+    int suffix_from_ = -1;
+    MyersProfile suffix_profile_;
+    std::unordered_map<EdgeId, MyersProfile> edge_profiles_;
 };
 
 
@@ -297,9 +320,9 @@ class DijkstraEndsReconstructor: public DijkstraGraphSequenceBase {
         : DijkstraGraphSequenceBase(g, gap_cfg, ss, start_e, start_p, path_max_length) {
         end_qstate_ = QueueState();
         if (g_.length(start_e_) + g_.k() - start_p_ + path_max_length_ > ss_.size()) {
-            std::string edge_str = g_.EdgeNucls(start_e_).Subseq(start_p_).str();
+            Sequence edge_seq = g_.EdgeNucls(start_e_).Subseq(start_p_);
             int position = -1;
-            int score = SHWDistance(ss_, edge_str, path_max_length, position);
+            int score = ss_profile_.BestPrefix(edge_seq, edge_seq.size(), path_max_length, position);
             if (score != std::numeric_limits<int>::max()) {
                 path_max_length_ = score;
                 QueueState state(GraphState(start_e_, start_p_, start_p_ + position + 1), (int) ss_.size() );
@@ -11,6 +11,7 @@
 #include "gap_filler.hpp"
 #include "pacbio_read_structures.hpp"
 
+#include "adt/concurrent_cache.hpp"
 #include "alignment/bwa_sequence_mapper.hpp"
 #include "alignment/edge_index_refiller.hpp"
 #include "alignment/gap_info.hpp"
@@ -39,6 +40,7 @@ class PacBioMappingIndex {
                        alignment::BWAIndex::AlignmentMode mode)
         : g_(g),
           pb_config_(pb_config),
+          distance_cache_(std::min(MAX_DISTANCE_CACHE_SIZE, DISTANCE_CACHE_PER_VERTEX * g.size())),
           bwa_mapper_(g, mode) {
         DEBUG("PB Mapping Index construction started");
         DEBUG("Index constructed");
@@ -93,14 +95,38 @@ class PacBioMappingIndex {
 
     static const size_t DISTANT_IN_GRAPH = 1000;
     static const size_t MAX_VERTICES_IN_DIJKSTRA_FILTERING = 500;
-    //presumably separate class for this and GetDistance
-    mutable std::map<std::pair<VertexId, VertexId>, size_t> distance_cashed_;
+    // The distance cache is sized from the graph, so small graphs do not pay
+    // for the memory of the largest one
+    static constexpr size_t MAX_DISTANCE_CACHE_SIZE = 1 << 20;
+    static constexpr size_t DISTANCE_CACHE_PER_VERTEX = 16;
+
+    struct VertexPair {
+        uint64_t start, end;
+
+        bool operator==(const VertexPair &other) const {
+            return start == other.start && end == other.end;
+        }
+    };
+
+    struct VertexPairHash {
+        size_t operator()(const VertexPair &p) const {
+            uint64_t h = p.start * 0x9E3779B97F4A7C15ull ^ p.end;
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 33;
+            return h;
+        }
+    };
+
     size_t read_count_;
     
     mutable size_t rna_filtering_count_;
 
     debruijn_graph::config::pacbio_processor pb_config_;
 
+    // Bounded memo of GetDistance shared by all the aligning threads
+    mutable adt::concurrent_cache<VertexPair, size_t, VertexPairHash> distance_cache_;
+
     alignment::BWAReadMapper<Graph> bwa_mapper_;
 
     bool similar(const MappingInstance &a, const MappingInstance &b, int a_len, int b_len) const {
@@ -399,33 +425,23 @@ class PacBioMappingIndex {
 
     size_t GetDistance(VertexId start_v, VertexId end_v,
                        bool update_cache = true) const {
+        VertexPair vertex_pair{start_v.int_id(), end_v.int_id()};
         size_t result = size_t(-1);
-        auto vertex_pair = std::make_pair(start_v, end_v);
-        bool not_found;
-        auto distance_it = distance_cashed_.begin();
-        //FIXME should permit multiple readers
-        #pragma omp critical(pac_index)
-        {
-            distance_it = distance_cashed_.find(vertex_pair);
-            not_found = (distance_it == distance_cashed_.end());
-        }
-        if (not_found) {
-            omnigraph::DijkstraHelper<debruijn_graph::Graph>::BoundedDijkstra dijkstra(
-                omnigraph::DijkstraHelper<debruijn_graph::Graph>::CreateBoundedDijkstra(g_,
-                        pb_config_.max_path_in_dijkstra,
-                        pb_config_.max_vertex_in_dijkstra));
-            dijkstra.Run(start_v);
-            if (dijkstra.DistanceCounted(end_v)) {
-                result = dijkstra.GetDistance(end_v);
-            }
-            if (update_cache) {
-                #pragma omp critical(pac_index)
-                distance_cashed_.insert({vertex_pair, result});
-            }
-        } else {
+        if (distance_cache_.find(vertex_pair, result)) {
             TRACE("taking from cashed");
-            result = distance_it->second;
+            return result;
+        }
+
+        omnigraph::DijkstraHelper<debruijn_graph::Graph>::BoundedDijkstra dijkstra(
+            omnigraph::DijkstraHelper<debruijn_graph::Graph>::CreateBoundedDijkstra(g_,
+                    pb_config_.max_path_in_dijkstra,
+                    pb_config_.max_vertex_in_dijkstra));
+        dijkstra.Run(start_v);
+        if (dijkstra.DistanceCounted(end_v)) {
+            result = dijkstra.GetDistance(end_v);
         }
+        if (update_cache)
+            distance_cache_.insert(vertex_pair, result);
 
         return result;
     }
@@ -14,6 +14,7 @@
 #include "action_handlers.hpp"
 #include "utils/stl_utils.hpp"
 #include <boost/iterator/iterator_facade.hpp>
+#include <boost/iterator/filter_iterator.hpp>
 
 namespace omnigraph {
 
@@ -182,12 +183,14 @@ SmartEdgeSet<Container, Graph> make_smart_edge_set(const Graph &g, Container &c,
 /**
  * SmartIterator is able to iterate through collection content of which can be changed in process of
  * iteration. And as GraphActionHandler SmartIterator can change collection contents with respect to the
- * way graph is changed. Also one can define order of iteration by specifying Priority.
+ * way graph is changed. Also one can define order of iteration by specifying Priority. Queue could be
+ * switched to adt::bucket_priority_queue for small unsigned priorities (e.g. edge length).
  */
-template<class Graph, typename ElementId, typename Priority = adt::identity>
+template<class Graph, typename ElementId, typename Priority = adt::identity,
+         typename Queue = adt::erasable_priority_queue_key_dirty_heap<ElementId, Priority>>
 class SmartIterator : public GraphActionHandler<Graph> {
     typedef GraphActionHandler<Graph> base;
-    typedef adt::DynamicQueueIteratorKey<ElementId, Priority> DynamicQueueIterator;
+    typedef adt::DynamicQueueIteratorKey<ElementId, Priority, Queue> DynamicQueueIterator;
     DynamicQueueIterator inner_it_;
     bool add_new_;
     bool canonical_only_;
@@ -196,18 +199,21 @@ class SmartIterator : public GraphActionHandler<Graph> {
 
 protected:
 
+    bool accept(const ElementId& el) const {
+        return (!canonical_only_ || el <= this->g().conjugate(el)) &&
+                add_condition_(el);
+    }
+
     void push(const ElementId& el) {
-        if ((!canonical_only_ || el <= this->g().conjugate(el)) &&
-            add_condition_(el)) {
+        if (accept(el))
             inner_it_.push(el);
-        }
     }
 
     template<typename InputIterator>
     void insert(InputIterator begin, InputIterator end) {
-        for (auto it = begin; it != end; ++it) {
-            push(*it);
-        }
+        auto accepted = [this](const ElementId& el) { return accept(el); };
+        inner_it_.insert(boost::make_filter_iterator(accepted, begin, end),
+                         boost::make_filter_iterator(accepted, end, end));
     }
 
     void erase(const ElementId& el) {
@@ -275,9 +281,10 @@ public:
  * way graph is changed. Also one can define order of iteration by specifying Priority.
  */
 template<class Graph, typename ElementId,
-         typename Priority = adt::identity>
-class SmartSetIterator : public SmartIterator<Graph, ElementId, Priority> {
-    typedef SmartIterator<Graph, ElementId, Priority> base;
+         typename Priority = adt::identity,
+         typename Queue = adt::erasable_priority_queue_key_dirty_heap<ElementId, Priority>>
+class SmartSetIterator : public SmartIterator<Graph, ElementId, Priority, Queue> {
+    typedef SmartIterator<Graph, ElementId, Priority, Queue> base;
 
 public:
     SmartSetIterator(const Graph &g,
@@ -319,9 +326,10 @@ public:
  * structure which is also updated with handlers make sure that all information is updated in high level
  * event handlers.
  */
-template<class Graph, typename Priority = adt::identity >
+template<class Graph, typename Priority = adt::identity,
+         typename Queue = adt::erasable_priority_queue_key_dirty_heap<typename Graph::VertexId, Priority>>
 class SmartVertexIterator : public SmartIterator<Graph,
-                                                 typename Graph::VertexId, Priority> {
+                                                 typename Graph::VertexId, Priority, Queue> {
   public:
     typedef typename Graph::VertexId VertexId;
 
@@ -333,7 +341,7 @@ class SmartVertexIterator : public SmartIterator<Graph,
   public:
     SmartVertexIterator(const Graph &g, const Priority& priority =
                         Priority(), bool canonical_only = false)
-            : SmartIterator<Graph, VertexId, Priority>(
+            : SmartIterator<Graph, VertexId, Priority, Queue>(
                 g, "SmartVertexIterator " + std::to_string(get_id()), true,
                 priority, canonical_only) {
         this->insert(g.begin(), g.end());
@@ -420,9 +428,9 @@ private:
  * structure which is also updated with handlers make sure that all information is updated in high level
  * event handlers.
  */
-template<class Graph, typename Priority = adt::identity>
-class SmartEdgeIterator : public SmartIterator<Graph, typename Graph::EdgeId, Priority> {
-    typedef GraphEdgeIterator<Graph> EdgeIt;
+template<class Graph, typename Priority = adt::identity,
+         typename Queue = adt::erasable_priority_queue_key_dirty_heap<typename Graph::EdgeId, Priority>>
+class SmartEdgeIterator : public SmartIterator<Graph, typename Graph::EdgeId, Priority, Queue> {
   public:
     typedef typename Graph::EdgeId EdgeId;
 
@@ -434,10 +442,11 @@ class SmartEdgeIterator : public SmartIterator<Graph, typename Graph::EdgeId, Pr
   public:
     SmartEdgeIterator(const Graph &g, Priority priority = Priority(),
                       bool canonical_only = false)
-            : SmartIterator<Graph, EdgeId, Priority>(
+            : SmartIterator<Graph, EdgeId, Priority, Queue>(
                 g, "SmartEdgeIterator " + std::to_string(get_id()), true,
                 priority, canonical_only) {
-        this->insert(EdgeIt(g, g.begin()), EdgeIt(g, g.end()));
+        // Seed straight from the edge storage, no need to walk the vertices
+        this->insert(g.e_begin(), g.e_end());
 
 //        for (auto it = graph.begin(); it != graph.end(); ++it) {
 //            //todo: this solution doesn't work with parallel simplification
@@ -103,6 +103,22 @@ public:
         return SmartEdgeIterator<ObservableGraph>(*this, adt::identity(), canonical_only);
     }
 
+    // Same order as SmartVertexBegin / SmartEdgeBegin, the bucket queue is used
+    // instead of the heap (priorities must be unsigned)
+    template<typename Priority>
+    SmartVertexIterator<ObservableGraph, Priority, adt::bucket_priority_queue<VertexId, Priority>> SmartVertexBucketBegin(
+            const Priority& priority, bool canonical_only = false) const {
+        return SmartVertexIterator<ObservableGraph, Priority,
+                                   adt::bucket_priority_queue<VertexId, Priority>>(*this, priority, canonical_only);
+    }
+
+    template<typename Priority>
+    SmartEdgeIterator<ObservableGraph, Priority, adt::bucket_priority_queue<EdgeId, Priority>> SmartEdgeBucketBegin(
+            const Priority& priority, bool canonical_only = false) const {
+        return SmartEdgeIterator<ObservableGraph, Priority,
+                                 adt::bucket_priority_queue<EdgeId, Priority>>(*this, priority, canonical_only);
+    }
+
     void FireDeletePath(const std::vector<EdgeId>& edges_to_delete, const std::vector<VertexId>& vertices_to_delete) const;
 
     ObservableGraph(const DataMaster& master) :
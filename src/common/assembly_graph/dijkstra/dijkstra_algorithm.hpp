@@ -8,12 +8,12 @@
 #pragma once
 
 #include "dijkstra_settings.hpp"
+#include "dijkstra_workspace.hpp"
 
 #include "utils/stl_utils.hpp"
 #include "utils/logger/logger.hpp"
 #include "adt/iterator_range.hpp"
 
-#include <parallel_hashmap/phmap.h>
 #include <radix_heap/radix_heap.h>
 
 #include <queue>
@@ -91,14 +91,14 @@ class Dijkstra {
     size_t vertex_number_;
     bool vertex_limit_exceeded_;
 
-    // accumulative structures
-    phmap::flat_hash_map<VertexId, distance_t> distances_;
-    phmap::flat_hash_map<VertexId, std::pair<VertexId, EdgeId>> prev_vert_map_;
+    // accumulative structures, taken from the thread-local pool
+    typedef DijkstraWorkspace<VertexId, EdgeId, distance_t> Workspace;
+    typename Workspace::Ptr workspace_;
 
     template<bool Traceback = EnableTraceback>
     void MaybeCollectTraceback(VertexId v,
                                typename std::enable_if<Traceback, typename Queue::QueueElement>::type next) {
-        prev_vert_map_[v] =  { next.prev_vertex, next.edge_between };
+        workspace_->set_prev(v, next.prev_vertex, next.edge_between);
     }
 
     template<bool Traceback = EnableTraceback>
@@ -109,17 +109,12 @@ class Dijkstra {
 
     void Init(VertexId start, Queue &queue) {
         vertex_number_ = 0;
-        size_t sz = 8192;
-        if (max_vertex_number_ != size_t(-1) && max_vertex_number_ > sz)
-            sz = 2 * max_vertex_number_;
-        distances_.clear();
-        distances_.reserve(sz);
-        prev_vert_map_.clear();
+        workspace_->clear();
         set_finished(false);
         settings_.Init(start);
         queue.push(0, start);
         if (EnableTraceback)
-            prev_vert_map_[start] = std::pair<VertexId, EdgeId>(VertexId(), EdgeId());
+            workspace_->set_prev(start, VertexId(), EdgeId());
     }
 
     void set_finished(bool state) {
@@ -171,7 +166,8 @@ public:
               max_vertex_number_(max_vertex_number),
               finished_(false),
               vertex_number_(0),
-              vertex_limit_exceeded_(false) {}
+              vertex_limit_exceeded_(false),
+              workspace_(Workspace::Acquire()) {}
 
     Dijkstra(Dijkstra&& /*other*/) = default;
     Dijkstra& operator=(Dijkstra&& /*other*/) = default;
@@ -184,7 +180,7 @@ public:
     }
 
     bool DistanceCounted(VertexId v) const {
-        return distances_.count(v);
+        return workspace_->distance(v) != nullptr;
     }
 
     bool ReachedVertex(VertexId v) const {
@@ -192,9 +188,9 @@ public:
     }
 
     distance_t GetDistance(VertexId vertex) const {
-        auto it = distances_.find(vertex);
-        VERIFY(it != distances_.end());
-        return it->second;
+        const distance_t *distance = workspace_->distance(vertex);
+        VERIFY(distance);
+        return *distance;
     }
 
     void Run(VertexId start, std::unordered_set<VertexId> other_vertices = std::unordered_set<VertexId>()) {
@@ -216,7 +212,7 @@ public:
             queue.pop();
             // TRACE("Vertex " << graph_.str(vertex) << " with distance " << distance << " fetched from queue");
 
-            if (!distances_.try_emplace(vertex, distance).second) {
+            if (!workspace_->Reach(vertex, distance)) {
                 // TRACE("Distance to vertex " << graph_.str(vertex) << " already counted. Proceeding to next queue entry.");
                 continue;
             }
@@ -236,35 +232,35 @@ public:
     std::vector<EdgeId> GetShortestPathTo(VertexId vertex) {
         VERIFY_MSG(EnableTraceback, "GetShortestPathTo() is available only if traceback is collected");
         std::vector<EdgeId> path;
-        if (prev_vert_map_.find(vertex) == prev_vert_map_.end())
+        const auto *prev = workspace_->prev(vertex);
+        if (!prev)
             return path;
 
-        VertexId curr_vertex = vertex;
-        VertexId prev_vertex = utils::get(prev_vert_map_, vertex).first;
-        EdgeId edge = utils::get(prev_vert_map_, curr_vertex).second;
+        VertexId prev_vertex = prev->first;
+        EdgeId edge = prev->second;
 
         while (prev_vertex != VertexId()) {
             if (graph_.EdgeStart(edge) == prev_vertex)
                 path.insert(path.begin(), edge);
             else
                 path.push_back(edge);
-            curr_vertex = prev_vertex;
-            const auto& prev_v_e = utils::get(prev_vert_map_, curr_vertex);
-            prev_vertex = prev_v_e.first;
-            edge = prev_v_e.second;
+            prev = workspace_->prev(prev_vertex);
+            VERIFY(prev);
+            prev_vertex = prev->first;
+            edge = prev->second;
         }
         return path;
     }
 
-    auto reached_begin() const { return distances_.begin(); }
-    auto reached_end() const { return distances_.end(); }
+    auto reached_begin() const { return workspace_->reached().begin(); }
+    auto reached_end() const { return workspace_->reached().end(); }
     auto reached() const { return adt::make_range(reached_begin(), reached_end()); }
 
     std::vector<VertexId> ReachedVertices() const {
         std::vector<VertexId> result;
-        result.reserve(distances_.size());
+        result.reserve(workspace_->reached().size());
 
-        for (const auto &el : distances_)
+        for (const auto &el : workspace_->reached())
             result.push_back(el.first);
         std::sort(result.begin(), result.end());
 
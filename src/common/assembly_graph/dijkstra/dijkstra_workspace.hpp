@@ -0,0 +1,190 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace omnigraph {
+
+// Open-addressing hash map from vertex ids with O(1) reset: a slot is
+// occupied only while it is stamped with the current epoch. Nothing is ever
+// erased within an epoch, so linear probing stops at the first stale slot.
+// The table grows with the run and is kept between runs unless it got large.
+template<class T>
+class EpochMap {
+    struct Slot {
+        uint32_t epoch = 0;
+        uint64_t key;
+        T value;
+    };
+
+    static constexpr size_t MIN_CAPACITY = 64;
+    // Larger tables are released on reset
+    static constexpr size_t MAX_RETAINED = std::max<size_t>((1 << 20) / sizeof(Slot), MIN_CAPACITY);
+
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+    uint32_t epoch_ = 1;
+
+    size_t mask() const { return slots_.size() - 1; }
+
+    static size_t hash(uint64_t key) {
+        // Fibonacci hashing spreads the consecutive ids over the table
+        return size_t((key * 0x9E3779B97F4A7C15ULL) >> 32);
+    }
+
+    size_t probe(uint64_t key) const {
+        size_t i = hash(key) & mask();
+        while (slots_[i].epoch == epoch_ && slots_[i].key != key)
+            i = (i + 1) & mask();
+        return i;
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old(capacity);
+        old.swap(slots_);
+        for (auto &slot : old) {
+            if (slot.epoch == epoch_)
+                slots_[probe(slot.key)] = std::move(slot);
+        }
+    }
+
+public:
+    EpochMap() : slots_(MIN_CAPACITY) {}
+
+    void clear() {
+        size_ = 0;
+        if (slots_.size() > MAX_RETAINED) {
+            std::vector<Slot>(MIN_CAPACITY).swap(slots_);
+            epoch_ = 1;
+            return;
+        }
+
+        if (++epoch_ == 0) {
+            // Stamps wrapped around, all the stale slots have to be wiped
+            for (auto &slot : slots_)
+                slot.epoch = 0;
+            epoch_ = 1;
+        }
+    }
+
+    const T *find(uint64_t key) const {
+        const Slot &slot = slots_[probe(key)];
+        return slot.epoch == epoch_ ? &slot.value : nullptr;
+    }
+
+    // Returns the value and whether it was inserted, inserted values are
+    // left from the previous epochs and have to be assigned
+    std::pair<T&, bool> try_emplace(uint64_t key) {
+        size_t i = probe(key);
+        if (slots_[i].epoch == epoch_)
+            return { slots_[i].value, false };
+
+        // Keep the load factor at most 1/2
+        if (2 * (size_ + 1) > slots_.size()) {
+            rehash(2 * slots_.size());
+            i = probe(key);
+        }
+
+        Slot &slot = slots_[i];
+        slot.epoch = epoch_;
+        slot.key = key;
+        size_ += 1;
+        return { slot.value, true };
+    }
+};
+
+// Per-run state of Dijkstra. Workspaces are kept in a thread-local pool and
+// reused by the subsequent runs: the reset is O(1) and a run no larger than
+// the previous ones does not allocate. Storage of large runs is released.
+template<class VertexId, class EdgeId, typename distance_t>
+class DijkstraWorkspace {
+    // Idle workspaces kept per thread
+    static constexpr size_t MAX_POOLED = 2;
+    // Larger reached lists are released on reset
+    static constexpr size_t MAX_RETAINED_REACHED = 1 << 15;
+
+    typedef std::vector<std::unique_ptr<DijkstraWorkspace>> Pool;
+
+    static Pool &pool() {
+        thread_local Pool pool;
+        return pool;
+    }
+
+public:
+    struct Release {
+        void operator()(DijkstraWorkspace *ws) const {
+            Pool &p = pool();
+            if (p.size() < MAX_POOLED)
+                p.emplace_back(ws);
+            else
+                delete ws;
+        }
+    };
+    typedef std::unique_ptr<DijkstraWorkspace, Release> Ptr;
+
+    static Ptr Acquire() {
+        Pool &p = pool();
+        if (p.empty())
+            return Ptr(new DijkstraWorkspace());
+
+        Ptr res(p.back().release());
+        p.pop_back();
+        res->clear();
+        return res;
+    }
+
+    void clear() {
+        distances_.clear();
+        prev_.clear();
+        if (reached_.capacity() > MAX_RETAINED_REACHED)
+            std::vector<std::pair<VertexId, distance_t>>().swap(reached_);
+        else
+            reached_.clear();
+    }
+
+    const distance_t *distance(VertexId v) const {
+        return distances_.find(v.int_id());
+    }
+
+    // Records the distance unless the vertex is already reached
+    bool Reach(VertexId v, distance_t distance) {
+        auto res = distances_.try_emplace(v.int_id());
+        if (!res.second)
+            return false;
+
+        res.first = distance;
+        reached_.emplace_back(v, distance);
+        return true;
+    }
+
+    const std::pair<VertexId, EdgeId> *prev(VertexId v) const {
+        return prev_.find(v.int_id());
+    }
+
+    void set_prev(VertexId v, VertexId prev_vertex, EdgeId edge) {
+        prev_.try_emplace(v.int_id()).first = { prev_vertex, edge };
+    }
+
+    // Reached vertices together with distances in the order they were reached
+    const std::vector<std::pair<VertexId, distance_t>> &reached() const {
+        return reached_;
+    }
+
+private:
+    DijkstraWorkspace() = default;
+
+    EpochMap<distance_t> distances_;
+    EpochMap<std::pair<VertexId, EdgeId>> prev_;
+    std::vector<std::pair<VertexId, distance_t>> reached_;
+};
+
+}
@@ -12,28 +12,38 @@
 #include "io/reads/osequencestream.hpp"
 
 #include <string>
+#include <vector>
 
 namespace debruijn_graph {
 
 inline void OutputEdgeSequences(const Graph &g, const std::string &contigs_output) {
     std::filesystem::path contigs_output_filename = contigs_output + ".fasta";
     INFO("Outputting contigs to " << contigs_output_filename);
-    io::osequencestream_cov oss(contigs_output_filename);
-
-    for (EdgeId e: g.canonical_edges()) {
-        oss << g.coverage(e);
-        oss << g.EdgeNucls(e).str();
-    }
+    std::ofstream os(contigs_output_filename);
+
+    auto canonical_edges = g.canonical_edges();
+    std::vector<EdgeId> edges(canonical_edges.begin(), canonical_edges.end());
+    io::WriteOrdered(os, edges.size(),
+                     [&](size_t i, std::string &out) {
+                         std::string s = g.EdgeNucls(edges[i]).str();
+                         // Velvet format: NODE_1_length_24705_cov_358.255249
+                         io::AppendFasta(io::MakeContigId(i + 1, s.size(), g.coverage(edges[i])), s, out);
+                     });
 }
 
 inline void OutputEdgesByID(const Graph &g, const std::string &contigs_output) {
     std::filesystem::path contigs_output_filename = contigs_output + ".fasta";
     INFO("Outputting contigs to " << contigs_output_filename);
-    io::OFastaReadStream oss(contigs_output_filename);
-    for (EdgeId e: g.canonical_edges()) {
-        std::string s = g.EdgeNucls(e).str();
-        oss << io::SingleRead(io::MakeContigId(g.int_id(e), s.size(), g.coverage(e), "EDGE"), s);
-    }
+    std::ofstream os(contigs_output_filename);
+
+    auto canonical_edges = g.canonical_edges();
+    std::vector<EdgeId> edges(canonical_edges.begin(), canonical_edges.end());
+    io::WriteOrdered(os, edges.size(),
+                     [&](size_t i, std::string &out) {
+                         EdgeId e = edges[i];
+                         std::string s = g.EdgeNucls(e).str();
+                         io::AppendFasta(io::MakeContigId(g.int_id(e), s.size(), g.coverage(e), "EDGE"), s, out);
+                     });
 }
 } // namespace debruijn_graph
 
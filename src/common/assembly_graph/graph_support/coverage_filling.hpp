@@ -12,6 +12,9 @@
 #include "assembly_graph/graph_support/detail_coverage.hpp"
 #include "utils/parallel/openmp_wrapper.h"
 
+#include <limits>
+#include <vector>
+
 namespace debruijn_graph {
 
 template<class Graph, class PHM>
@@ -19,6 +22,16 @@ class GraphCoverageFiller {
     typedef typename omnigraph::GraphEdgeIterator<Graph> EdgeIt;
     typedef typename Graph::EdgeId EdgeId;
     typedef typename adt::iterator_range<EdgeIt> EdgeRange;
+    typedef typename PHM::KeyWithHash KeyWithHash;
+
+    // Number of k-mers looked up at once: indices are computed for the whole
+    // batch first and the values are prefetched before being read
+    static constexpr size_t LOOKUP_BATCH = 16;
+
+    struct CoverageSums {
+        uint64_t coverage = 0;
+        uint64_t flanking = 0;
+    };
 
     const Graph& g_;
     const PHM& phm_;
@@ -26,15 +39,20 @@ class GraphCoverageFiller {
     omnigraph::CoverageIndex<Graph>& coverage_index_;
     unsigned k_;
     size_t avg_range_;
+    // Edges having more k-mers than this are split into windows of this size
+    // processed by different threads, zero disables the splitting
+    size_t window_;
   public:
     GraphCoverageFiller(const Graph& g, unsigned k, const PHM& phm,
                         omnigraph::FlankingCoverage<Graph>& flanking_coverage,
-                        omnigraph::CoverageIndex<Graph>& coverage_index)
+                        omnigraph::CoverageIndex<Graph>& coverage_index,
+                        size_t window = 1 << 16)
             : g_(g),
               phm_(phm),
               flanking_coverage_(flanking_coverage),
               coverage_index_(coverage_index),
-              k_(k), avg_range_(flanking_coverage_.averaging_range()) {}
+              k_(k), avg_range_(flanking_coverage_.averaging_range()),
+              window_(window) {}
 
     void inc_coverage(EdgeId edge_id, size_t offset, uint32_t value) {
         coverage_index_.IncRawCoverage(edge_id, value);
@@ -42,28 +60,97 @@ class GraphCoverageFiller {
             flanking_coverage_.IncRawCoverage(edge_id, value);
     }
 
+    // The same as incrementing by every k-mer (including the wrap-around of
+    // the raw coverage), but the increments must fit int
+    void inc_coverage(EdgeId edge_id, const CoverageSums &sums) {
+        const uint64_t max_inc = std::numeric_limits<int>::max();
+        for (uint64_t cov = sums.coverage; cov; cov -= std::min(cov, max_inc))
+            coverage_index_.IncRawCoverage(edge_id, unsigned(std::min(cov, max_inc)));
+        for (uint64_t cov = sums.flanking; cov; cov -= std::min(cov, max_inc))
+            flanking_coverage_.IncRawCoverage(edge_id, unsigned(std::min(cov, max_inc)));
+    }
+
+    // Sums the coverage of k-mers [from, to) of the sequence
+    CoverageSums CountCoverage(const Sequence &seq, size_t from, size_t to) const {
+        CoverageSums sums;
+        std::vector<KeyWithHash> batch;
+        batch.reserve(LOOKUP_BATCH);
+
+        RtSeq kmer = seq.Subseq(from).start<RtSeq>(this->k_) >> 'A';
+        for (size_t pos = from; pos < to; ) {
+            batch.clear();
+            size_t batch_start = pos;
+            for (; pos < to && batch.size() < LOOKUP_BATCH; ++pos) {
+                kmer <<= seq[pos + this->k_ - 1];
+                batch.push_back(phm_.ConstructKWH(kmer));
+                __builtin_prefetch(&phm_.get_raw_value_reference(batch.back()));
+            }
+
+            for (size_t i = 0; i < batch.size(); ++i) {
+                uint32_t cov = phm_.get_value(batch[i], kmers::InvertableStoring::trivial_inverter());
+                sums.coverage += cov;
+                if (batch_start + i < avg_range_)
+                    sums.flanking += cov;
+            }
+        }
+
+        return sums;
+    }
+
+    size_t KmerCount(EdgeId e) const {
+        return g_.EdgeNucls(e).size() - this->k_ + 1;
+    }
+
+    bool IsLong(EdgeId e) const {
+        return window_ && KmerCount(e) > window_;
+    }
+
     size_t FillCoverageFromEdges(EdgeRange &r) {
         size_t seqs = 0;
         for (auto &it = r.begin(); it != r.end() && seqs < 100000; ++it) {
             EdgeId e = *it;
-            const Sequence &seq = g_.EdgeNucls(e);
-                
             seqs += 1;
-            RtSeq kmer = seq.start<RtSeq>(this->k_) >> 'A';
-            for (size_t j = this->k_ - 1; j < seq.size(); ++j) {
-                kmer <<= seq[j];
+            // Long edges are processed separately
+            if (IsLong(e))
+                continue;
 
-                auto kwh = phm_.ConstructKWH(kmer);
-                uint32_t cov = phm_.get_value(kwh, kmers::InvertableStoring::trivial_inverter());
-                inc_coverage(e, j - this->k_ + 1, cov);
-            }
+            inc_coverage(e, CountCoverage(g_.EdgeNucls(e), 0, KmerCount(e)));
         }
         
         return seqs;
     }
 
+    // K-mer windows of all long edges are processed in parallel, partial sums
+    // are added afterwards
+    void FillCoverageFromLongEdges(unsigned nthreads) {
+        std::vector<std::pair<EdgeId, size_t>> windows;
+        for (EdgeId e : g_.edges()) {
+            if (!IsLong(e))
+                continue;
+
+            size_t kmers = KmerCount(e);
+            for (size_t from = 0; from < kmers; from += window_)
+                windows.emplace_back(e, from);
+        }
+        if (windows.empty())
+            return;
+
+        INFO("Processing " << windows.size() << " windows of long edges");
+        std::vector<CoverageSums> sums(windows.size());
+#       pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+        for (size_t i = 0; i < windows.size(); ++i) {
+            EdgeId e = windows[i].first;
+            size_t from = windows[i].second;
+            sums[i] = CountCoverage(g_.EdgeNucls(e), from, std::min(from + window_, KmerCount(e)));
+        }
+
+        for (size_t i = 0; i < windows.size(); ++i)
+            inc_coverage(windows[i].first, sums[i]);
+    }
 
     void Fill(unsigned nthreads) {
+        FillCoverageFromLongEdges(nthreads);
+
         omnigraph::IterationHelper<Graph, EdgeId> edges(g_);
         auto its = edges.Chunks(10*nthreads);
 
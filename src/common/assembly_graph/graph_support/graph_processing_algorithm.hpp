@@ -15,6 +15,7 @@
 #include "utils/logger/logger.hpp"
 
 #include <atomic>
+#include <type_traits>
 
 namespace omnigraph {
 
@@ -56,8 +57,18 @@ class EdgeProcessingAlgorithm {
 
     template<class Priority = adt::identity>
     bool Run(const Priority& priority = Priority(), ProceedConditionT proceed_condition = func::AlwaysTrue<EdgeId>()) {
+        // Unsigned priorities (e.g. edge length) are served by the bucket queue, the order is the same
+        if constexpr (std::is_unsigned<std::decay_t<decltype(priority(EdgeId()))>>::value)
+            return Process(g_.SmartEdgeBucketBegin(priority, conjugate_symmetry_), proceed_condition);
+        else
+            return Process(g_.SmartEdgeBegin(priority, conjugate_symmetry_), proceed_condition);
+    }
+
+ private:
+    template<class SmartEdgeIt>
+    bool Process(SmartEdgeIt it, ProceedConditionT proceed_condition) {
         bool triggered = false;
-        for (auto it = g_.SmartEdgeBegin(priority, conjugate_symmetry_); !it.IsEnd(); ++it) {
+        for (; !it.IsEnd(); ++it) {
             EdgeId e = *it;
             TRACE("Current edge " << g_.str(e));
             if (!proceed_condition(e)) {
@@ -71,7 +82,6 @@ class EdgeProcessingAlgorithm {
         return triggered;
     }
 
- private:
     DECL_LOGGER("EdgeProcessingAlgorithm");
 };
 
@@ -30,12 +30,14 @@ std::string PathWriter::ToPathString(const BidirectionalPath &path) const {
 
 void FastgPathWriter::WritePaths(const ScaffoldStorage &scaffold_storage, const std::filesystem::path &fn) const {
     std::ofstream os(fn);
-    for (const auto& scaffold_info : scaffold_storage) {
-        os << scaffold_info.name << "\n"
-           << path_writer_.ToPathString(*scaffold_info.path) << "\n"
-           << scaffold_info.name << "'" << "\n"
-           << path_writer_.ToPathString(*scaffold_info.path->GetConjPath()) << "\n";
-    }
+    io::WriteOrdered(os, scaffold_storage.size(),
+                     [&](size_t i, std::string &out) {
+                         const auto &scaffold_info = scaffold_storage[i];
+                         out.append(scaffold_info.name).append("\n")
+                            .append(path_writer_.ToPathString(*scaffold_info.path)).append("\n")
+                            .append(scaffold_info.name).append("'\n")
+                            .append(path_writer_.ToPathString(*scaffold_info.path->GetConjPath())).append("\n");
+                     });
 }
 
 void GFAPathWriter::WritePath(const std::string &name, size_t segment_id,
@@ -240,22 +242,41 @@ void GFAPathWriter::WritePaths11(const ScaffoldStorage &scaffold_storage) {
 }
 
 
-void ContigWriter::OutputPaths(const PathContainer &paths, const std::vector<PathsWriterT> &writers) const {
-    ScaffoldStorage storage;
+void ContigWriter::WriteScaffolds(const ScaffoldStorage &scaffold_storage, const std::filesystem::path &fn) {
+    std::ofstream os(fn);
+    io::WriteOrdered(os, scaffold_storage.size(),
+                     [&](size_t i, std::string &out) {
+                         const auto &scaffold_info = scaffold_storage[i];
+                         TRACE("Scaffold " << scaffold_info.name << " originates from path " << scaffold_info.path->str());
+                         io::AppendFasta(scaffold_info.name, scaffold_info.sequence, out);
+                     });
+}
 
-    ScaffoldSequenceMaker scaffold_maker(g_);
+void ContigWriter::OutputPaths(const PathContainer &paths, const std::vector<PathsWriterT> &writers) const {
+    std::vector<const BidirectionalPath*> nonempty_paths;
     DEBUG("started" << paths.size());
     for (auto iter = paths.begin(); iter != paths.end(); ++iter) {
         const BidirectionalPath &path = iter.get();
-        DEBUG("path: " <<  path.Length());
         if (path.Length() <= 0)
             continue;
-        auto path_string = scaffold_maker.MakeSequence(path);
-        if (path_string.length() >= g_.k()) {
-            storage.emplace_back(path_string, &path);
-        }
-        DEBUG("over");
+        nonempty_paths.push_back(&path);
     }
+
+    // Sequence materialization (including gap filling) is independent for
+    // every path, so do it in parallel and only keep the original order
+    ScaffoldSequenceMaker scaffold_maker(g_);
+    std::vector<std::string> sequences(nonempty_paths.size());
+    #pragma omp parallel for schedule(guided)
+    for (size_t i = 0; i < nonempty_paths.size(); ++i)
+        sequences[i] = scaffold_maker.MakeSequence(*nonempty_paths[i]);
+
+    ScaffoldStorage storage;
+    for (size_t i = 0; i < nonempty_paths.size(); ++i) {
+        if (sequences[i].length() >= g_.k())
+            storage.emplace_back(std::move(sequences[i]), nonempty_paths[i]);
+    }
+    sequences.clear();
+
     DEBUG("sort");
     //sorting by length and coverage
     std::sort(storage.begin(), storage.end(), [] (const ScaffoldInfo &a, const ScaffoldInfo &b) {
@@ -266,9 +287,13 @@ void ContigWriter::OutputPaths(const PathContainer &paths, const std::vector<Pat
     DEBUG("preprocess");
     name_generator_->Preprocess(paths);
     DEBUG(storage.size());
-    for (size_t i = 0; i < storage.size(); ++i) {
-        DEBUG("name");
-        storage[i].name = name_generator_->MakeContigName(i+1, storage[i]);
+    if (name_generator_->IsThreadSafe()) {
+        #pragma omp parallel for schedule(guided)
+        for (size_t i = 0; i < storage.size(); ++i)
+            storage[i].name = name_generator_->MakeContigName(i+1, storage[i]);
+    } else {
+        for (size_t i = 0; i < storage.size(); ++i)
+            storage[i].name = name_generator_->MakeContigName(i+1, storage[i]);
     }
     DEBUG("wrt");
     for (auto& writer : writers) {
@@ -109,15 +109,7 @@ class ContigWriter {
     std::shared_ptr<ContigNameGenerator> name_generator_;
 
 public:
-    static void WriteScaffolds(const ScaffoldStorage &scaffold_storage, const std::filesystem::path &fn) {
-        io::OFastaReadStream oss(fn);
-        std::ofstream os_fastg;
-
-        for (const auto& scaffold_info : scaffold_storage) {
-            TRACE("Scaffold " << scaffold_info.name << " originates from path " << scaffold_info.path->str());
-            oss << io::SingleRead(scaffold_info.name, scaffold_info.sequence);
-        }
-    }
+    static void WriteScaffolds(const ScaffoldStorage &scaffold_storage, const std::filesystem::path &fn);
 
     static PathsWriterT BasicFastaWriter(const std::filesystem::path &fn) {
         return [=](const ScaffoldStorage& scaffold_storage) {
@@ -20,8 +20,8 @@ struct ScaffoldInfo {
     const BidirectionalPath* path;
     std::string name;
 
-    ScaffoldInfo(const std::string& sequence, const BidirectionalPath* path) :
-        sequence(sequence), path(path) { }
+    ScaffoldInfo(std::string sequence, const BidirectionalPath* path) :
+        sequence(std::move(sequence)), path(path) { }
 
     size_t length() const {
         return sequence.length();
@@ -80,6 +80,9 @@ public:
 
     virtual void PrintStats() const {}
 
+    // Whether MakeContigName could be called concurrently for different scaffolds
+    virtual bool IsThreadSafe() const { return false; }
+
     virtual ~ContigNameGenerator() {}
 };
 
@@ -90,6 +93,8 @@ public:
     std::string MakeContigName(size_t index, const ScaffoldInfo &scaffold_info) override {
         return io::MakeContigId(index, scaffold_info.length(), scaffold_info.coverage());
     }
+
+    bool IsThreadSafe() const override { return true; }
 };
 
 class PlasmidContigNameGenerator: public ContigNameGenerator {
@@ -98,12 +103,19 @@ class PlasmidContigNameGenerator: public ContigNameGenerator {
 public:
     PlasmidContigNameGenerator(const ConnectedComponentCounter &c_counter): c_counter_(c_counter) {}
 
-    void Preprocess(const PathContainer&) override {}
+    // Components are calculated lazily on the first query, do it before the
+    // names are generated concurrently
+    void Preprocess(const PathContainer&) override {
+        if (!c_counter_.IsFilled())
+            c_counter_.CalculateComponents();
+    }
 
     std::string MakeContigName(size_t index, const ScaffoldInfo &scaffold_info) override {
         return io::AddComponentId(io::MakeContigId(index, scaffold_info.length(), scaffold_info.coverage()),
                                   c_counter_.GetComponent(scaffold_info.path->Front()));
     }
+
+    bool IsThreadSafe() const override { return true; }
 };
 
 class TranscriptNameGenerator: public ContigNameGenerator {
@@ -0,0 +1,152 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "path_processor.hpp"
+#include "assembly_graph/dijkstra/dijkstra_helper.hpp"
+
+#include <parallel_hashmap/phmap.h>
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace omnigraph {
+
+// Answers whether there is a path between two edges with the length within
+// the given bounds without enumerating the paths. For every vertex the set of
+// the achievable lengths of the paths to the target is propagated backwards
+// as a bitset, so the work is bounded by (number of vertices) x (length bound)
+// regardless of the number of paths. The lengths achievable for an edge pair
+// are cached and reused by the subsequent queries with the same or a smaller
+// upper bound. The oracle is not thread-safe, use one per thread.
+template<class Graph>
+class PathLengthOracle {
+    typedef typename Graph::EdgeId EdgeId;
+    typedef typename Graph::VertexId VertexId;
+    typedef std::vector<uint64_t> Lengths;
+
+    struct Entry {
+        size_t bound;
+        Lengths lengths;
+    };
+
+public:
+    explicit PathLengthOracle(const Graph &g, size_t max_cached = 1 << 16)
+            : g_(g), max_cached_(max_cached) {}
+
+    // Whether there is a path from the end of e1 to the start of e2 with
+    // length in [min_len, max_len]
+    bool HasPath(EdgeId e1, EdgeId e2, size_t min_len, size_t max_len) {
+        if (min_len > max_len)
+            return false;
+
+        auto key = std::make_pair(e1.int_id(), e2.int_id());
+        auto it = cache_.find(key);
+        if (it == cache_.end() || it->second.bound < max_len) {
+            if (cache_.size() >= max_cached_) {
+                cache_.clear();
+                it = cache_.end();
+            }
+
+            Entry entry{max_len, CountLengths(g_.EdgeEnd(e1), g_.EdgeStart(e2), max_len)};
+            if (it == cache_.end())
+                it = cache_.emplace(key, std::move(entry)).first;
+            else
+                it->second = std::move(entry);
+        }
+
+        return AnySet(it->second.lengths, min_len, max_len);
+    }
+
+private:
+    static bool AnySet(const Lengths &lengths, size_t from, size_t to) {
+        for (size_t i = from; i <= to && i / 64 < lengths.size(); ++i) {
+            if (i % 64 == 0 && i + 63 <= to) {
+                if (lengths[i / 64])
+                    return true;
+                i += 63;
+                continue;
+            }
+            if (lengths[i / 64] >> (i % 64) & 1)
+                return true;
+        }
+        return false;
+    }
+
+    // dst |= (src << shift) restricted to the lengths not exceeding limit,
+    // returns whether dst changed
+    static bool ShiftOr(const Lengths &src, size_t shift, size_t limit, Lengths &dst) {
+        size_t word_shift = shift / 64, bit_shift = shift % 64;
+        bool changed = false;
+        for (size_t i = word_shift; i < dst.size() && i * 64 <= limit; ++i) {
+            size_t j = i - word_shift;
+            uint64_t v = src[j] << bit_shift;
+            if (bit_shift && j > 0)
+                v |= src[j - 1] >> (64 - bit_shift);
+            if (limit - i * 64 < 63)
+                v &= (uint64_t(1) << (limit - i * 64 + 1)) - 1;
+
+            uint64_t updated = dst[i] | v;
+            changed |= (updated != dst[i]);
+            dst[i] = updated;
+        }
+        return changed;
+    }
+
+    // Lengths (not exceeding bound) of the paths from start to end
+    Lengths CountLengths(VertexId start, VertexId end, size_t bound) const {
+        // Distances from start prune the vertices which cannot be on a short enough path
+        auto dijkstra = DijkstraHelper<Graph>::CreateBoundedDijkstra(g_, bound,
+                                                                     PathProcessor<Graph>::MAX_DIJKSTRA_VERTICES);
+        dijkstra.Run(start);
+
+        size_t words = bound / 64 + 1;
+        if (!dijkstra.DistanceCounted(end))
+            return Lengths(words, 0);
+
+        // Lengths of the paths from the vertex to end
+        phmap::flat_hash_map<VertexId, Lengths> suffix;
+        phmap::flat_hash_set<VertexId> queued;
+        std::deque<VertexId> queue;
+
+        suffix.emplace(end, Lengths(words, 0)).first->second[0] = 1;
+        queue.push_back(end);
+        queued.insert(end);
+        while (!queue.empty()) {
+            VertexId v = queue.front();
+            queue.pop_front();
+            queued.erase(v);
+
+            // The map may rehash below
+            Lengths lengths = suffix[v];
+            for (EdgeId e : g_.IncomingEdges(v)) {
+                VertexId u = g_.EdgeStart(e);
+                if (!dijkstra.DistanceCounted(u))
+                    continue;
+
+                size_t budget = bound - dijkstra.GetDistance(u);
+                if (g_.length(e) > budget)
+                    continue;
+
+                auto &target = suffix.try_emplace(u, words, 0).first->second;
+                if (ShiftOr(lengths, g_.length(e), budget, target) && queued.insert(u).second)
+                    queue.push_back(u);
+            }
+        }
+
+        auto it = suffix.find(start);
+        return it == suffix.end() ? Lengths(words, 0) : std::move(it->second);
+    }
+
+    const Graph &g_;
+    size_t max_cached_;
+    phmap::flat_hash_map<std::pair<uint64_t, uint64_t>, Entry> cache_;
+};
+
+}
@@ -35,6 +35,8 @@ struct pacbio_processor {
     int8_t gap_extend               = -6;
     int8_t gap_open_second          = -10;
     int8_t gap_extend_second        = -4;
+    // supporting sequences per gap used for consensus, 0 for no limit
+    size_t max_consensus_reads      = 20;
 };
 
 struct bwa_aligner {
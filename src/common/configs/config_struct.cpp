@@ -332,6 +332,7 @@ void load(debruijn_config::simplification::complex_bulge_remover& cbr,
   load(cbr.enabled, pt, "enabled");
   load(cbr.max_relative_length, pt, "max_relative_length", complete);
   load(cbr.max_length_difference, pt, "max_length_difference", complete);
+  load(cbr.parallel, pt, "parallel", complete);
 }
 
 void load(debruijn_config::simplification::erroneous_connections_remover& ec,
@@ -471,6 +472,7 @@ void load(pacbio_processor& pb,
   load(pb.gap_extend, pt, "gap_extend", false);
   load(pb.gap_open_second, pt, "gap_open_second", false);
   load(pb.gap_extend_second, pt, "gap_extend_second", false);
+  load(pb.max_consensus_reads, pt, "max_consensus_reads", false);
 }
 
 void load(debruijn_config::position_handler& pos,
@@ -242,6 +242,7 @@ struct debruijn_config {
             bool enabled;
             double max_relative_length;
             size_t max_length_difference;
+            bool parallel;
         };
 
         struct hidden_ec_remover {
@@ -19,10 +19,17 @@
 #include "library/library_fwd.hpp"
 #include "utils/filesystem/file_opener.hpp"
 #include "utils/logger/logger.hpp"
+#include "utils/memory_limit.hpp"
 
 #include "threadpool/threadpool.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <future>
+#include <mutex>
+#include <numeric>
 
 
 namespace io {
@@ -165,18 +172,137 @@ void ReadConverter::WriteBinaryInfo(const std::filesystem::path &filename, Libra
     data.binary_reads_info.binary_converted = true;
 }
 
+namespace {
+
+// Rough upper bound of the memory held by a single library conversion: both
+// BinaryWriter buffers of parsed reads plus the reads prefetched by the
+// asynchronous input streams
+size_t ConversionMemory(const SequencingLibraryT &lib) {
+    const size_t READS_IN_FLIGHT = 4 * 50000;
+    const size_t read_bytes = lib.is_long_read_lib() || lib.is_contig_lib() ? 32768 : 1024;
+    return READS_IN_FLIGHT * read_bytes;
+}
+
+bool HasBAMInput(const SequencingLibraryT &lib) {
+    for (const auto &file : lib.reads()) {
+        if (std::filesystem::path(file).extension() == ".bam")
+            return true;
+    }
+    return false;
+}
+
+size_t InputSize(const SequencingLibraryT &lib) {
+    size_t size = 0;
+    for (const auto &file : lib.reads()) {
+        std::error_code ec;
+        size_t file_size = std::filesystem::file_size(file, ec);
+        size += ec ? 0 : file_size;
+    }
+    return size;
+}
+
+// Admits conversions while their estimated memory fits into the budget. A
+// conversion larger than the whole budget is admitted alone.
+class MemoryBudget {
+public:
+    explicit MemoryBudget(size_t budget)
+            : available_(budget), budget_(budget) {}
+
+    size_t Acquire(size_t amount) {
+        amount = std::min(amount, budget_);
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] { return available_ >= amount; });
+        available_ -= amount;
+        return amount;
+    }
+
+    void Release(size_t amount) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            available_ += amount;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t available_;
+    const size_t budget_;
+};
+
+}
+
 void ConvertIfNeeded(DataSet<LibraryData> &data, unsigned nthreads,
                      FileReadFlags flags,
                      ReadTagger<io::SingleRead> tagger) {
-    std::unique_ptr<ThreadPool::ThreadPool> pool;
-
-    if (nthreads && nthreads > 1)
-        pool = std::make_unique<ThreadPool::ThreadPool>(nthreads);
-
+    std::vector<SequencingLibraryT*> libs;
     for (auto &lib : data) {
         if (!ReadConverter::LoadLibIfExists(lib))
-            ReadConverter::ConvertToBinary(lib, pool.get(), flags, tagger);
+            libs.push_back(&lib);
+    }
+    if (libs.empty())
+        return;
+
+    // Every library is parsed by its own driver thread, while async reading
+    // and flushing of all of them share the pool. Libraries are independent
+    // (separate binary files and info), so several of them are converted at
+    // once. Largest inputs go first to balance the drivers. The drivers are
+    // taken out of the thread budget, the pool gets the rest of it.
+    std::vector<size_t> sizes;
+    for (const auto *lib : libs)
+        sizes.push_back(InputSize(*lib));
+    std::vector<size_t> order(libs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    size_t drivers = std::min(libs.size(), (size_t)std::max(1u, nthreads / 2));
+    size_t pool_size = drivers == 1 ? nthreads : nthreads - drivers;
+
+    // BAM blocks are inflated by extra threads of every parser. Half of the
+    // pool is given to them, a driver reads at most a pair of files at once
+    if (std::any_of(libs.begin(), libs.end(), [](const auto *lib) { return HasBAMInput(*lib); })) {
+        size_t inflate_threads = std::min<size_t>(pool_size / 2 / (2 * drivers), 255);
+        flags.inflate_threads = unsigned(inflate_threads);
+        pool_size -= 2 * drivers * inflate_threads;
+        if (inflate_threads)
+            INFO("Using " << inflate_threads << " threads per BAM file for decompression");
     }
+
+    std::unique_ptr<ThreadPool::ThreadPool> pool;
+    if (pool_size > 1)
+        pool = std::make_unique<ThreadPool::ThreadPool>(pool_size);
+
+    if (drivers == 1) {
+        for (size_t i : order)
+            ReadConverter::ConvertToBinary(*libs[i], pool.get(), flags, tagger);
+        return;
+    }
+
+    INFO("Converting " << libs.size() << " libraries using up to " << drivers << " concurrent conversions"
+         " and " << pool_size << " reading threads");
+    MemoryBudget budget(utils::get_free_memory() / 2);
+    std::atomic<size_t> next(0);
+    auto driver = [&] {
+        for (size_t job = next++; job < order.size(); job = next++) {
+            auto &lib = *libs[order[job]];
+            size_t memory = budget.Acquire(ConversionMemory(lib));
+            try {
+                ReadConverter::ConvertToBinary(lib, pool.get(), flags, tagger);
+            } catch (...) {
+                budget.Release(memory);
+                throw;
+            }
+            budget.Release(memory);
+        }
+    };
+
+    std::vector<std::future<void>> tasks;
+    for (size_t i = 0; i < drivers; ++i)
+        tasks.push_back(std::async(std::launch::async, driver));
+    for (auto &task : tasks)
+        task.get();
 }
 
 BinaryPairedStreams paired_binary_readers(SequencingLibraryT &lib,
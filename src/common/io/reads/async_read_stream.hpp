@@ -37,11 +37,12 @@ class AsyncReadStream {
 
             // Swap buffers
             std::swap(read_buffer_, write_buffer_);
+            read_size_ = write_size_;
             read_pos_ = 0;
-            write_buffer_.clear();
+            write_size_ = 0;
 
             // See, if there is still something to read
-            eof_ = (read_buffer_.size() == 0);
+            eof_ = (read_size_ == 0);
 
             // Submit new job
             if (has_more) dispatch_write_job();
@@ -53,9 +54,11 @@ class AsyncReadStream {
             wait_writing_buffer();
         }
 
-        t = std::move(read_buffer_[read_pos_++]);
+        // The read previously held by the caller goes back to the buffer, so
+        // the storage of its strings is reused by the next fill
+        std::swap(t, read_buffer_[read_pos_++]);
 
-        if (read_pos_ == read_buffer_.size()) {
+        if (read_pos_ == read_size_) {
             wait_writing_buffer();
         }
 
@@ -93,8 +96,7 @@ class AsyncReadStream {
 
   private:
     void init() {
-        read_buffer_.clear();
-        write_buffer_.clear();
+        read_size_ = write_size_ = 0;
         read_pos_ = 0;
 
         read_buffer_.reserve(BUF_SIZE);
@@ -108,10 +110,11 @@ class AsyncReadStream {
     void dispatch_write_job() {
         write_task_ =
                 pool_.run([this] {
-                              while (write_buffer_.size() < BUF_SIZE && !stream_.eof()) {
-                                  ReadType r;
-                                  stream_ >> r;
-                                  write_buffer_.emplace_back(std::move(r));
+                              // Buffered reads are refilled in place
+                              while (write_size_ < BUF_SIZE && !stream_.eof()) {
+                                  if (write_size_ == write_buffer_.size())
+                                      write_buffer_.emplace_back();
+                                  stream_ >> write_buffer_[write_size_++];
                               }
 
                               return !stream_.eof();
@@ -121,8 +124,10 @@ class AsyncReadStream {
     ReadStream<ReadType> stream_;
 
     std::vector<ReadType> read_buffer_;
+    size_t read_size_ = 0;
     size_t read_pos_ = 0;
     std::vector<ReadType> write_buffer_;
+    size_t write_size_ = 0;
     bool eof_ = false;
     bool start_ = true;
 
@@ -19,28 +19,32 @@
 
 namespace io {
 
+// Lock is needed if the index is updated concurrently
 class KmerMultiplicityFiller {
     std::vector<unsigned> &mlts_;
     const kmers::CQFKmerFilter &kmer_mlt_index_;
+    const bool lock_;
 
 public:
     KmerMultiplicityFiller(std::vector<unsigned> &mlts,
-                           const kmers::CQFKmerFilter &kmer_mlt_index) :
-            mlts_(mlts), kmer_mlt_index_(kmer_mlt_index) {}
+                           const kmers::CQFKmerFilter &kmer_mlt_index,
+                           bool lock = false) :
+            mlts_(mlts), kmer_mlt_index_(kmer_mlt_index), lock_(lock) {}
 
     void ProcessKmer(const RtSeq &/*kmer*/, uint64_t hash) {
-        mlts_.push_back(unsigned(kmer_mlt_index_.lookup(hash)));
+        mlts_.push_back(unsigned(kmer_mlt_index_.lookup(hash, lock_)));
     }
 };
 
 template<class Hasher>
 unsigned CountMedianMlt(const Sequence &s, unsigned k, const Hasher &hasher,
-                        const kmers::CQFKmerFilter &kmer_mlt_index) {
+                        const kmers::CQFKmerFilter &kmer_mlt_index,
+                        bool lock = false) {
     if (s.size() < k)
         return 0;
 
     std::vector<unsigned> mlts;
-    KmerMultiplicityFiller mlt_filler(mlts, kmer_mlt_index);
+    KmerMultiplicityFiller mlt_filler(mlts, kmer_mlt_index, lock);
     kmers::KmerSequenceProcessor<Hasher, KmerMultiplicityFiller> processor(hasher, mlt_filler);
     processor.ProcessSequence(s, k);
 
@@ -98,6 +102,92 @@ public:
 
 };
 
+class KmerMultiplicityUpdater {
+    kmers::CQFKmerFilter &kmer_mlt_index_;
+
+public:
+    KmerMultiplicityUpdater(kmers::CQFKmerFilter &kmer_mlt_index) :
+            kmer_mlt_index_(kmer_mlt_index) {}
+
+    void ProcessKmer(const RtSeq &/*kmer*/, uint64_t hash) {
+        kmer_mlt_index_.add(hash, /* count */ 1, /* lock */ true, /* spin */ true);
+    }
+};
+
+// Digital normalization: read is retained only if the median multiplicity of
+// its k-mers among the reads retained so far is below the target, k-mers of
+// the retained reads are counted immediately. The index is shared between
+// threads, so the decision for concurrently processed reads is approximate.
+template<class Hasher>
+class DigitalNormalizerBase {
+    const unsigned k_;
+    const Hasher hasher_;
+    kmers::CQFKmerFilter &kmer_mlt_index_;
+    const unsigned target_;
+public:
+    DigitalNormalizerBase(unsigned k, const Hasher &hasher,
+                          kmers::CQFKmerFilter &kmer_mlt_index,
+                          unsigned target) :
+            k_(k), hasher_(hasher),
+            kmer_mlt_index_(kmer_mlt_index), target_(target) {
+    }
+
+    // Reads shorter than k carry no k-mers and are never retained
+    bool CheckBelowTarget(const Sequence &s) const {
+        return s.size() >= k_ && CountMedianMlt(s, k_, hasher_, kmer_mlt_index_, /* lock */ true) < target_;
+    }
+
+    void CountKmers(const Sequence &s) const {
+        if (s.size() < k_)
+            return;
+
+        KmerMultiplicityUpdater updater(kmer_mlt_index_);
+        kmers::KmerSequenceProcessor<Hasher, KmerMultiplicityUpdater> processor(hasher_, updater);
+        processor.ProcessSequence(s, k_);
+    }
+};
+
+template<class SingleReadType, class Hasher>
+class DigitalNormalizer : public DigitalNormalizerBase<Hasher> {
+    typedef DigitalNormalizerBase<Hasher> base;
+public:
+    DigitalNormalizer(unsigned k, const Hasher &hasher,
+                      kmers::CQFKmerFilter &kmer_mlt_index,
+                      unsigned target) :
+            base(k, hasher, kmer_mlt_index, target) {}
+
+    bool operator()(const SingleReadType &r) const {
+        Sequence s = r.sequence();
+        if (!this->CheckBelowTarget(s))
+            return false;
+
+        this->CountKmers(s);
+        return true;
+    }
+};
+
+template<class SingleReadType, class Hasher>
+class DigitalNormalizer<UniversalPairedRead<SingleReadType>, Hasher> : public DigitalNormalizerBase<Hasher> {
+    typedef DigitalNormalizerBase<Hasher> base;
+    typedef UniversalPairedRead<SingleReadType> PairedReadType;
+public:
+    DigitalNormalizer(unsigned k, const Hasher &hasher,
+                      kmers::CQFKmerFilter &kmer_mlt_index,
+                      unsigned target) :
+            base(k, hasher, kmer_mlt_index, target) {}
+
+    // The pair is retained if any of the reads brings new information
+    bool operator()(const PairedReadType& r) const {
+        Sequence s1 = r.first().sequence(), s2 = r.second().sequence();
+        if (!this->CheckBelowTarget(s1) && !this->CheckBelowTarget(s2))
+            return false;
+
+        this->CountKmers(s1);
+        this->CountKmers(s2);
+        return true;
+    }
+};
+
 template<class ReadType, class Hasher>
 inline ReadStream<ReadType> CovFilteringWrap(ReadStream<ReadType> reader,
                                              unsigned k, const Hasher &hasher,
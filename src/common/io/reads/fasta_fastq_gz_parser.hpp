@@ -89,6 +89,40 @@ public:
         return *this;
     }
 
+    /*
+     * Append reads to the batch right from the parser buffers.
+     */
+    /* virtual */
+    size_t Read(ReadBatch &batch, size_t max_reads, size_t max_bytes) {
+        size_t cnt = 0, start = batch.bytes();
+        for (; cnt < max_reads && batch.bytes() - start < max_bytes && is_open_ && !eof_; ++cnt) {
+            std::string_view seq(seq_->seq.s, seq_->seq.l);
+            std::string_view comment;
+            if (seq_->comment.s)
+                comment = std::string_view(seq_->comment.s, seq_->comment.l);
+
+            if (seq_->qual.s && flags_.use_name && flags_.use_quality) {
+                std::string_view name;
+                if (seq_->name.s)
+                    name = std::string_view(seq_->name.s, seq_->name.l);
+                batch.push_back(name, comment, seq,
+                                std::string_view(seq_->qual.s, seq_->qual.l), flags_.offset,
+                                0, 0, flags_.validate);
+            } else if (flags_.use_name && seq_->name.s) {
+                batch.push_back(std::string_view(seq_->name.s, seq_->name.l), comment, seq,
+                                {}, 0, 0, 0, flags_.validate);
+            } else if (flags_.use_comment && seq_->comment.s) {
+                batch.push_back({}, comment, seq,
+                                {}, 0, 0, 0, flags_.validate);
+            } else
+                batch.push_back({}, {}, seq,
+                                {}, 0, 0, 0, flags_.validate);
+
+            ReadAhead();
+        }
+        return cnt;
+    }
+
     /*
      * Close the stream.
      */
@@ -29,6 +29,9 @@ struct FileReadFlags {
     bool use_quality  : 1;
     bool validate     : 1;
     bool paired       : 1;
+    // Extra threads decompressing the input in the background (BAM only),
+    // taken out of the caller's thread budget
+    unsigned inflate_threads : 8;
 
     static FileReadFlags empty() {
         return { PhredOffset,
@@ -57,14 +60,14 @@ struct FileReadFlags {
     
     FileReadFlags()
             : offset(PhredOffset),
-              use_name(true), use_comment(true), use_quality(true), validate(true), paired(false) {}
+              use_name(true), use_comment(true), use_quality(true), validate(true), paired(false), inflate_threads(0) {}
     FileReadFlags(OffsetType o)
             : offset(o),
-              use_name(true), use_comment(true), use_quality(true), paired(false) {}
+              use_name(true), use_comment(true), use_quality(true), paired(false), inflate_threads(0) {}
     FileReadFlags(OffsetType o, bool n, bool q)
-            : offset(o), use_name(n), use_comment(n), use_quality(q), paired(false) {}
+            : offset(o), use_name(n), use_comment(n), use_quality(q), paired(false), inflate_threads(0) {}
     FileReadFlags(OffsetType o, bool n, bool c, bool q, bool v)
-            : offset(o), use_name(n), use_comment(c), use_quality(q), validate(v), paired(false) {}
+            : offset(o), use_name(n), use_comment(c), use_quality(q), validate(v), paired(false), inflate_threads(0) {}
 };
 
 }
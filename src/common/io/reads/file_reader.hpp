@@ -27,6 +27,11 @@
 namespace io {
 
 class FileReadStream {
+    // Reads are parsed in chunks and copied out in place. The chunk is
+    // bounded in bytes as well, so long reads do not blow up the read-ahead
+    static constexpr size_t BATCH_SIZE = 1024;
+    static constexpr size_t BATCH_BYTES = 4 << 20;
+
 public:
     typedef SingleRead ReadT;
     
@@ -40,7 +45,7 @@ public:
      */
     explicit FileReadStream(const std::filesystem::path &filename,
                             FileReadFlags flags = FileReadFlags())
-            : filename_(filename), flags_(flags), parser_(nullptr) {
+            : filename_(filename), flags_(flags), parser_(nullptr), batch_pos_(0) {
         CHECK_FATAL_ERROR(exists(filename), "File " << filename << " doesn't exist or can't be read!");
         parser_.reset(SelectParser(filename_, flags_));
     }
@@ -67,7 +72,7 @@ public:
         if (!parser_)
             return true;
 
-        return parser_->eof();
+        return batch_pos_ == batch_.size() && parser_->eof();
     }
 
     /*
@@ -78,12 +83,42 @@ public:
      * @return Reference to this stream.
      */
     FileReadStream &operator>>(SingleRead &singleread) {
-        if (parser_)
-            (*parser_) >> singleread;
+        if (!parser_)
+            return *this;
+
+        if (batch_pos_ == batch_.size()) {
+            batch_.clear();
+            batch_pos_ = 0;
+            parser_->Read(batch_, BATCH_SIZE, BATCH_BYTES);
+        }
+
+        if (batch_pos_ < batch_.size())
+            batch_[batch_pos_++].CopyTo(singleread);
 
         return *this;
     }
 
+    /*
+     * Append at most max_reads reads to the batch, stop earlier once they
+     * take max_bytes.
+     *
+     * @return The number of reads appended.
+     */
+    size_t Read(ReadBatch &batch, size_t max_reads, size_t max_bytes = BATCH_BYTES) {
+        if (!parser_)
+            return 0;
+
+        size_t cnt = 0, start = batch.bytes();
+        for (; cnt < max_reads && batch.bytes() - start < max_bytes && batch_pos_ < batch_.size(); ++cnt)
+            batch.push_back(batch_[batch_pos_++]);
+
+        size_t bytes = batch.bytes() - start;
+        if (bytes >= max_bytes)
+            return cnt;
+
+        return cnt + parser_->Read(batch, max_reads - cnt, max_bytes - bytes);
+    }
+
     /*
      * Close the stream.
      */
@@ -92,6 +127,8 @@ public:
             return;
 
         parser_->close();
+        batch_.clear();
+        batch_pos_ = 0;
     }
 
     /*
@@ -102,6 +139,8 @@ public:
             return;
 
         parser_->reset();
+        batch_.clear();
+        batch_pos_ = 0;
     }
 
 private:
@@ -111,7 +150,9 @@ private:
     FileReadFlags flags_;
     /* @variable Internal stream that reads from file. */
     std::unique_ptr<Parser> parser_;
-
+    /* @variable Reads parsed ahead and the position of the next one. */
+    ReadBatch batch_;
+    size_t batch_pos_;
 };
 
 }
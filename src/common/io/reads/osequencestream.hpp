@@ -14,7 +14,9 @@
 #include "header_naming.hpp"
 
 #include "library/library_fwd.hpp"
+#include "utils/parallel/openmp_wrapper.h"
 
+#include <algorithm>
 #include <fstream>
 #include <string>
 #include <vector>
@@ -29,6 +31,45 @@ inline void WriteWrapped(const std::string &s, std::ostream &os, size_t max_widt
     }
 }
 
+inline void AppendWrapped(const std::string &s, std::string &out, size_t max_width = 60) {
+    for (size_t cur = 0; cur < s.size(); cur += max_width) {
+        out.append(s, cur, max_width);
+        out.push_back('\n');
+    }
+}
+
+inline void AppendFasta(const std::string &name, const std::string &s, std::string &out) {
+    out.push_back('>');
+    out.append(name);
+    out.push_back('\n');
+    AppendWrapped(s, out);
+}
+
+// Formats count records in parallel and emits them to the stream in their
+// original order. Records are formatted in chunks, so only a bounded number
+// of them is kept in memory at once. formatter(idx, out) should append the
+// text of idx-th record to out and must be safe to call concurrently.
+template<class Formatter>
+void WriteOrdered(std::ostream &os, size_t count, const Formatter &formatter,
+                  size_t chunk_size = 0) {
+    if (!chunk_size)
+        chunk_size = 1024 * omp_get_max_threads();
+
+    std::vector<std::string> buffers(std::min(chunk_size, count));
+    for (size_t start = 0; start < count; start += chunk_size) {
+        size_t end = std::min(count, start + chunk_size);
+        #pragma omp parallel for schedule(guided)
+        for (size_t i = start; i < end; ++i) {
+            std::string &buf = buffers[i - start];
+            buf.clear();
+            formatter(i, buf);
+        }
+
+        for (size_t i = start; i < end; ++i)
+            os.write(buffers[i - start].data(), buffers[i - start].size());
+    }
+}
+
 class osequencestream {
 protected:
     std::ofstream ofstream_;
@@ -28,6 +28,7 @@
 #define COMMON_IO_PARSER_HPP
 
 #include "single_read.hpp"
+#include "read_batch.hpp"
 #include "file_read_flags.hpp"
 #include <string>
 
@@ -79,6 +80,22 @@ public:
      */
     virtual Parser &operator>>(SingleRead &read) = 0;
 
+    /*
+     * Append at most max_reads reads to the batch, stop earlier once they
+     * take max_bytes.
+     *
+     * @return The number of reads appended.
+     */
+    virtual size_t Read(ReadBatch &batch, size_t max_reads, size_t max_bytes) {
+        SingleRead read;
+        size_t cnt = 0, start = batch.bytes();
+        for (; cnt < max_reads && batch.bytes() - start < max_bytes && !eof(); ++cnt) {
+            *this >> read;
+            batch.push_back(read);
+        }
+        return cnt;
+    }
+
     /*
      * Close the stream.
      */
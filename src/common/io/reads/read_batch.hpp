@@ -0,0 +1,294 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "single_read.hpp"
+
+#include "sequence/nucl.hpp"
+#include "sequence/sequence.hpp"
+#include "utils/verify.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace io {
+
+class ReadBatch;
+
+/*
+ * Lightweight view of a read stored in ReadBatch. It is invalidated by any
+ * modification of the batch.
+ */
+class ReadView {
+public:
+    std::string_view name() const;
+    std::string_view comment() const;
+
+    size_t size() const;
+    size_t qual_size() const;
+
+    size_t nucl_count() const {
+        return size();
+    }
+
+    bool IsValid() const;
+
+    SequenceOffsetT GetLeftOffset() const;
+    SequenceOffsetT GetRightOffset() const;
+
+    /*
+     * Return ith nucleotide of the read as it was in the input.
+     */
+    char nucl(size_t i) const;
+
+    /*
+     * Return ith nucleotide of the read in unreadable form (0, 1, 2 or 3).
+     */
+    char operator[](size_t i) const {
+        char c = nucl(i);
+        VERIFY(is_nucl(c));
+        return dignucl(c);
+    }
+
+    /*
+     * Return quality of the ith nucleotide without the offset.
+     */
+    char quality(size_t i) const;
+
+    // Writes the sequence into the string reusing its storage
+    void GetSequenceString(std::string &seq) const;
+
+    std::string GetSequenceString() const {
+        std::string seq;
+        GetSequenceString(seq);
+        return seq;
+    }
+
+    Sequence sequence(bool rc = false) const;
+
+    // Refills the read reusing the storage of its strings
+    void CopyTo(SingleRead &read) const;
+
+    SingleRead read() const {
+        SingleRead res;
+        CopyTo(res);
+        return res;
+    }
+
+    bool BinWrite(std::ostream &file, bool rc = false, uint64_t tag = 0) const;
+
+private:
+    friend class ReadBatch;
+
+    ReadView(const ReadBatch &batch, size_t idx)
+            : batch_(&batch), idx_(idx) {}
+
+    const ReadBatch *batch_;
+    size_t idx_;
+};
+
+/*
+ * Chunk of reads kept in two contiguous arenas instead of separate strings
+ * per read: names, comments and sequences are concatenated as they are in
+ * the input, qualities are stored without offset. Sequences are kept in
+ * plain text, as nearly every consumer wants them back as a string or a
+ * Sequence right away. Clearing the batch keeps the arenas, so a reused
+ * batch stops allocating once it reaches the size of a typical chunk.
+ */
+class ReadBatch {
+    struct Record {
+        uint64_t text;      // name, comment and sequence in text_
+        uint64_t qual;      // first quality in qual_
+        uint32_t name_size;
+        uint32_t comment_size;
+        uint32_t size;
+        uint32_t qual_size;
+        SequenceOffsetT left_offset;
+        SequenceOffsetT right_offset;
+        bool valid;
+    };
+
+public:
+    size_t size() const {
+        return records_.size();
+    }
+
+    bool empty() const {
+        return records_.empty();
+    }
+
+    // Bytes of read data stored in the batch
+    size_t bytes() const {
+        return text_.size() + qual_.size() + records_.size() * sizeof(Record);
+    }
+
+    ReadView operator[](size_t idx) const {
+        VERIFY(idx < records_.size());
+        return ReadView(*this, idx);
+    }
+
+    void clear() {
+        records_.clear();
+        text_.clear();
+        qual_.clear();
+    }
+
+    /*
+     * Append the read to the batch.
+     *
+     * @param qual_offset The offset subtracted from the quality symbols.
+     * @param validate Check the read and mark it valid if it consists of ACGT only.
+     */
+    void push_back(std::string_view name, std::string_view comment,
+                   std::string_view seq, std::string_view qual = {},
+                   int qual_offset = 0,
+                   SequenceOffsetT left_offset = 0, SequenceOffsetT right_offset = 0,
+                   bool validate = true) {
+        Record r;
+        r.text = text_.size();
+        r.qual = qual_.size();
+        r.name_size = uint32_t(name.size());
+        r.comment_size = uint32_t(comment.size());
+        r.size = uint32_t(seq.size());
+        r.qual_size = uint32_t(qual.size());
+        r.left_offset = left_offset;
+        r.right_offset = right_offset;
+
+        text_.append(name);
+        text_.append(comment);
+        text_.append(seq);
+
+        for (char c : qual)
+            qual_.push_back(char(c - qual_offset));
+
+        r.valid = false;
+        if (validate) {
+            CHECK_FATAL_ERROR(!qual.size() || seq.size() == qual.size(),
+                              "Invalid read: length of sequence should equal to length of quality line");
+            r.valid = SingleRead::IsValid(seq);
+        }
+        records_.push_back(r);
+    }
+
+    void push_back(const ReadView &read) {
+        const Record &other = read.batch_->records_[read.idx_];
+        Record r = other;
+        r.text = text_.size();
+        r.qual = qual_.size();
+
+        const ReadBatch &batch = *read.batch_;
+        text_.append(batch.text_, other.text,
+                     other.name_size + other.comment_size + other.size);
+        qual_.append(batch.qual_, other.qual, other.qual_size);
+        records_.push_back(r);
+    }
+
+    void push_back(const SingleRead &read) {
+        push_back(read.name(), read.comment(),
+                  read.GetSequenceString(), read.GetQualityString(), 0,
+                  read.GetLeftOffset(), read.GetRightOffset(), /*validate*/false);
+        records_.back().valid = read.IsValid();
+    }
+
+private:
+    friend class ReadView;
+
+    std::string_view seq(const Record &r) const {
+        return std::string_view(text_.data() + r.text + r.name_size + r.comment_size, r.size);
+    }
+
+    std::vector<Record> records_;
+    std::string text_;
+    std::string qual_;
+};
+
+inline std::string_view ReadView::name() const {
+    const auto &r = batch_->records_[idx_];
+    return std::string_view(batch_->text_.data() + r.text, r.name_size);
+}
+
+inline std::string_view ReadView::comment() const {
+    const auto &r = batch_->records_[idx_];
+    return std::string_view(batch_->text_.data() + r.text + r.name_size, r.comment_size);
+}
+
+inline size_t ReadView::size() const {
+    return batch_->records_[idx_].size;
+}
+
+inline size_t ReadView::qual_size() const {
+    return batch_->records_[idx_].qual_size;
+}
+
+inline bool ReadView::IsValid() const {
+    return batch_->records_[idx_].valid;
+}
+
+inline SequenceOffsetT ReadView::GetLeftOffset() const {
+    return batch_->records_[idx_].left_offset;
+}
+
+inline SequenceOffsetT ReadView::GetRightOffset() const {
+    return batch_->records_[idx_].right_offset;
+}
+
+inline char ReadView::nucl(size_t i) const {
+    const auto &r = batch_->records_[idx_];
+    VERIFY(i < r.size);
+    return batch_->seq(r)[i];
+}
+
+inline char ReadView::quality(size_t i) const {
+    const auto &r = batch_->records_[idx_];
+    VERIFY(i < r.qual_size);
+    return batch_->qual_[r.qual + i];
+}
+
+inline void ReadView::GetSequenceString(std::string &seq) const {
+    seq.assign(batch_->seq(batch_->records_[idx_]));
+}
+
+inline Sequence ReadView::sequence(bool rc) const {
+    if (!size())
+        return Sequence();
+
+    return Sequence(batch_->seq(batch_->records_[idx_]), rc);
+}
+
+inline void ReadView::CopyTo(SingleRead &read) const {
+    const auto &r = batch_->records_[idx_];
+    read.name_.assign(name());
+    read.comment_.assign(comment());
+    GetSequenceString(read.seq_);
+    read.qual_.assign(batch_->qual_, r.qual, r.qual_size);
+// Silence bogus GCC warnings
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wconversion"
+    read.left_offset_ = r.left_offset;
+    read.right_offset_ = r.right_offset;
+#pragma GCC diagnostic pop
+    read.valid_ = r.valid;
+}
+
+inline bool ReadView::BinWrite(std::ostream &file, bool rc, uint64_t tag) const {
+    sequence(rc).BinWrite(file);
+    SequenceOffsetT left_offset = GetLeftOffset(), right_offset = GetRightOffset();
+    if (rc) {
+        file.write((const char *) &right_offset, sizeof(right_offset));
+        file.write((const char *) &left_offset, sizeof(left_offset));
+    } else {
+        file.write((const char *) &left_offset, sizeof(left_offset));
+        file.write((const char *) &right_offset, sizeof(right_offset));
+    }
+
+    file.write((const char *) &tag, sizeof(tag));
+    return !file.fail();
+}
+
+}
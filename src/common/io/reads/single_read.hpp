@@ -17,12 +17,15 @@
 #include "utils/logger/logger.hpp"
 
 #include <string>
+#include <string_view>
 
 namespace io {
 
 //todo extract code about offset from here
 typedef uint16_t SequenceOffsetT;
 
+class ReadView;
+
 class SingleRead {
 public:
 
@@ -197,7 +200,7 @@ public:
         name_ = new_name;
     }
 
-    static bool IsValid(const std::string &seq) {
+    static bool IsValid(std::string_view seq) {
         size_t sz = seq.size();
         for (size_t i = 0; i < sz; ++i) {
             if (!is_nucl(seq[i]))
@@ -235,6 +238,9 @@ public:
     }
 
 private:
+    // Refills reads in place
+    friend class ReadView;
+
     /*
      * @variable The name of SingleRead in input file.
      */
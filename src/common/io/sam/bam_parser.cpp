@@ -7,40 +7,131 @@
 
 #include "bam_parser.hpp"
 
-#include <bamtools/api/BamReader.h>
+#include "utils/logger/logger.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
 
 namespace io {
 
+namespace {
+// Fixed-size part of the alignment record following block_size
+const size_t BAM_CORE_SIZE = 32;
+// Quality bytes are stored as raw Phred scores, readers expect them as Phred+33
+const char BAM_QUAL_OFFSET = 33;
+
+uint32_t LoadU32(const uint8_t *p) { return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24; }
+uint16_t LoadU16(const uint8_t *p) { return uint16_t(p[0] | p[1] << 8); }
+
+// Two nucleotides are packed into a byte, decode them at once
+const std::array<std::array<char, 2>, 256> &NuclPairs() {
+    static const std::array<std::array<char, 2>, 256> table = [] {
+        const char *nucls = "=ACMGRSVTWYHKDBN";
+        std::array<std::array<char, 2>, 256> res;
+        for (size_t i = 0; i < 256; ++i)
+            res[i] = { nucls[i >> 4], nucls[i & 0xF] };
+        return res;
+    }();
+    return table;
+}
+}
+
 BAMParser& BAMParser::operator>>(SingleRead& read) {
     if (!is_open_ || eof_)
         return *this;
 
-    if (flags_.use_name && flags_.use_quality)
-        read = SingleRead(seq_.Name, "", seq_.QueryBases, seq_.Qualities, flags_.offset,
+    if (flags_.use_name && flags_.use_quality && !qual_.empty())
+        read = SingleRead(std::move(name_), "", std::move(seq_), std::move(qual_), flags_.offset,
                           0, 0, flags_.validate);
     else if (flags_.use_name)
-        read = SingleRead(seq_.Name, "", seq_.QueryBases,
+        read = SingleRead(std::move(name_), "", std::move(seq_),
                           0, 0, flags_.validate);
     else
-        read = SingleRead(seq_.QueryBases,
+        read = SingleRead(std::move(seq_),
                           0, 0, flags_.validate);
 
-    eof_ = (false == reader_.GetNextAlignment(seq_));
+    eof_ = !NextRecord();
 
     return *this;
 }
 
 void BAMParser::close() {
-    reader_.Close();
+    reader_.reset();
     is_open_ = false;
     eof_ = true;
 }
 
 void BAMParser::open() {
-    reader_.Open(filename_);
+    reader_ = std::make_unique<BGZFReader>(filename_, unsigned(flags_.inflate_threads));
+    ReadHeader();
     is_open_ = true;
 
-    eof_ = (false == reader_.GetNextAlignment(seq_));
+    eof_ = !NextRecord();
+}
+
+void BAMParser::ReadHeader() {
+    uint8_t buf[4];
+    CHECK_FATAL_ERROR(reader_->read(buf, 4) && memcmp(buf, "BAM\1", 4) == 0,
+                      "Invalid BAM magic in " << filename_);
+
+    // SAM header text and the reference dictionary are of no use here
+    auto skip = [&](size_t size) {
+        record_.resize(size);
+        CHECK_FATAL_ERROR(reader_->read(record_.data(), size), "Truncated BAM header in " << filename_);
+    };
+
+    CHECK_FATAL_ERROR(reader_->read(buf, 4), "Truncated BAM header in " << filename_);
+    skip(LoadU32(buf));
+    CHECK_FATAL_ERROR(reader_->read(buf, 4), "Truncated BAM header in " << filename_);
+    for (uint32_t n_ref = LoadU32(buf); n_ref > 0; --n_ref) {
+        CHECK_FATAL_ERROR(reader_->read(buf, 4), "Truncated BAM header in " << filename_);
+        skip(LoadU32(buf) + 4);
+    }
+}
+
+bool BAMParser::NextRecord() {
+    uint8_t buf[4];
+    if (!reader_->read(buf, 4))
+        return false;
+
+    size_t size = LoadU32(buf);
+    CHECK_FATAL_ERROR(size >= BAM_CORE_SIZE, "Invalid BAM record in " << filename_);
+    record_.resize(size);
+    CHECK_FATAL_ERROR(reader_->read(record_.data(), size), "Truncated BAM record in " << filename_);
+
+    const uint8_t *core = record_.data();
+    size_t l_read_name = core[8];
+    size_t n_cigar_op = LoadU16(core + 12);
+    size_t l_seq = LoadU32(core + 16);
+    size_t name_pos = BAM_CORE_SIZE;
+    size_t seq_pos = name_pos + l_read_name + 4 * n_cigar_op;
+    size_t qual_pos = seq_pos + (l_seq + 1) / 2;
+    CHECK_FATAL_ERROR(l_read_name > 0 && qual_pos + l_seq <= size, "Invalid BAM record in " << filename_);
+
+    // Only name, sequence and qualities are decoded: position, CIGAR and
+    // auxiliary fields are skipped
+    if (flags_.use_name)
+        name_.assign((const char*)(core + name_pos), l_read_name - 1);
+    else
+        name_.clear();
+
+    const auto &pairs = NuclPairs();
+    seq_.resize(l_seq);
+    for (size_t i = 0; i + 1 < l_seq; i += 2)
+        memcpy(&seq_[i], pairs[core[seq_pos + i / 2]].data(), 2);
+    if (l_seq % 2)
+        seq_[l_seq - 1] = pairs[core[seq_pos + l_seq / 2]][0];
+
+    // 0xFF in the first byte means the qualities are absent
+    qual_.clear();
+    if (flags_.use_name && flags_.use_quality && l_seq && core[qual_pos] != 0xFF) {
+        qual_.resize(l_seq);
+        for (size_t i = 0; i < l_seq; ++i)
+            qual_[i] = char(core[qual_pos + i] + BAM_QUAL_OFFSET);
+    }
+
+    return true;
 }
 
 }
@@ -12,14 +12,18 @@
 #include "io/reads/single_read.hpp"
 #include "io/reads/parser.hpp"
 
-#include "bamtools/api/BamReader.h"
+#include "bgzf_reader.hpp"
 
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace io {
 
 class BAMParser: public Parser {
 public:
+    // BGZF blocks are inflated in the background by flags.inflate_threads
+    // threads, with zero threads they are inflated on the reading thread
     BAMParser(const std::string& filename,
               FileReadFlags flags = FileReadFlags())
             : Parser(filename, flags) {
@@ -37,10 +41,14 @@ public:
     void operator=(const BAMParser& parser) = delete;
 
 private:
-    BamTools::BamReader reader_;
-    BamTools::BamAlignment seq_;
+    std::unique_ptr<BGZFReader> reader_;
+    // Next record, decoded ahead to detect the end of file
+    std::vector<uint8_t> record_;
+    std::string name_, seq_, qual_;
 
     void open();
+    void ReadHeader();
+    bool NextRecord();
 };
 
 }
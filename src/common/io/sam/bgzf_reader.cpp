@@ -0,0 +1,170 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "bgzf_reader.hpp"
+
+#include "utils/logger/logger.hpp"
+
+#include <threadpool/threadpool.hpp>
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace io {
+
+namespace {
+// Fixed part of the gzip member header, up to and including XLEN
+const size_t BGZF_HEADER_SIZE = 12;
+const size_t BGZF_MAX_BLOCK_SIZE = 65536;
+// Blocks kept in flight per decompression thread
+const size_t BLOCKS_PER_THREAD = 4;
+
+uint16_t LoadU16(const uint8_t *p) { return uint16_t(p[0] | p[1] << 8); }
+uint32_t LoadU32(const uint8_t *p) { return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24; }
+}
+
+BGZFReader::BGZFReader(const std::string &filename, unsigned nthreads)
+        : filename_(filename), file_(fopen(filename.c_str(), "rb")), file_eof_(false),
+          max_inflight_(BLOCKS_PER_THREAD * std::max(nthreads, 1u)), pos_(0) {
+    CHECK_FATAL_ERROR(file_, "Cannot open BAM file " << filename);
+    if (nthreads)
+        pool_ = std::make_unique<ThreadPool::ThreadPool>(nthreads);
+    Prefetch();
+}
+
+BGZFReader::~BGZFReader() {
+    // Outstanding tasks reference nothing but their own blocks, yet the pool
+    // ones have to be drained before the pool goes away. Deferred blocks are
+    // dropped without inflating them: a corrupt one must not be fatal here
+    for (auto &f : inflight_) {
+        if (f.wait_for(std::chrono::seconds(0)) != std::future_status::deferred)
+            f.wait();
+    }
+    pool_.reset();
+    fclose(file_);
+}
+
+bool BGZFReader::ReadBlock(Block &block) {
+    if (file_eof_)
+        return false;
+
+    Buffer &bytes = block.bytes;
+    bytes.resize(BGZF_HEADER_SIZE);
+    size_t n = fread(bytes.data(), 1, BGZF_HEADER_SIZE, file_);
+    if (n == 0) {
+        file_eof_ = true;
+        return false;
+    }
+    CHECK_FATAL_ERROR(n == BGZF_HEADER_SIZE, "Truncated BGZF block header in " << filename_);
+    CHECK_FATAL_ERROR(bytes[0] == 31 && bytes[1] == 139 && bytes[2] == 8 && (bytes[3] & 4),
+                      "Invalid BGZF block header in " << filename_);
+
+    size_t xlen = LoadU16(bytes.data() + 10);
+    bytes.resize(BGZF_HEADER_SIZE + xlen);
+    CHECK_FATAL_ERROR(fread(bytes.data() + BGZF_HEADER_SIZE, 1, xlen, file_) == xlen,
+                      "Truncated BGZF block header in " << filename_);
+
+    // Find the BC subfield carrying the total block size
+    size_t bsize = 0;
+    for (size_t i = BGZF_HEADER_SIZE; i + 4 <= bytes.size(); ) {
+        size_t slen = LoadU16(bytes.data() + i + 2);
+        if (bytes[i] == 'B' && bytes[i + 1] == 'C' && slen == 2 && i + 6 <= bytes.size()) {
+            bsize = size_t(LoadU16(bytes.data() + i + 4)) + 1;
+            break;
+        }
+        i += 4 + slen;
+    }
+    block.header = bytes.size();
+    CHECK_FATAL_ERROR(bsize >= block.header + 8 && bsize <= BGZF_MAX_BLOCK_SIZE,
+                      "BGZF block size field is missing or invalid in " << filename_);
+
+    bytes.resize(bsize);
+    CHECK_FATAL_ERROR(fread(bytes.data() + block.header, 1, bsize - block.header, file_) == bsize - block.header,
+                      "Truncated BGZF block in " << filename_);
+
+    return true;
+}
+
+BGZFReader::Buffer BGZFReader::Inflate(const Block &block) {
+    const Buffer &bytes = block.bytes;
+    size_t size = bytes.size();
+    // The block ends with CRC32 and the uncompressed size
+    uint32_t crc = LoadU32(bytes.data() + size - 8);
+    uint32_t isize = LoadU32(bytes.data() + size - 4);
+    CHECK_FATAL_ERROR(isize <= BGZF_MAX_BLOCK_SIZE, "Invalid BGZF block: uncompressed size " << isize);
+
+    // Keep the output pointer valid for empty blocks, zlib rejects null
+    Buffer data(std::max(isize, 1u));
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    zs.next_in = const_cast<Bytef*>(bytes.data() + block.header);
+    zs.avail_in = uInt(size - block.header - 8);
+    zs.next_out = data.data();
+    zs.avail_out = uInt(isize);
+    // Raw deflate stream, the gzip framing is parsed by hand
+    CHECK_FATAL_ERROR(inflateInit2(&zs, -15) == Z_OK, "Failed to initialize inflate");
+    int ret = inflate(&zs, Z_FINISH);
+    inflateEnd(&zs);
+    CHECK_FATAL_ERROR(ret == Z_STREAM_END && zs.total_out == isize, "Corrupted BGZF block");
+    CHECK_FATAL_ERROR(crc32(crc32(0L, Z_NULL, 0), data.data(), uInt(isize)) == crc,
+                      "BGZF block CRC mismatch");
+    data.resize(isize);
+
+    return data;
+}
+
+void BGZFReader::Prefetch() {
+    while (inflight_.size() < max_inflight_) {
+        Block block;
+        if (!ReadBlock(block))
+            break;
+
+        if (pool_)
+            inflight_.push_back(pool_->run([block = std::move(block)] { return Inflate(block); }));
+        else
+            inflight_.push_back(std::async(std::launch::deferred, [block = std::move(block)] { return Inflate(block); }));
+    }
+}
+
+bool BGZFReader::NextBlock() {
+    // Empty blocks (e.g. the EOF marker) are simply skipped
+    while (!inflight_.empty()) {
+        data_ = inflight_.front().get();
+        inflight_.pop_front();
+        pos_ = 0;
+        Prefetch();
+        if (!data_.empty())
+            return true;
+    }
+
+    return false;
+}
+
+bool BGZFReader::eof() {
+    return pos_ == data_.size() && !NextBlock();
+}
+
+bool BGZFReader::read(void *dst, size_t size) {
+    uint8_t *out = static_cast<uint8_t*>(dst);
+    size_t done = 0;
+    while (done < size) {
+        if (pos_ == data_.size() && !NextBlock()) {
+            CHECK_FATAL_ERROR(done == 0, "Unexpected end of BGZF stream in " << filename_);
+            return false;
+        }
+
+        size_t n = std::min(size - done, data_.size() - pos_);
+        memcpy(out + done, data_.data() + pos_, n);
+        pos_ += n;
+        done += n;
+    }
+
+    return true;
+}
+
+}
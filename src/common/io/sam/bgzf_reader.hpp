@@ -0,0 +1,68 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ThreadPool {
+class ThreadPool;
+}
+
+namespace io {
+
+// Sequential reader of BGZF (blocked gzip) files. Blocks are independent
+// deflate streams, so the reader keeps up to a fixed number of blocks ahead
+// of the consumer and inflates them concurrently on its own thread pool.
+// With zero threads everything is inflated on the calling thread.
+class BGZFReader {
+public:
+    BGZFReader(const std::string &filename, unsigned nthreads);
+    ~BGZFReader();
+
+    BGZFReader(const BGZFReader&) = delete;
+    void operator=(const BGZFReader&) = delete;
+
+    // Copies exactly size bytes of decompressed data into dst. Returns false
+    // if the stream ended before the first byte, truncated data is fatal
+    bool read(void *dst, size_t size);
+
+    bool eof();
+
+private:
+    typedef std::vector<uint8_t> Buffer;
+
+    struct Block {
+        Buffer bytes;      // The whole compressed block as stored in the file
+        size_t header = 0; // Size of the gzip header preceding deflate data
+    };
+
+    // Reads the next compressed block from the file, false at the end of file
+    bool ReadBlock(Block &block);
+    void Prefetch();
+    bool NextBlock();
+
+    static Buffer Inflate(const Block &block);
+
+    std::string filename_;
+    FILE *file_;
+    bool file_eof_;
+
+    std::unique_ptr<ThreadPool::ThreadPool> pool_;
+    size_t max_inflight_;
+    std::deque<std::future<Buffer>> inflight_;
+
+    Buffer data_;
+    size_t pos_;
+};
+
+}
@@ -15,6 +15,7 @@
 #include "io/binary/binary.hpp"
 
 #include "utils/parallel/openmp_wrapper.h"
+#include "utils/parallel/process_pool.hpp"
 #include "utils/logger/logger.hpp"
 #include "utils/perf/timetracer.hpp"
 
@@ -43,6 +44,16 @@
 
 namespace kmers {
 
+// Settings of sharded k-mer counting / index construction. Every k-mer hash
+// shard is processed by a separate worker process with its own memory budget.
+struct ShardingOptions {
+  unsigned num_workers = 1;
+  // Per-worker address space limit in bytes, 0 means no limit
+  size_t worker_memory_limit = 0;
+  // Directory for the per-shard index files, counter work dir if empty
+  std::filesystem::path local_dir;
+};
+
 // TODO: Make interface
 template<class S, class traits = kmer_index_traits<S>>
 class KMerDiskStorage {
@@ -289,6 +300,47 @@ public:
     return storage;
   }
 
+  // Same as Count(), but every bucket (k-mer hash shard) is merged by one of
+  // the worker processes. process(i, storage) is invoked in the worker right
+  // after shard i is counted, so per-shard post-processing happens under the
+  // same memory cap. It must not use OpenMP.
+  template<class ShardProcessor>
+  KMerDiskStorage<Seq> CountSharded(unsigned num_shards, unsigned num_threads,
+                                    const ShardingOptions &opts, const ShardProcessor &process) {
+    INFO("Splitting kmer instances into " << num_shards << " shards using " << num_threads << " threads. This might take a while.");
+    TIME_TRACE_BEGIN("KMerDiskCounter::Split");
+    auto raw_kmers = splitter_->Split(num_shards, num_threads);
+    VERIFY(raw_kmers.size() == num_shards);
+    TIME_TRACE_END;
+
+    INFO("Starting sharded k-mer counting using " << opts.num_workers << " worker processes.");
+    KMerDiskStorage<Seq> res(work_dir_, this->k(), splitter_->bucket_policy());
+    std::vector<fs::DependentTmpFile> shards;
+    for (size_t i = 0; i < raw_kmers.size(); ++i)
+      shards.push_back(res.create(i));
+    {
+        TIME_TRACE_SCOPE("KMerDiskCounter::CountSharded");
+        utils::RunInWorkerProcesses(raw_kmers.size(), opts.num_workers, opts.worker_memory_limit,
+                                    [&](size_t i) {
+                                      MergeKMers(*raw_kmers[i], *shards[i]);
+                                      process(i, res);
+                                    });
+    }
+    // Raw k-mers were consumed (and unlinked) by the workers
+    raw_kmers.clear();
+
+    size_t kmers = res.total_kmers();
+    INFO("K-mer counting done. There are " << kmers << " kmers in total. ");
+    if (!kmers) {
+      FATAL_ERROR("No kmers were extracted from reads. Check the read lengths and k-mer length settings");
+      exit(-1);
+    }
+
+    return res;
+  }
+
+  fs::TmpDir work_dir() const { return work_dir_; }
+
 private:
   std::unique_ptr<kmers::KMerSplitter<Seq>> splitter_;
   fs::TmpDir work_dir_;
@@ -447,6 +499,69 @@ class KMerIndexBuilder {
     index.count_size();
   }
 
+  // Every k-mer hash shard is counted and gets its perfect hash built in a
+  // worker process, the latter is stored in the shard file on a local disk.
+  // Shards are then stitched together as index segments, so the lookup picks
+  // the shard via the usual segment policy.
+  template<class Counter>
+  auto BuildIndexSharded(Index &index, Counter &counter, const ShardingOptions &opts,
+                         bool save_final = false) {
+    TIME_TRACE_SCOPE("KMerIndexBuilder::BuildIndexSharded");
+    typedef typename Index::KMerDataIndex KMerDataIndex;
+
+    INFO("Building kmer index using " << num_buckets_ << " shards");
+    auto shard_dir = fs::tmp::make_temp_dir(opts.local_dir.empty() ? counter.work_dir()->dir() : opts.local_dir,
+                                            "kmer_shards");
+    std::vector<std::filesystem::path> shard_files;
+    for (unsigned i = 0; i < num_buckets_; ++i)
+      shard_files.push_back(shard_dir->dir() / ("shard_" + std::to_string(i) + ".mph"));
+
+    auto kmer_storage = counter.CountSharded(num_buckets_, num_threads_, opts,
+                                             [&](size_t i, const KMerDiskStorage<Seq> &storage) {
+                                               // Single-range build is sequential and free of OpenMP, as the
+                                               // worker processes require.
+                                               // Use of gamma = 4 implies ~5.7 bits per k-mer, however, faster construction and lookup
+                                               KMerDataIndex shard(storage.bucket_size(i), KMerDataIndex::ConflictPolicy::Ignore, /* gamma */ 4.0);
+                                               shard.build(boomphf::range(storage.bucket_begin(i), storage.bucket_end(i)));
+                                               std::ofstream os(shard_files[i], std::ios::binary);
+                                               shard.save(os);
+                                               os.close();
+                                               VERIFY_MSG(!os.fail(), "Cannot write shard index " << shard_files[i]);
+                                             });
+
+    index.clear();
+    auto segment_policy = kmer_storage.segment_policy();
+    size_t segments = segment_policy.num_segments();
+    VERIFY(segments == num_buckets_ && segments == kmer_storage.num_buckets());
+    index.segment_starts_.resize(segments + 1, 0);
+    index.segment_policy_ = segment_policy;
+    index.num_segments_ = segments;
+    index.index_.resize(segments);
+
+    INFO("Loading shard indices");
+#   pragma omp parallel for shared(index) num_threads(num_threads_)
+    for (size_t i = 0; i < segments; ++i) {
+        std::ifstream is(shard_files[i], std::ios::binary);
+        index.index_[i].load(is);
+        VERIFY_MSG(!is.fail(), "Cannot read shard index " << shard_files[i]);
+        index.segment_starts_[i + 1] = kmer_storage.bucket_size(i);
+        std::filesystem::remove(shard_files[i]);
+    }
+
+    // Finally, record the sizes of buckets.
+    for (unsigned i = 1; i < segments; ++i)
+      index.segment_starts_[i] += index.segment_starts_[i - 1];
+
+    double bits_per_kmer = 8.0 * (double)index.mem_size() / (double)kmer_storage.total_kmers();
+    INFO("Index built. Total " << kmer_storage.total_kmers() << " kmers, " << index.mem_size() << " bytes occupied (" << bits_per_kmer << " bits per kmer).");
+    index.count_size();
+
+    if (save_final)
+      kmer_storage.merge();
+
+    return kmer_storage;
+  }
+
   auto BuildIndex(Index &index, KMerCounter<Seq> &counter, bool save_final = false) {
     TIME_TRACE_SCOPE("KMerIndexBuilder::BuildIndex(counter)");
 
@@ -8,26 +8,12 @@
 #include "gap_analyzer.hpp"
 #include "overlap_analysis.hpp"
 
+#include "sequence/suffix_prefix_hamming.hpp"
+
 namespace path_extend {
 
 using namespace debruijn_graph;
 
-static size_t HammingDistance(const Sequence& s1, const Sequence& s2) {
-    VERIFY(s1.size() == s2.size());
-    size_t dist = 0;
-    for (size_t i = 0; i < s1.size(); ++i) {
-        if (s1[i] != s2[i]) {
-            dist++;
-        }
-    }
-    return dist;
-}
-
-double HammingGapAnalyzer::ScoreGap(const Sequence& s1, const Sequence& s2) const {
-    VERIFY(s1.size() == s2.size());
-    return 1.0 - (double) HammingDistance(s1, s2) / (double) s1.size();
-}
-
 GapDescription HammingGapAnalyzer::FixGap(const GapDescription &gap) const {
     VERIFY_MSG(gap.no_trim(), "Trims not supported yet");
 
@@ -50,12 +36,12 @@ GapDescription HammingGapAnalyzer::FixGap(const GapDescription &gap) const {
     //todo better usage of estimated overlap
     DEBUG("Min overlap " << min_overlap);
 
+    // Distances for all the overlaps are computed on the packed ends
+    SuffixPrefixHamming hamming(g_.EdgeNucls(gap.left()), g_.EdgeNucls(gap.right()), max_overlap);
     for (size_t l = max_overlap; l >= min_overlap; --l) {
         //TRACE("Sink: " << g_.EdgeNucls(sink).Subseq(g_.length(sink) + g_.k() - l).str());
         //TRACE("Source: " << g_.EdgeNucls(source).Subseq(0, l));
-        double score = 0;
-        score = ScoreGap(g_.EdgeNucls(gap.left()).Subseq(g_.length(gap.left()) + g_.k() - l),
-                         g_.EdgeNucls(gap.right()).Subseq(0, l));
+        double score = 1.0 - (double) hamming.Distance(l) / (double) l;
         if (math::gr(score, best_score)) {
             TRACE("Curr overlap " << l);
             TRACE("Score: " << score);
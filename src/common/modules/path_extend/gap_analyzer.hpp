@@ -34,8 +34,6 @@ class HammingGapAnalyzer: public GapAnalyzer {
 
     static constexpr double MIN_OVERLAP_COEFF = 0.05;
 
-    double ScoreGap(const Sequence& s1, const Sequence& s2) const;
-
 public:
     //todo review parameters in usages
     HammingGapAnalyzer(const debruijn_graph::Graph& g,
@@ -69,6 +69,16 @@ public:
         height_2_vertices_.emplace(0, start_vertex);
     }
 
+    //restores previously found component from its vertex depths
+    LocalizedComponent(const Graph& g, VertexId start_vertex,
+                       const std::map<VertexId, Range> &vertex_depth) :
+            LocalizedComponent(g, start_vertex) {
+        for (const auto &v_depth : vertex_depth) {
+            if (v_depth.first != start_vertex)
+                AddVertex(v_depth.first, v_depth.second);
+        }
+    }
+
     const Graph& g() const {
         return g_;
     }
@@ -179,6 +189,10 @@ public:
         return end_vertices_;
     }
 
+    const std::map<VertexId, Range> &vertex_depth() const {
+        return vertex_depth_;
+    }
+
     bool CheckCloseNeighbour(VertexId v) const {
         DEBUG("Check if vertex " << g_.str(v) << " can be processed");
         for (EdgeId e : g_.IncomingEdges(v)) {
@@ -1214,6 +1228,213 @@ private:
     DECL_LOGGER("ComplexBulgeRemover");
 };
 
+//Everything needed to project the component once the analysis is over
+template<class Graph>
+struct AnalyzedComponent {
+    typedef typename Graph::VertexId VertexId;
+    typedef typename Graph::EdgeId EdgeId;
+
+    VertexId start_vertex;
+    std::map<VertexId, Range> vertex_depth;
+    std::set<EdgeId> tree_edges;
+};
+
+//Analyzes localized components of all candidate vertices concurrently and
+//then projects non-conflicting ones in a deterministic (vertex id) order.
+//Components that conflict with the already projected ones together with
+//the neighbourhood of the modified regions are reconsidered in the next round.
+template<class Graph>
+class ParallelComplexBulgeRemover : public PersistentAlgorithmBase<Graph> {
+    typedef typename Graph::VertexId VertexId;
+    typedef typename Graph::EdgeId EdgeId;
+    typedef PersistentAlgorithmBase<Graph> base;
+    typedef SmartEdgeSet<std::unordered_set<EdgeId>, Graph> RestrictedEdgeSet;
+
+    size_t max_length_;
+    size_t length_diff_;
+    const RestrictedEdgeSet *protected_edges_ = nullptr;
+    size_t chunk_cnt_;
+
+    bool IsProtected(const std::set<EdgeId> &tree_edges) const {
+        if (!protected_edges_)
+            return false;
+        for (EdgeId e : tree_edges) {
+            if (protected_edges_->count(e) > 0)
+                return true;
+        }
+        return false;
+    }
+
+    //does not modify the graph, so might be called concurrently
+    //skip is the number of suitable components (smallest first) to pass over
+    std::optional<AnalyzedComponent<Graph>> Analyze(VertexId v, size_t skip = 0) const {
+        LocalizedComponentFinder<Graph> comp_finder(this->g(), max_length_,
+                                                    length_diff_, v);
+        while (comp_finder.ProceedFurther()) {
+            const LocalizedComponent<Graph> &component = comp_finder.component();
+            ComponentColoring<Graph> coloring(component);
+            SkeletonTreeFinder<Graph> tree_finder(component, coloring);
+            if (!tree_finder.FindTree())
+                continue;
+
+            std::set<EdgeId> tree_edges = tree_finder.GetTreeEdges();
+            if (IsProtected(tree_edges)) {
+                DEBUG("Trying to project a-domain edges");
+                continue;
+            }
+
+            if (skip > 0) {
+                skip -= 1;
+                continue;
+            }
+
+            return AnalyzedComponent<Graph>{v, component.vertex_depth(), std::move(tree_edges)};
+        }
+        return std::nullopt;
+    }
+
+    //Projection touches the component vertices (and their conjugates) as well
+    //as the edges incident to them, so the closed neighbourhood is claimed
+    bool IsClaimed(const AnalyzedComponent<Graph> &comp,
+                   const std::unordered_set<VertexId> &claimed) const {
+        for (VertexId v : utils::key_set(comp.vertex_depth)) {
+            if (claimed.count(v) || claimed.count(this->g().conjugate(v)))
+                return true;
+        }
+        return false;
+    }
+
+    void Claim(const AnalyzedComponent<Graph> &comp,
+               std::unordered_set<VertexId> &claimed) const {
+        for (VertexId v : utils::key_set(comp.vertex_depth)) {
+            for (VertexId n : Neighbours(v)) {
+                claimed.insert(n);
+                claimed.insert(this->g().conjugate(n));
+            }
+        }
+    }
+
+    bool Project(const AnalyzedComponent<Graph> &comp,
+                 std::vector<VertexId> &vertices_to_post_process) {
+        LocalizedComponent<Graph> component(this->g(), comp.start_vertex, comp.vertex_depth);
+        ComponentColoring<Graph> coloring(component);
+        SkeletonTree<Graph> tree(component, comp.tree_edges);
+        SmartSetIterator<Graph, VertexId> added_vertices(this->g(), true);
+        ComponentProjector<Graph> projector(this->g(), component, coloring, tree);
+        if (!projector.ProjectComponent()) {
+            DEBUG("Component can't be projected");
+            //reverting changes resulting from failed split
+            Compressor<Graph> compressor(this->g());
+            for (; !added_vertices.IsEnd(); ++added_vertices) {
+                compressor.CompressVertex(*added_vertices);
+            }
+            return false;
+        }
+        DEBUG("Successfully processed component start_v " << this->g().str(component.start_vertex()));
+        GraphComponent<Graph> gc = component.AsGraphComponent();
+        std::copy(gc.v_begin(), gc.v_end(), std::back_inserter(vertices_to_post_process));
+        return true;
+    }
+
+    //Projects the component or, same as ComplexBulgeRemover does, the next
+    //larger suitable one if the projection fails. Returns false if the start
+    //vertex has to be reconsidered in the next round.
+    bool Commit(AnalyzedComponent<Graph> comp,
+                std::unordered_set<VertexId> &claimed,
+                std::vector<VertexId> &vertices_to_post_process) {
+        for (size_t attempt = 1; ; ++attempt) {
+            if (IsClaimed(comp, claimed)) {
+                DEBUG("Component of " << this->g().str(comp.start_vertex) << " conflicts with projected ones");
+                return false;
+            }
+            Claim(comp, claimed);
+
+            if (Project(comp, vertices_to_post_process))
+                return true;
+
+            auto larger = Analyze(comp.start_vertex, attempt);
+            if (!larger)
+                return true;
+            comp = std::move(*larger);
+        }
+    }
+
+    //todo shrink this set if needed
+    std::set<VertexId> Neighbours(VertexId v) const {
+        std::set<VertexId> answer;
+        for (EdgeId e : this->g().IncidentEdges(v)) {
+            answer.insert(this->g().EdgeStart(e));
+            answer.insert(this->g().EdgeEnd(e));
+        }
+        answer.insert(v);
+        return answer;
+    }
+
+    size_t ProcessRound(const std::vector<VertexId> &candidates,
+                        SmartSetIterator<Graph, VertexId> &next_round) {
+        std::vector<std::optional<AnalyzedComponent<Graph>>> analyzed(candidates.size());
+        DEBUG("Analyzing " << candidates.size() << " candidates");
+        size_t chunk_size = std::max<size_t>(1, (candidates.size() + chunk_cnt_ - 1) / chunk_cnt_);
+        #pragma omp parallel for schedule(dynamic, chunk_size)
+        for (size_t i = 0; i < candidates.size(); ++i)
+            analyzed[i] = Analyze(candidates[i]);
+
+        size_t triggered = 0;
+        std::unordered_set<VertexId> claimed;
+        for (auto &comp : analyzed) {
+            if (!comp)
+                continue;
+
+            VertexId start = comp->start_vertex;
+            std::vector<VertexId> vertices_to_post_process;
+            if (!Commit(std::move(*comp), claimed, vertices_to_post_process)) {
+                //start vertex might have been removed by the earlier projections
+                if (this->g().contains(start))
+                    next_round.push(start);
+                continue;
+            }
+
+            if (vertices_to_post_process.empty())
+                continue;
+
+            triggered += 1;
+            for (VertexId p_p : vertices_to_post_process) {
+                for (VertexId n : Neighbours(p_p))
+                    next_round.push(n);
+                this->g().CompressVertex(p_p);
+            }
+        }
+        return triggered;
+    }
+
+public:
+    ParallelComplexBulgeRemover(Graph& g, size_t max_length, size_t length_diff,
+                                const RestrictedEdgeSet *protected_edges,
+                                size_t chunk_cnt = 1) :
+            base(g),
+            max_length_(max_length),
+            length_diff_(length_diff),
+            protected_edges_(protected_edges),
+            chunk_cnt_(std::max<size_t>(chunk_cnt, 1)) {}
+
+    size_t Run(bool /*force_primary_launch*/ = false,
+               double /*iter_run_progress*/ = 1.) override {
+        //every launch starts from scratch, same as in ComplexBulgeRemover
+        SmartSetIterator<Graph, VertexId> to_consider(this->g(), this->g().begin(), this->g().end());
+        size_t triggered = 0;
+        while (!to_consider.IsEnd()) {
+            std::vector<VertexId> candidates;
+            for (; !to_consider.IsEnd(); ++to_consider)
+                candidates.push_back(*to_consider);
+            triggered += ProcessRound(candidates, to_consider);
+        }
+        return triggered;
+    }
+
+private:
+    DECL_LOGGER("ParallelComplexBulgeRemover");
+};
+
 }
 
 }
@@ -0,0 +1,545 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "histogram.hpp"
+#include "index_point.hpp"
+
+#include "utils/verify.hpp"
+
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace omnigraph {
+
+namespace de {
+
+/**
+ * @brief Read-only paired index packed into a single byte array.
+ * @detail Built once from a filled index and provides the same Get / GetHalf
+ *         interface. For every first edge its neighbours are sorted by ID and
+ *         stored as ID deltas followed by the points. Distances (delta-coded
+ *         within a histogram), weights and variances are stored as varints
+ *         quantized to 1/QUANT; a value which cannot be restored exactly is
+ *         stored as raw float bits instead, so the compression is lossless.
+ *         Every SKIP_STEP-th neighbour has an absolute ID and an entry in the
+ *         skip table, so a pair lookup decodes at most SKIP_STEP records.
+ */
+template<typename G, typename Traits>
+class CompressedPairedIndex {
+    typedef CompressedPairedIndex<G, Traits> self;
+    typedef typename Traits::Gapped InnerPoint;
+
+    static constexpr size_t SKIP_STEP = 16;
+    static constexpr uint32_t QUANT = 16;
+    static constexpr bool HAS_VAR = std::is_same<InnerPoint, GapPoint>::value;
+
+    struct EdgeEntry {
+        uint64_t id;
+        uint64_t offset;     // first neighbour record in data_
+        uint32_t count;      // number of neighbours
+        uint32_t skip;       // first block in skips_
+
+        bool operator<(uint64_t other) const { return id < other; }
+    };
+
+    struct SkipEntry {
+        uint64_t id;
+        uint64_t offset;
+
+        bool operator<(uint64_t other) const { return id < other; }
+    };
+
+    struct Record {
+        uint64_t id;
+        size_t npoints;
+        const uint8_t *points;
+    };
+
+public:
+    typedef G Graph;
+    typedef typename Graph::EdgeId EdgeId;
+    typedef std::pair<EdgeId, EdgeId> EdgePair;
+    typedef typename Traits::Expanded Point;
+    typedef omnigraph::de::Histogram<Point> Histogram;
+
+    /**
+     * @brief Proxy set of points between two edges decoded on-the-fly.
+     */
+    class HistProxy {
+    public:
+        class Iterator: public boost::iterator_facade<Iterator, Point, boost::forward_traversal_tag, Point> {
+        public:
+            Iterator(const uint8_t *data, size_t left, DEDistance offset)
+                    : data_(data), left_(left), offset_(offset), prev_d_(0) {
+                if (left_)
+                    Decode();
+            }
+
+        private:
+            friend class boost::iterator_core_access;
+
+            void Decode() {
+                InnerPoint p;
+                p.d = GetValue(data_, prev_d_);
+                int64_t zero = 0;
+                p.weight = GetValue(data_, zero);
+                if constexpr (HAS_VAR) {
+                    zero = 0;
+                    p.var = GetValue(data_, zero);
+                }
+                point_ = Traits::Expand(p, offset_);
+            }
+
+            Point dereference() const {
+                return point_;
+            }
+
+            void increment() {
+                if (--left_)
+                    Decode();
+            }
+
+            bool equal(const Iterator &other) const {
+                return left_ == other.left_;
+            }
+
+            const uint8_t *data_;
+            size_t left_;
+            DEDistance offset_;
+            int64_t prev_d_;
+            Point point_;
+        };
+
+        HistProxy(const uint8_t *data = nullptr, size_t size = 0, DEDistance offset = 0)
+                : data_(data), size_(size), offset_(offset) {}
+
+        Iterator begin() const {
+            return Iterator(data_, size_, offset_);
+        }
+
+        Iterator end() const {
+            return Iterator(nullptr, 0, offset_);
+        }
+
+        /**
+         * @brief Finds the point with the minimal distance.
+         */
+        Point min() const {
+            VERIFY(!empty());
+            return *begin();
+        }
+
+        /**
+         * @brief Finds the point with the maximal distance.
+         */
+        Point max() const {
+            VERIFY(!empty());
+            Point res;
+            for (const auto &p : *this)
+                res = p;
+            return res;
+        }
+
+        /**
+         * @brief Returns the copy of all points in a simple flat histogram.
+         */
+        Histogram Unwrap() const {
+            return Histogram(begin(), end());
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        bool empty() const {
+            return size_ == 0;
+        }
+
+    private:
+        const uint8_t *data_;
+        size_t size_;
+        DEDistance offset_;
+    };
+
+    typedef typename HistProxy::Iterator HistIterator;
+
+    using EdgeHist = std::pair<EdgeId, HistProxy>;
+
+    /**
+     * @brief Proxy map of the neighbourhood of an edge, see PairedIndex::EdgeProxy.
+     */
+    class EdgeProxy {
+    public:
+        class Iterator: public boost::iterator_facade<Iterator, EdgeHist, boost::forward_traversal_tag, EdgeHist> {
+            void Next() {
+                for (; idx_ < count_; ++idx_) {
+                    ReadRecord(data_, idx_, record_.id, record_);
+                    if (!half_ || index_.IsCanonical(edge_, EdgeId(record_.id)))
+                        return;
+                }
+            }
+
+        public:
+            Iterator(const CompressedPairedIndex &index, const uint8_t *data,
+                     size_t idx, size_t count, EdgeId edge, bool half)
+                    : index_(index), data_(data), idx_(idx), count_(count),
+                      edge_(edge), half_(half), record_{0, 0, nullptr} {
+                Next();
+            }
+
+        private:
+            friend class boost::iterator_core_access;
+
+            void increment() {
+                ++idx_;
+                Next();
+            }
+
+            bool equal(const Iterator &other) const {
+                return idx_ == other.idx_;
+            }
+
+            EdgeHist dereference() const {
+                return std::make_pair(EdgeId(record_.id),
+                                      HistProxy(record_.points, record_.npoints, index_.CalcOffset(edge_)));
+            }
+
+            const CompressedPairedIndex &index_;
+            const uint8_t *data_;
+            size_t idx_, count_;
+            EdgeId edge_;
+            bool half_;
+            Record record_;
+        };
+
+        EdgeProxy(const CompressedPairedIndex &index, const EdgeEntry *entry, EdgeId edge, bool half = false)
+                : index_(index), entry_(entry), edge_(edge), half_(half) {}
+
+        Iterator begin() const {
+            return Iterator(index_, data(), 0, size(), edge_, half_);
+        }
+
+        Iterator end() const {
+            return Iterator(index_, data(), size(), size(), edge_, half_);
+        }
+
+        HistProxy operator[](EdgeId e2) const {
+            if (half_ && !index_.IsCanonical(edge_, e2))
+                return HistProxy();
+            return index_.Get(edge_, e2);
+        }
+
+        bool empty() const {
+            return size() == 0;
+        }
+
+    private:
+        size_t size() const {
+            return entry_ ? entry_->count : 0;
+        }
+
+        const uint8_t *data() const {
+            return entry_ ? index_.data_.data() + entry_->offset : nullptr;
+        }
+
+        const CompressedPairedIndex &index_;
+        const EdgeEntry *entry_;
+        EdgeId edge_;
+        bool half_;
+    };
+
+    typedef typename EdgeProxy::Iterator EdgeIterator;
+
+    /**
+     * @brief Packs the contents of a filled index, which may be dropped afterwards.
+     */
+    template<class Index>
+    explicit CompressedPairedIndex(const Index &index)
+            : graph_(index.graph()), size_(index.size()) {
+        typedef typename std::decay<decltype(*index.data_begin()->second.begin()->second)>::type InnerHistogram;
+        std::vector<std::pair<uint64_t, const InnerHistogram*>> neighbours;
+        std::vector<uint8_t> points;
+        for (auto i = index.data_begin(); i != index.data_end(); ++i) {
+            neighbours.clear();
+            for (const auto &j : i->second)
+                neighbours.emplace_back(graph_.int_id(j.first), &*j.second);
+            if (neighbours.empty())
+                continue;
+            std::sort(neighbours.begin(), neighbours.end());
+
+            edges_.push_back({uint64_t(graph_.int_id(i->first)), data_.size(),
+                              uint32_t(neighbours.size()), uint32_t(skips_.size())});
+            uint64_t prev = 0;
+            for (size_t k = 0; k < neighbours.size(); ++k) {
+                uint64_t id = neighbours[k].first;
+                if (k % SKIP_STEP == 0) {
+                    skips_.push_back({id, data_.size()});
+                    prev = 0;
+                }
+                PutVarint(data_, id - prev);
+                prev = id;
+
+                const auto &hist = *neighbours[k].second;
+                PutVarint(data_, hist.size());
+                points.clear();
+                int64_t prev_d = 0;
+                for (const auto &p : hist) {
+                    int64_t zero = 0;
+                    PutValue(points, p.d, prev_d);
+                    PutValue(points, p.weight, zero);
+                    if constexpr (HAS_VAR) {
+                        zero = 0;
+                        PutValue(points, p.var, zero);
+                    }
+                }
+                PutVarint(data_, points.size());
+                data_.insert(data_.end(), points.begin(), points.end());
+            }
+        }
+        std::sort(edges_.begin(), edges_.end(),
+                  [](const EdgeEntry &a, const EdgeEntry &b) { return a.id < b.id; });
+
+        data_.shrink_to_fit();
+        edges_.shrink_to_fit();
+        skips_.shrink_to_fit();
+    }
+
+    /**
+     * @brief Returns a whole proxy map to the neighbourhood of some edge.
+     */
+    EdgeProxy Get(EdgeId e) const {
+        return EdgeProxy(*this, FindEdge(e), e);
+    }
+
+    /**
+     * @brief Returns a half proxy map to the neighbourhood of some edge.
+     */
+    EdgeProxy GetHalf(EdgeId e) const {
+        return EdgeProxy(*this, FindEdge(e), e, true);
+    }
+
+    EdgeProxy operator[](EdgeId e) const {
+        return Get(e);
+    }
+
+    /**
+     * @brief Returns a histogram proxy for all points between two edges.
+     */
+    HistProxy Get(EdgeId e1, EdgeId e2) const {
+        Record r;
+        if (!FindPair(e1, e2, r))
+            return HistProxy();
+        return HistProxy(r.points, r.npoints, CalcOffset(e1));
+    }
+
+    HistProxy operator[](EdgePair p) const {
+        return Get(p.first, p.second);
+    }
+
+    /**
+     * @brief Checks if an edge (or its conjugated twin) is consisted in the index.
+     */
+    bool contains(EdgeId edge) const {
+        return FindEdge(edge) || FindEdge(graph_.conjugate(edge));
+    }
+
+    /**
+     * @brief Checks if there is a histogram for two edges.
+     */
+    bool contains(EdgeId e1, EdgeId e2) const {
+        Record r;
+        return FindPair(e1, e2, r);
+    }
+
+    /**
+     * @brief Returns the total number of points, the same as of the source index.
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * @brief Returns the number of bytes occupied by the index.
+     */
+    size_t mem_size() const {
+        return data_.capacity() +
+                edges_.capacity() * sizeof(EdgeEntry) +
+                skips_.capacity() * sizeof(SkipEntry);
+    }
+
+    /**
+     * @brief Checks that the index holds exactly the points of the given one.
+     */
+    template<class Index>
+    bool Matches(const Index &index) const {
+        if (index.size() != size_)
+            return false;
+
+        size_t pairs = 0;
+        for (auto i = index.data_begin(); i != index.data_end(); ++i) {
+            for (const auto &j : i->second) {
+                pairs += 1;
+                auto hist = index.Get(i->first, j.first);
+                auto chist = Get(i->first, j.first);
+                if (hist.size() != chist.size())
+                    return false;
+                auto ci = chist.begin();
+                for (auto p : hist) {
+                    auto cp = *ci;
+                    ++ci;
+                    if (p.d != cp.d || p.weight != cp.weight || p.variance() != cp.variance())
+                        return false;
+                }
+            }
+        }
+
+        size_t compressed_pairs = 0;
+        for (const auto &entry : edges_)
+            compressed_pairs += entry.count;
+        return pairs == compressed_pairs;
+    }
+
+    const Graph &graph() const { return graph_; }
+
+    EdgePair ConjugatePair(EdgeId e1, EdgeId e2) const {
+        return std::make_pair(graph_.conjugate(e2), graph_.conjugate(e1));
+    }
+
+    /**
+     * @brief Checks if an edge pair is canonical (less than its conjugate).
+     */
+    bool IsCanonical(EdgeId e1, EdgeId e2) const {
+        auto ep = std::make_pair(e1, e2);
+        return ep <= ConjugatePair(e1, e2);
+    }
+
+private:
+    DEDistance CalcOffset(EdgeId e) const {
+        return DEDistance(graph_.length(e));
+    }
+
+    const EdgeEntry *FindEdge(EdgeId e) const {
+        uint64_t id = graph_.int_id(e);
+        auto it = std::lower_bound(edges_.begin(), edges_.end(), id);
+        if (it == edges_.end() || it->id != id)
+            return nullptr;
+        return &*it;
+    }
+
+    bool FindPair(EdgeId e1, EdgeId e2, Record &r) const {
+        const EdgeEntry *entry = FindEdge(e1);
+        if (!entry)
+            return false;
+
+        uint64_t id = graph_.int_id(e2);
+        auto first = skips_.begin() + entry->skip;
+        auto last = first + (entry->count + SKIP_STEP - 1) / SKIP_STEP;
+        auto block = std::upper_bound(first, last, id,
+                                      [](uint64_t x, const SkipEntry &s) { return x < s.id; });
+        if (block == first)
+            return false;
+        --block;
+
+        size_t idx = (block - first) * SKIP_STEP;
+        size_t stop = std::min<size_t>(idx + SKIP_STEP, entry->count);
+        const uint8_t *data = data_.data() + block->offset;
+        r.id = 0;
+        for (; idx < stop; ++idx) {
+            ReadRecord(data, idx, r.id, r);
+            if (r.id >= id)
+                return r.id == id;
+        }
+        return false;
+    }
+
+    // Decodes the neighbour record at data and moves data past it
+    static void ReadRecord(const uint8_t *&data, size_t idx, uint64_t prev, Record &r) {
+        uint64_t delta = GetVarint(data);
+        r.id = (idx % SKIP_STEP == 0 ? delta : prev + delta);
+        r.npoints = GetVarint(data);
+        size_t bytes = GetVarint(data);
+        r.points = data;
+        data += bytes;
+    }
+
+    static void PutVarint(std::vector<uint8_t> &out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(uint8_t(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(uint8_t(v));
+    }
+
+    static uint64_t GetVarint(const uint8_t *&data) {
+        uint64_t v = 0;
+        for (unsigned shift = 0; ; shift += 7) {
+            uint8_t byte = *data++;
+            v |= uint64_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return v;
+        }
+    }
+
+    static float Dequantize(int64_t q) {
+        return float(double(q) / QUANT);
+    }
+
+    // The lowest bit of the varint tells a quantized delta from raw float bits
+    static void PutValue(std::vector<uint8_t> &out, float v, int64_t &prev) {
+        if (std::fabs(v) < float(1 << 30)) {
+            int64_t q = std::llround(double(v) * QUANT);
+            float restored = Dequantize(q);
+            if (std::memcmp(&restored, &v, sizeof(float)) == 0) {
+                int64_t delta = q - prev;
+                PutVarint(out, (uint64_t(delta) << 1 ^ uint64_t(delta >> 63)) << 1);
+                prev = q;
+                return;
+            }
+        }
+
+        PutVarint(out, 1);
+        uint8_t bytes[sizeof(float)];
+        std::memcpy(bytes, &v, sizeof(float));
+        out.insert(out.end(), bytes, bytes + sizeof(float));
+    }
+
+    static float GetValue(const uint8_t *&data, int64_t &prev) {
+        uint64_t v = GetVarint(data);
+        if (v & 1) {
+            float res;
+            std::memcpy(&res, data, sizeof(float));
+            data += sizeof(float);
+            return res;
+        }
+
+        v >>= 1;
+        prev += int64_t(v >> 1) ^ -int64_t(v & 1);
+        return Dequantize(prev);
+    }
+
+    const Graph &graph_;
+    size_t size_;
+    std::vector<uint8_t> data_;
+    std::vector<EdgeEntry> edges_;
+    std::vector<SkipEntry> skips_;
+};
+
+template<class Graph>
+using CompressedPairedInfoIndexT = CompressedPairedIndex<Graph, PointTraits>;
+
+template<class Graph>
+using CompressedUnclusteredPairedInfoIndexT = CompressedPairedIndex<Graph, RawPointTraits>;
+
+}
+
+}
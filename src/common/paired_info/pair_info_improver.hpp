@@ -13,7 +13,7 @@
 #include "paired_info/paired_info.hpp"
 #include "split_path_constructor.hpp"
 #include "paired_info/paired_info_helpers.hpp"
-#include "assembly_graph/paths/path_utils.hpp"
+#include "assembly_graph/paths/path_length_oracle.hpp"
 #include "assembly_graph/core/graph_iterators.hpp"
 #include <math.h>
 
@@ -56,6 +56,7 @@ class PairInfoImprover {
     typedef std::pair<EdgeId, EdgeId> EdgePair;
     typedef omnigraph::de::PairedInfoIndexT<Graph> Index;
     typedef omnigraph::de::ConcurrentClusteredPairedInfoBuffer<Graph> Buffer;
+    typedef omnigraph::PathLengthOracle<Graph> Oracle;
 
   public:
     PairInfoImprover(const Graph& g,
@@ -80,7 +81,8 @@ class PairInfoImprover {
     }
 
     bool IsConsistent(EdgeId /*e*/, EdgeId e1, EdgeId e2,
-                      const omnigraph::de::Point& p1, const omnigraph::de::Point& p2) const {
+                      const omnigraph::de::Point& p1, const omnigraph::de::Point& p2,
+                      Oracle &oracle) const {
         if (math::le(p1.d, 0.f) || math::le(p2.d, 0.f) || math::gr(p1.d, p2.d))
             return true;
 
@@ -96,14 +98,12 @@ class PairInfoImprover {
             if (graph_.EdgeEnd(e1) == graph_.EdgeStart(e2))
                 return true;
 
-            auto paths = GetAllPathsBetweenEdges(graph_, e1, e2, 0, (size_t) ceil(pi_dist - first_length + var));
-            return (paths.size() > 0);
+            return oracle.HasPath(e1, e2, 0, (size_t) ceil(pi_dist - first_length + var));
         } else {
             if (math::gr(p2.d, p1.d + omnigraph::de::DEDistance(first_length))) {
-                auto paths = GetAllPathsBetweenEdges(graph_, e1, e2,
-                                                     (size_t) floor(pi_dist - first_length - var),
-                                                     (size_t)  ceil(pi_dist - first_length + var));
-                return (paths.size() > 0);
+                return oracle.HasPath(e1, e2,
+                                      (size_t) floor(pi_dist - first_length - var),
+                                      (size_t)  ceil(pi_dist - first_length + var));
             }
             return false;
         }
@@ -112,7 +112,7 @@ class PairInfoImprover {
     }
 
     // Checking the consistency of two edge pairs (e, e_1) and (e, e_2) for all pairs (base_edge, <some_edge>)
-    void FindInconsistent(EdgeId base_edge, Buffer& to_remove) const {
+    void FindInconsistent(EdgeId base_edge, Buffer& to_remove, Oracle &oracle) const {
         for (auto i1 : index_.Get(base_edge)) {
             auto e1 = i1.first;
             for (auto i2 : index_.Get(base_edge)) {
@@ -122,7 +122,7 @@ class PairInfoImprover {
 
                 for (auto p1 : i1.second) {
                     for (auto p2 : i2.second) {
-                        if (IsConsistent(base_edge, e1, e2, p1, p2))
+                        if (IsConsistent(base_edge, e1, e2, p1, p2, oracle))
                             continue;
 
                         to_remove.Add(base_edge, e1, p1.lt(p2) ? p1 : p2);
@@ -138,13 +138,16 @@ class PairInfoImprover {
         omnigraph::IterationHelper<Graph, EdgeId> edges(graph_);
         auto ranges = edges.Ranges(nthreads * 16);
 
+        // Path length queries for the same edge pairs are repeated across the base edges
+        std::vector<Oracle> oracles(nthreads, Oracle(graph_));
+
         #pragma omp parallel for schedule(guided) num_threads(nthreads)
         for (size_t i = 0; i < ranges.size(); ++i) {
             for (EdgeId e : ranges[i]) {
                 if (graph_.length(e) < max_repeat_length_ || !index_.contains(e))
                     continue;
 
-                FindInconsistent(e, buf);
+                FindInconsistent(e, buf, oracles[omp_get_thread_num()]);
             }
         }
 
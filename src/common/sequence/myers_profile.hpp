@@ -0,0 +1,233 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "nucl.hpp"
+#include "sequence.hpp"
+
+#include "utils/verify.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+/*
+ * Myers' bit-vector profile of a nucleotide pattern. The profile is built once
+ * and then the pattern is aligned against any number of texts. Text is anything
+ * indexable returning nucleotide codes (0..3), so both raw code arrays and
+ * packed Sequences are scanned directly without conversion to strings.
+ *
+ * Alignment is semi-global: the whole pattern is aligned against a prefix of
+ * the text (EDLIB_MODE_SHW). Only the band of cells with score <= max_score is
+ * computed, scores above max_score are never reported.
+ */
+class MyersProfile {
+    typedef uint64_t Word;
+    static constexpr size_t WORD_SIZE = 64;
+
+public:
+    MyersProfile()
+            : size_(0), blocks_(0) {}
+
+    // Codes outside 0..3 never match anything
+    MyersProfile(const uint8_t *codes, size_t size) {
+        Init(size);
+        for (size_t i = 0; i < size; ++i)
+            if (codes[i] < 4)
+                Set(codes[i], i);
+    }
+
+    explicit MyersProfile(const std::string &s) {
+        Init(s.size());
+        for (size_t i = 0; i < s.size(); ++i)
+            if (is_nucl(s[i]))
+                Set(dignucl(s[i]), i);
+    }
+
+    explicit MyersProfile(const Sequence &s) {
+        Init(s.size());
+        for (size_t i = 0; i < s.size(); ++i)
+            Set(s[i], i);
+    }
+
+    // Profile of the pattern substring [from, from + size), derived from
+    // the profile of the whole pattern with word shifts
+    MyersProfile(const MyersProfile &p, size_t from, size_t size) {
+        VERIFY(from + size <= p.size_);
+        Init(size);
+        for (size_t c = 0; c < 4; ++c) {
+            const Word *src = p.peq_.data() + c * p.blocks_;
+            Word *dst = peq_.data() + c * blocks_;
+            for (size_t b = 0; b < blocks_; ++b) {
+                size_t pos = from + b * WORD_SIZE, i = pos / WORD_SIZE, s = pos % WORD_SIZE;
+                Word w = src[i] >> s;
+                if (s && i + 1 < p.blocks_)
+                    w |= src[i + 1] << (WORD_SIZE - s);
+                dst[b] = w;
+            }
+            if (size % WORD_SIZE)
+                dst[blocks_ - 1] &= (Word(1) << (size % WORD_SIZE)) - 1;
+        }
+    }
+
+    size_t size() const { return size_; }
+
+    // Calls report(pos, score) for every text position pos such that the best
+    // alignment of the pattern ending exactly at pos has score <= max_score,
+    // in increasing order of pos. report returns the new (not larger) bound.
+    template<class Text, class Report>
+    void Align(const Text &text, size_t n, int max_score, Report report) const {
+        VERIFY(size_ > 0);
+        int k = max_score;
+        if (k < 0 || (size_t) k > size_ + n)
+            k = int(size_ + n);
+        // At least size - n pattern characters are left unaligned
+        if (size_ > n + (size_t) k)
+            return;
+
+        std::vector<Word> P(blocks_), M(blocks_);
+        std::vector<int> score(blocks_);
+        // Rows below the band have score > k. The first band is exact: every
+        // row is reachable by deletions only
+        size_t first = 0, last = std::min(blocks_ - 1, (size_t) k / WORD_SIZE);
+        for (size_t b = 0; b <= last; ++b) {
+            P[b] = ~Word(0);
+            M[b] = 0;
+            score[b] = int((b + 1) * WORD_SIZE);
+        }
+
+        // Mask of padding rows below the pattern end in the last block
+        Word pad = size_ % WORD_SIZE ? ~Word(0) << (size_ % WORD_SIZE) : 0;
+        for (size_t j = 0; j < n; ++j) {
+            // Rows entering the band are certainly > k in the previous column, so
+            // any upper estimate of their score is fine
+            size_t need = std::min(blocks_ - 1, (j + (size_t) k) / WORD_SIZE);
+            while (last < need) {
+                ++last;
+                P[last] = ~Word(0);
+                M[last] = 0;
+                score[last] = score[last - 1] + int(WORD_SIZE);
+            }
+
+            unsigned c = (unsigned) text[j];
+            const Word *eq = c < 4 ? peq_.data() + c * blocks_ : nullptr;
+            // Rows above the band grow by one every column (gaps before the
+            // pattern are penalized)
+            int h = 1;
+            for (size_t b = first; b <= last; ++b) {
+                h = Advance(P[b], M[b], eq ? eq[b] : 0, h);
+                score[b] += h;
+            }
+
+            if (last == blocks_ - 1) {
+                int s = score[last] - __builtin_popcountll(P[last] & pad) + __builtin_popcountll(M[last] & pad);
+                if (s <= k)
+                    k = report(j, s);
+            }
+
+            // Once the top row is above k, leading blocks entirely above k stay
+            // so forever and could be dropped
+            if (j + 1 > (size_t) k) {
+                while (first <= last && score[first] - __builtin_popcountll(P[first]) > k)
+                    ++first;
+                if (first > last)
+                    break;
+            }
+        }
+    }
+
+    // Every text position with alignment score <= max_score (drop-in for
+    // SHWDistanceExtended with this pattern as a query)
+    template<class Text>
+    void PrefixScores(const Text &text, size_t n, int max_score,
+                      std::vector<int> &positions, std::vector<int> &scores) const {
+        if (size_ == 0) {
+            for (int i = 0; i < std::min(max_score, (int) n); ++i) {
+                positions.push_back(i);
+                scores.push_back(i + 1);
+            }
+            return;
+        }
+        if (n == 0) {
+            if ((int) size_ <= max_score) {
+                positions.push_back(0);
+                scores.push_back((int) size_);
+            }
+            return;
+        }
+
+        Align(text, n, max_score, [&](size_t pos, int score) {
+            positions.push_back((int) pos);
+            scores.push_back(score);
+            return max_score;
+        });
+    }
+
+    // Best alignment score and the leftmost text position it ends at, or
+    // std::numeric_limits<int>::max() if no alignment within max_score exists.
+    // Position -1 stands for the pattern aligned against the empty prefix
+    // (drop-in for SHWDistance with this pattern as the first argument)
+    template<class Text>
+    int BestPrefix(const Text &text, size_t n, int max_score, int &end_pos) const {
+        VERIFY(size_ > 0);
+        VERIFY(n > 0);
+        int best = std::numeric_limits<int>::max();
+        int bound = max_score < 0 ? best : max_score;
+        if ((size_t) bound >= size_) {
+            best = (int) size_;
+            end_pos = -1;
+        }
+
+        Align(text, n, std::min(best, bound), [&](size_t pos, int score) {
+            if (score < best) {
+                best = score;
+                end_pos = (int) pos;
+            }
+            return std::min(best, bound);
+        });
+
+        return best;
+    }
+
+private:
+    void Init(size_t size) {
+        size_ = size;
+        blocks_ = (size + WORD_SIZE - 1) / WORD_SIZE;
+        peq_.assign(4 * blocks_, 0);
+    }
+
+    void Set(unsigned c, size_t i) {
+        peq_[c * blocks_ + i / WORD_SIZE] |= Word(1) << (i % WORD_SIZE);
+    }
+
+    // Single column step over one block (Myers 1999, Hyyrö 2003). h is the
+    // horizontal delta entering the block from above, returns the one leaving
+    // it from the bottom row.
+    static int Advance(Word &Pv, Word &Mv, Word Eq, int h) {
+        Word Xv = Eq | Mv;
+        if (h < 0)
+            Eq |= 1;
+        Word Xh = (((Eq & Pv) + Pv) ^ Pv) | Eq;
+        Word Ph = Mv | ~(Xh | Pv);
+        Word Mh = Pv & Xh;
+        int out = int(Ph >> (WORD_SIZE - 1)) - int(Mh >> (WORD_SIZE - 1));
+        Ph <<= 1;
+        Mh <<= 1;
+        if (h < 0)
+            Mh |= 1;
+        else if (h > 0)
+            Ph |= 1;
+        Pv = Mh | ~(Xv | Ph);
+        Mv = Ph & Xv;
+        return out;
+    }
+
+    size_t size_;
+    size_t blocks_;
+    std::vector<Word> peq_;
+};
@@ -0,0 +1,80 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "sequence.hpp"
+
+#include "utils/verify.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Hamming distances between the suffixes of the left sequence and the
+ * prefixes of the right one, i.e. between left.Last(l) and right.First(l),
+ * for all overlap lengths l up to max_overlap. The ends are packed into 2-bit
+ * words once, so the distance for every overlap costs a few XOR / popcount
+ * operations per 32 nucleotides instead of a comparison per nucleotide.
+ */
+class SuffixPrefixHamming {
+    static constexpr size_t WORD_NUCLS = 32;
+    static constexpr uint64_t LOW_BITS = 0x5555555555555555ull;
+
+    size_t max_overlap_;
+    std::vector<uint64_t> suffix_;
+    std::vector<uint64_t> prefix_;
+
+    static std::vector<uint64_t> Pack(const Sequence &s) {
+        // The extra zero word allows unaligned reads past the last one
+        std::vector<uint64_t> res(s.size() / WORD_NUCLS + 2, 0);
+        for (size_t i = 0; i < s.size(); ++i)
+            res[i / WORD_NUCLS] |= uint64_t(s[i]) << (2 * (i % WORD_NUCLS));
+        return res;
+    }
+
+    // 32 nucleotides of the packed suffix starting from pos
+    uint64_t SuffixWord(size_t pos) const {
+        size_t w = pos / WORD_NUCLS, shift = 2 * (pos % WORD_NUCLS);
+        if (!shift)
+            return suffix_[w];
+        return (suffix_[w] >> shift) | (suffix_[w + 1] << (64 - shift));
+    }
+
+    static size_t Mismatches(uint64_t x) {
+        return __builtin_popcountll((x | (x >> 1)) & LOW_BITS);
+    }
+
+public:
+    SuffixPrefixHamming(const Sequence &left, const Sequence &right, size_t max_overlap)
+            : max_overlap_(max_overlap),
+              suffix_(Pack(left.Last(max_overlap))),
+              prefix_(Pack(right.First(max_overlap))) {}
+
+    size_t max_overlap() const { return max_overlap_; }
+
+    // Hamming distance between left.Last(overlap) and right.First(overlap)
+    size_t Distance(size_t overlap) const {
+        return LimitedDistance(overlap, overlap);
+    }
+
+    // Stops counting (at the word granularity) once the distance exceeds bound
+    size_t LimitedDistance(size_t overlap, size_t bound) const {
+        VERIFY(overlap <= max_overlap_);
+        size_t from = max_overlap_ - overlap;
+        size_t dist = 0;
+        size_t full = overlap / WORD_NUCLS;
+        for (size_t w = 0; w < full && dist <= bound; ++w)
+            dist += Mismatches(SuffixWord(from + w * WORD_NUCLS) ^ prefix_[w]);
+
+        if (size_t rest = overlap % WORD_NUCLS) {
+            uint64_t mask = (uint64_t(1) << (2 * rest)) - 1;
+            dist += Mismatches((SuffixWord(from + full * WORD_NUCLS) ^ prefix_[full]) & mask);
+        }
+
+        return dist;
+    }
+};
@@ -481,6 +481,10 @@ AlgoPtr<Graph> ComplexBRInstance(
         return nullptr;
     size_t max_length = (size_t) ((double) g.k() * cbr_config.max_relative_length);
     size_t max_diff = cbr_config.max_length_difference;
+    if (cbr_config.parallel)
+        return std::make_shared<omnigraph::complex_br::ParallelComplexBulgeRemover<Graph>>(g, max_length, max_diff,
+                                                                                           restricted_edges,
+                                                                                           info.chunk_cnt());
     return std::make_shared<omnigraph::complex_br::ComplexBulgeRemover<Graph>>(g, max_length, max_diff,
                                                                                restricted_edges, info.chunk_cnt());
 }
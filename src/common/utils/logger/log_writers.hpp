@@ -14,7 +14,7 @@
 namespace logging {
 
 struct console_writer : public writer {
-    void write_msg(double time, size_t cmem, size_t max_rss, level l, const std::filesystem::path& file, size_t line_num,
+    void write_msg(double time, size_t cmem, size_t max_rss, level l, const char *file, size_t line_num,
                    const char *source, const char *msg);
 };
 
@@ -22,7 +22,7 @@ class file_writer : public writer {
 public:
     file_writer(const std::string &filename) : fout(filename) {}
 
-    void write_msg(double time, size_t cmem, size_t max_rss, level l, const std::filesystem::path& file, size_t line_num,
+    void write_msg(double time, size_t cmem, size_t max_rss, level l, const char *file, size_t line_num,
                    const char *source, const char *msg);
 
 private:
@@ -35,8 +35,13 @@ class mutex_writer : public writer {
 public:
     mutex_writer(std::shared_ptr<writer> writer) : writer_(writer) {}
 
-    void write_msg(double time, size_t cmem, size_t max_rss, level l, const std::filesystem::path& file, size_t line_num,
+    void write_msg(double time, size_t cmem, size_t max_rss, level l, const char *file, size_t line_num,
                    const char *source, const char *msg);
+
+    void flush() {
+        std::lock_guard<std::mutex> guard(writer_mutex_);
+        writer_->flush();
+    }
 };
 
 } // logging
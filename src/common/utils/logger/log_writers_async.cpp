@@ -0,0 +1,198 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "log_writers_async.hpp"
+
+#include <algorithm>
+
+namespace logging {
+
+namespace {
+std::atomic<uint64_t> async_writer_ids(0);
+
+size_t round_up_pow2(size_t n) {
+    size_t res = 1;
+    while (res < n)
+        res <<= 1;
+    return res;
+}
+}
+
+// Single producer / single consumer ring. A ring belongs to one thread at a
+// time and is handed over to another thread after the owner exits.
+struct async_writer::ring {
+    explicit ring(size_t size)
+            : slots(size), mask(size - 1), in_use(true) {}
+
+    std::vector<record> slots;
+    const size_t mask;
+    std::atomic<bool> in_use;
+    alignas(64) std::atomic<size_t> head{0}; // Advanced by the writer thread
+    alignas(64) std::atomic<size_t> tail{0}; // Advanced by the owning thread
+};
+
+async_writer::async_writer(writer_ptr writer,
+                           size_t ring_size,
+                           std::chrono::milliseconds flush_interval)
+        : writer_(std::move(writer)), ring_size_(round_up_pow2(std::max<size_t>(ring_size, 2))),
+          flush_interval_(flush_interval), id_(async_writer_ids.fetch_add(1)),
+          seq_(0), wake_requested_(false), stop_(false), passes_started_(0), passes_done_(0) {
+    thread_ = std::thread([this] { run(); });
+}
+
+async_writer::~async_writer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_cv_.notify_one();
+    thread_.join();
+}
+
+async_writer::ring &async_writer::local_ring() {
+    // Returns the rings to the owning writers when the thread exits
+    struct local_rings {
+        std::vector<std::pair<uint64_t, std::shared_ptr<ring>>> rings;
+
+        ~local_rings() {
+            for (auto &entry : rings)
+                entry.second->in_use.store(false, std::memory_order_release);
+        }
+    };
+    thread_local local_rings local;
+
+    for (auto &entry : local.rings) {
+        if (entry.first == id_)
+            return *entry.second;
+    }
+
+    std::shared_ptr<ring> r;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        for (auto &candidate : rings_) {
+            bool expected = false;
+            if (candidate->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                r = candidate;
+                break;
+            }
+        }
+
+        if (!r) {
+            r = std::make_shared<ring>(ring_size_);
+            rings_.push_back(r);
+        }
+    }
+
+    local.rings.emplace_back(id_, r);
+    return *r;
+}
+
+void async_writer::wake() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_requested_ = true;
+    }
+    wake_cv_.notify_one();
+}
+
+async_writer::record &async_writer::reserve(ring &r) {
+    size_t tail = r.tail.load(std::memory_order_relaxed);
+    if (tail - r.head.load(std::memory_order_acquire) == r.slots.size()) {
+        // The ring is full: let the writer thread catch up
+        wake();
+        do {
+            std::this_thread::yield();
+        } while (tail - r.head.load(std::memory_order_acquire) == r.slots.size());
+    }
+
+    return r.slots[tail & r.mask];
+}
+
+void async_writer::commit(ring &r, level l) {
+    size_t tail = r.tail.load(std::memory_order_relaxed) + 1;
+    r.tail.store(tail, std::memory_order_release);
+
+    if (l >= L_ERROR)
+        flush();
+    else if (tail - r.head.load(std::memory_order_acquire) > r.slots.size() / 2)
+        wake();
+}
+
+void async_writer::write_msg(double time, size_t cmem, size_t max_rss, level l, const char *file, size_t line_num,
+                             const char *source, const char *msg) {
+    ring &r = local_ring();
+    record &rec = reserve(r);
+    rec = record{seq_.fetch_add(1, std::memory_order_relaxed), time, cmem, max_rss, l, file, line_num, source, msg};
+    commit(r, l);
+}
+
+void async_writer::write_msg_owned(double time, size_t cmem, size_t max_rss, level l, const char *file, size_t line_num,
+                                   const char *source, std::string &&msg) {
+    ring &r = local_ring();
+    record &rec = reserve(r);
+    rec = record{seq_.fetch_add(1, std::memory_order_relaxed), time, cmem, max_rss, l, file, line_num, source, std::move(msg)};
+    commit(r, l);
+}
+
+void async_writer::flush() {
+    // Called from crash handlers as well, the writer thread cannot wait for itself
+    if (std::this_thread::get_id() == thread_.get_id())
+        return;
+
+    // The messages of this thread are already in its ring, so any drain pass
+    // started after this point writes them out
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t target = passes_started_ + 1;
+    wake_requested_ = true;
+    wake_cv_.notify_one();
+    done_cv_.wait(lock, [&] { return passes_done_ >= target; });
+}
+
+void async_writer::drain(std::vector<record> &batch) {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    for (auto &r : rings_) {
+        size_t head = r->head.load(std::memory_order_relaxed);
+        size_t tail = r->tail.load(std::memory_order_acquire);
+        for (; head != tail; ++head)
+            batch.push_back(std::move(r->slots[head & r->mask]));
+        r->head.store(tail, std::memory_order_release);
+    }
+}
+
+void async_writer::run() {
+    std::vector<record> batch;
+    while (true) {
+        bool stop;
+        uint64_t pass;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_cv_.wait_for(lock, flush_interval_, [&] { return wake_requested_ || stop_; });
+            wake_requested_ = false;
+            stop = stop_;
+            pass = ++passes_started_;
+        }
+
+        // Everything logged before the stop request is drained here
+        drain(batch);
+        std::sort(batch.begin(), batch.end(),
+                  [](const record &a, const record &b) { return a.seq < b.seq; });
+        for (const auto &rec : batch)
+            writer_->write_msg(rec.time, rec.cmem, rec.max_rss, rec.l, rec.file, rec.line_num,
+                               rec.source, rec.msg.c_str());
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            passes_done_ = pass;
+        }
+        done_cv_.notify_all();
+        batch.clear();
+
+        if (stop)
+            break;
+    }
+}
+
+} // logging
@@ -0,0 +1,93 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "logger.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace logging {
+
+// Hands messages over to a dedicated thread that writes them via the wrapped
+// writer. Every producing thread gets its own single-producer ring buffer, so
+// logging threads never contend on a lock. Messages are written in the order
+// they were logged within a batch; messages from different threads racing
+// around a batch boundary may come out slightly reordered. Errors are
+// flushed synchronously. The writer is not used by default, it is enabled by
+// 'async=true' in the logger properties. Fatal errors, segfaults and aborts
+// (e.g. failed VERIFY) flush the logger when utils::segfault_handler is set.
+// File and source names are kept as pointers, so they must be static strings
+// (as __FILE__ and the DECL_LOGGER names are).
+// Note that thread-aware writers see the writer thread, not the producer.
+class async_writer : public writer {
+public:
+    explicit async_writer(writer_ptr writer,
+                          size_t ring_size = 1024,
+                          std::chrono::milliseconds flush_interval = std::chrono::milliseconds(20));
+    ~async_writer();
+
+    async_writer(const async_writer&) = delete;
+    void operator=(const async_writer&) = delete;
+
+    void write_msg(double time, size_t cmem, size_t max_rss, level l, const char *file, size_t line_num,
+                   const char *source, const char *msg);
+    void write_msg_owned(double time, size_t cmem, size_t max_rss, level l, const char *file, size_t line_num,
+                         const char *source, std::string &&msg);
+
+    // Blocks until everything logged so far is written
+    void flush();
+
+private:
+    struct record {
+        uint64_t seq;
+        double time;
+        size_t cmem;
+        size_t max_rss;
+        level l;
+        const char *file;
+        size_t line_num;
+        const char *source;
+        std::string msg;
+    };
+
+    struct ring;
+
+    ring &local_ring();
+    // Returns the slot for the next record, waits for the writer thread if the ring is full
+    record &reserve(ring &r);
+    void commit(ring &r, level l);
+    void drain(std::vector<record> &batch);
+    void wake();
+    void run();
+
+    writer_ptr writer_;
+    const size_t ring_size_;
+    const std::chrono::milliseconds flush_interval_;
+    // Identifies the writer in the thread-local ring caches
+    const uint64_t id_;
+
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<ring>> rings_;
+
+    std::atomic<uint64_t> seq_;
+    std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable done_cv_;
+    bool wake_requested_;
+    bool stop_;
+    // Drain passes started and completed by the writer thread
+    uint64_t passes_started_;
+    uint64_t passes_done_;
+
+    std::thread thread_;
+};
+
+} // logging
@@ -10,7 +10,7 @@
 
 namespace logging {
 
-void console_writer_thread::write_msg(double time, size_t cmem, size_t max_rss, level l, const std::filesystem::path& file, size_t line_num,
+void console_writer_thread::write_msg(double time, size_t cmem, size_t max_rss, level l, const char *file, size_t line_num,
                                       const char *source, const char *msg) {
     int thread = omp_get_thread_num();
     if (cmem != -1ull)
@@ -18,17 +18,17 @@ void console_writer_thread::write_msg(double time, size_t cmem, size_t max_rss,
                                  thread,
                                  utils::human_readable_time(time), utils::human_readable_memory(cmem),
                                  utils::human_readable_memory(max_rss), logging::level_name(l),
-                                 source, file.filename().c_str(), int(line_num), msg)
+                                 source, std::filesystem::path(file).filename().c_str(), int(line_num), msg)
                   << std::endl;
     else
         std::cout << fmt::format("thread #{:<2d} {:14s} {:^5s} {:6.6s} {:24.24s} ({:26.26s}:{:4d})   {:s}",
                                  thread,
                                  utils::human_readable_time(time), utils::human_readable_memory(max_rss),
-                                 logging::level_name(l), source, file.filename().c_str(), int(line_num), msg)
+                                 logging::level_name(l), source, std::filesystem::path(file).filename().c_str(), int(line_num), msg)
                   << std::endl;
 }
 
-void file_writer_thread::write_msg(double time, size_t cmem, size_t max_rss, level l, const std::filesystem::path& file, size_t line_num,
+void file_writer_thread::write_msg(double time, size_t cmem, size_t max_rss, level l, const char *file, size_t line_num,
                                    const char *source, const char *msg) {
     int thread = omp_get_thread_num();
     if (cmem != -1ull)
@@ -36,13 +36,13 @@ void file_writer_thread::write_msg(double time, size_t cmem, size_t max_rss, lev
                             thread,
                             utils::human_readable_time(time), utils::human_readable_memory(cmem),
                             utils::human_readable_memory(max_rss), logging::level_name(l),
-                            source, file.filename().c_str(), int(line_num), msg)
+                            source, std::filesystem::path(file).filename().c_str(), int(line_num), msg)
              << std::endl;
     else
         fout << fmt::format("thread #{:<2d} {:14s} {:^5s} {:6.6s} {:24.24s} ({:26.26s}:{:4d})   {:s}",
                             thread,
                             utils::human_readable_time(time), utils::human_readable_memory(max_rss),
-                            logging::level_name(l), source, file.filename().c_str(), int(line_num), msg)
+                            logging::level_name(l), source, std::filesystem::path(file).filename().c_str(), int(line_num), msg)
              << std::endl;
 }
 
@@ -13,7 +13,7 @@
 namespace logging {
 
 struct console_writer_thread : public writer {
-    void write_msg(double time, size_t cmem, size_t max_rss, level l, const std::filesystem::path& file, size_t line_num,
+    void write_msg(double time, size_t cmem, size_t max_rss, level l, const char *file, size_t line_num,
                    const char *source, const char *msg);
 };
 
@@ -21,7 +21,7 @@ class file_writer_thread : public writer {
 public:
     file_writer_thread(const std::string &filename) : fout(filename) {}
 
-    void write_msg(double time, size_t cmem, size_t max_rss, level l, const std::filesystem::path& file, size_t line_num,
+    void write_msg(double time, size_t cmem, size_t max_rss, level l, const char *file, size_t line_num,
                    const char *source, const char *msg);
 
 private:
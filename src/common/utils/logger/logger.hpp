@@ -16,6 +16,7 @@
 
 #include "config.hpp"
 
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -57,7 +58,16 @@ inline std::string level_name(level l)
 /////////////////////////////////////////////////////
 struct writer
 {
-  virtual void write_msg(double time_in_sec, size_t cmem, size_t max_rss, level l, const std::filesystem::path& file, size_t line_num, const char* source, const char* msg) = 0;
+  virtual void write_msg(double time_in_sec, size_t cmem, size_t max_rss, level l, const char *file, size_t line_num, const char* source, const char* msg) = 0;
+
+  // Called by the logger, which passes over the message. The file and the
+  // source are static strings, so buffering writers may keep the pointers
+  virtual void write_msg_owned(double time_in_sec, size_t cmem, size_t max_rss, level l, const char *file, size_t line_num, const char* source, std::string &&msg) {
+    write_msg(time_in_sec, cmem, max_rss, l, file, line_num, source, msg.c_str());
+  }
+
+  // Blocks until everything logged so far is written
+  virtual void flush() {}
 
   virtual ~writer(){}
 };
@@ -73,6 +83,8 @@ struct properties
      * Use leading # for comment.
      * File could contain line with default behavior description. If no 'default' entry found, default is set to INFO
      * Valid levels: TRACE, DEBUG, INFO, WARN, ERROR
+     * Entry 'async=true' makes writers hand the messages over to a dedicated
+     * thread (see async_writer)
      *
      *    default=INFO
      *    AbraCaDabra=TRACE
@@ -87,6 +99,7 @@ struct properties
     std::unordered_map<std::string, level> levels;
     level  def_level;
     bool   all_default;
+    bool   async;
 };
 
 ////////////////////////////////////////////////////
@@ -96,23 +109,31 @@ struct logger
 
     //
     bool need_log(level desired_level, const char* source) const;
-    void log(level desired_level, const std::filesystem::path& file, size_t line_num, const char* source, const char* msg);
+    void log(level desired_level, const char *file, size_t line_num, const char* source, std::string msg);
+    void flush();
 
     //
-    void add_writer(writer_ptr ptr) {
-        writers_.push_back(ptr);
-    }
+    void add_writer(writer_ptr ptr);
 
     template<class Writer, typename... Args>
     void add_writer(Args&&... args) {
-        writers_.push_back(std::make_shared<Writer>(std::forward<Args>(args)...));
+        add_writer(std::make_shared<Writer>(std::forward<Args>(args)...));
     }
     
 
 private:
+    // Memory statistics are queried at most once per this many seconds
+    static constexpr double MEMORY_SAMPLE_INTERVAL = 0.1;
+
+    void sample_memory();
+
     properties                 props_  ;
     std::vector<writer_ptr>    writers_;
     utils::perf_counter        timer_  ;
+
+    std::atomic<double>        last_sample_;
+    std::atomic<size_t>        mem_;
+    std::atomic<size_t>        max_rss_;
 };
 
 std::shared_ptr<logger>& __logger();
@@ -120,6 +141,7 @@ logger* create_logger(std::filesystem::path filename = "", level default_level =
 
 void attach_logger(logger *lg);
 void detach_logger();
+void flush_logger();
 
 } // logging
 
@@ -136,7 +158,7 @@ void detach_logger();
     if (__lg__->need_log((l), __scope_source_name())) {                 \
       std::stringstream __logger__str__;                                \
       __logger__str__ << msg; /* don't use brackets here! */            \
-      __lg__->log((l), __FILE__, __LINE__, __scope_source_name(), __logger__str__.str().c_str()); \
+      __lg__->log((l), __FILE__, __LINE__, __scope_source_name(), __logger__str__.str()); \
     }                                                                   \
   } while(0);
 
@@ -183,6 +205,7 @@ void detach_logger();
 #define FATAL_ERROR(message)                                            \
     do {                                                                \
         ERROR(message);                                                 \
+        logging::flush_logger();                                        \
         utils::print_stacktrace();                                      \
         if (errno != 0) {                                               \
             exit(errno);                                                \
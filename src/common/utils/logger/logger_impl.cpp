@@ -8,6 +8,7 @@
 #include "config.hpp"
 
 #include "utils/logger/logger.hpp"
+#include "utils/logger/log_writers_async.hpp"
 #include "utils/memory_limit.hpp"
 #include "utils/parallel/openmp_wrapper.h"
 #include "utils/perf/memory.hpp"
@@ -27,10 +28,10 @@
 namespace logging {
 
 properties::properties(level default_level)
-        : def_level(default_level), all_default(true) {}
+        : def_level(default_level), all_default(true), async(false) {}
 
 properties::properties(std::filesystem::path filename, level default_level)
-    : def_level(default_level), all_default(true) {
+    : def_level(default_level), all_default(true), async(false) {
     if (filename.empty())
         return;
 
@@ -63,6 +64,13 @@ properties::properties(std::filesystem::path filename, level default_level)
         utils::trim(entry[1]);
         entry[1] = utils::str_toupper(entry[1]);
 
+        if (entry[0] == "async") {
+            if (entry[1] != "TRUE" && entry[1] != "FALSE")
+                throw std::runtime_error("invalid log file async description: " + entry[1]);
+            async = entry[1] == "TRUE";
+            continue;
+        }
+
         auto it = remap.find(entry[1]);
         if (it == remap.end())
             throw std::runtime_error("invalid log file level description: " + entry[1]);
@@ -84,7 +92,9 @@ properties::properties(std::filesystem::path filename, level default_level)
 
 
 logger::logger(properties const& props)
-    : props_(props) { }
+    : props_(props), last_sample_(0), mem_(-1ull), max_rss_(-1ull) {
+  sample_memory();
+}
 
 bool logger::need_log(level desired_level, const char* source) const {
     level source_level = props_.def_level;
@@ -98,8 +108,7 @@ bool logger::need_log(level desired_level, const char* source) const {
     return desired_level >= source_level;
 }
 
-void logger::log(level desired_level, const std::filesystem::path& file, size_t line_num, const char* source, const char* msg) {
-  double time = timer_.time();
+void logger::sample_memory() {
   size_t mem = -1ull;
   size_t max_rss = -1ull;
 
@@ -140,8 +149,41 @@ void logger::log(level desired_level, const std::filesystem::path& file, size_t
   max_rss = utils::get_max_rss();
 #endif
 
-  for (auto it = writers_.begin(); it != writers_.end(); ++it)
-    (*it)->write_msg(time, mem, max_rss, desired_level, file, line_num, source, msg);
+  mem_.store(mem, std::memory_order_relaxed);
+  max_rss_.store(max_rss, std::memory_order_relaxed);
+}
+
+void logger::add_writer(writer_ptr ptr) {
+  if (props_.async)
+    ptr = std::make_shared<async_writer>(ptr);
+  writers_.push_back(ptr);
+}
+
+void logger::log(level desired_level, const char *file, size_t line_num, const char* source, std::string msg) {
+  double time = timer_.time();
+
+  // Querying the allocator is way more expensive than the message itself, so
+  // the statistics are refreshed by a single thread once the sample gets stale
+  double last = last_sample_.load(std::memory_order_relaxed);
+  if (time - last >= MEMORY_SAMPLE_INTERVAL &&
+      last_sample_.compare_exchange_strong(last, time, std::memory_order_relaxed))
+    sample_memory();
+
+  size_t mem = mem_.load(std::memory_order_relaxed);
+  size_t max_rss = max_rss_.load(std::memory_order_relaxed);
+
+  if (writers_.empty())
+    return;
+
+  // The last writer takes the message over
+  for (size_t i = 0; i + 1 < writers_.size(); ++i)
+    writers_[i]->write_msg(time, mem, max_rss, desired_level, file, line_num, source, msg.c_str());
+  writers_.back()->write_msg_owned(time, mem, max_rss, desired_level, file, line_num, source, std::move(msg));
+}
+
+void logger::flush() {
+  for (auto &writer : writers_)
+    writer->flush();
 }
 
 ////////////////////////////////////////////////////
@@ -162,5 +204,10 @@ void detach_logger() {
   __logger().reset();
 }
 
+void flush_logger() {
+  if (__logger())
+    __logger()->flush();
+}
+
 
 } // logging
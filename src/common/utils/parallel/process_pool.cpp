@@ -0,0 +1,118 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "process_pool.hpp"
+
+#include "utils/logger/logger.hpp"
+#include "utils/verify.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace utils {
+
+static void WorkerLoop(int fd, size_t memory_limit,
+                       const std::function<void(size_t)> &task) {
+    if (memory_limit) {
+        rlimit rl;
+        if (getrlimit(RLIMIT_AS, &rl) == 0) {
+            rl.rlim_cur = std::min<rlim_t>(memory_limit, rl.rlim_max);
+            setrlimit(RLIMIT_AS, &rl);
+        }
+    }
+
+    // Every index is written as a single write(2) smaller than PIPE_BUF, so
+    // reads never return a partial index
+    size_t idx;
+    while (true) {
+        ssize_t res = read(fd, &idx, sizeof(idx));
+        if (res == 0)
+            break;
+        if (res < 0 && errno == EINTR)
+            continue;
+        if (res != sizeof(idx))
+            _exit(2);
+        task(idx);
+    }
+}
+
+void RunInWorkerProcesses(size_t ntasks, unsigned nworkers, size_t memory_limit,
+                          const std::function<void(size_t)> &task) {
+    nworkers = (unsigned) std::max<size_t>(1, std::min<size_t>(nworkers, ntasks));
+    if (ntasks == 0)
+        return;
+
+    int fds[2];
+    CHECK_FATAL_ERROR(pipe(fds) == 0, "pipe(2) call failed, errno = " << errno << " (" << strerror(errno) << ")");
+
+    // Make sure buffered log output is not duplicated by the workers
+    fflush(stdout);
+    fflush(stderr);
+
+    std::vector<pid_t> workers;
+    for (unsigned i = 0; i < nworkers; ++i) {
+        pid_t pid = fork();
+        CHECK_FATAL_ERROR(pid >= 0, "fork(2) call failed, errno = " << errno << " (" << strerror(errno) << ")");
+        if (pid == 0) {
+            close(fds[1]);
+            int status = 0;
+            try {
+                WorkerLoop(fds[0], memory_limit, task);
+            } catch (const std::exception &e) {
+                fprintf(stderr, "Worker process failed: %s\n", e.what());
+                status = 1;
+            } catch (...) {
+                status = 1;
+            }
+            // Do not run any destructors here: all the temporary files are owned
+            // by the parent
+            _exit(status);
+        }
+        workers.push_back(pid);
+    }
+    close(fds[0]);
+
+    // A closed pipe means all the workers are dead, report it below
+    sighandler_t prev = signal(SIGPIPE, SIG_IGN);
+    for (size_t i = 0; i < ntasks; ++i) {
+        ssize_t res;
+        do {
+            res = write(fds[1], &i, sizeof(i));
+        } while (res < 0 && errno == EINTR);
+        if (res != sizeof(i))
+            break;
+    }
+    close(fds[1]);
+    signal(SIGPIPE, prev);
+
+    size_t failed = 0;
+    for (pid_t pid : workers) {
+        int status;
+        while (waitpid(pid, &status, 0) < 0) {
+            CHECK_FATAL_ERROR(errno == EINTR, "waitpid(2) call failed, errno = " << errno << " (" << strerror(errno) << ")");
+        }
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+            continue;
+
+        failed += 1;
+        if (WIFSIGNALED(status)) {
+            WARN("Worker process " << pid << " was killed by signal " << WTERMSIG(status));
+        } else {
+            WARN("Worker process " << pid << " exited with code " << WEXITSTATUS(status));
+        }
+    }
+    CHECK_FATAL_ERROR(failed == 0, failed << " worker process(es) failed");
+}
+
+}
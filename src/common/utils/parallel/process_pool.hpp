@@ -0,0 +1,26 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace utils {
+
+// Runs task(i) for every i in [0, ntasks) using nworkers forked worker
+// processes. Tasks are handed out dynamically, in increasing order of i.
+// Workers share nothing with the parent after the fork and should communicate
+// results via files. The parent usually has OpenMP threads running, and the
+// runtime is not fork-safe: workers must not use OpenMP at all (including
+// parallel regions, critical sections and locks), every worker processes its
+// tasks sequentially. If memory_limit
+// is non-zero, address space of every worker is capped by it.
+// Returns when all the tasks are done, fails if any of the workers failed.
+void RunInWorkerProcesses(size_t ntasks, unsigned nworkers, size_t memory_limit,
+                          const std::function<void(size_t)> &task);
+
+}
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include "utils/logger/logger.hpp"
 #include "utils/stacktrace.hpp"
 #include "boost/noncopyable.hpp"
 
@@ -28,11 +29,13 @@ struct segfault_handler : boost::noncopyable {
 
         callback() = cb;
         old_func_ = signal(SIGSEGV, &segfault_handler::handler);
+        old_abort_func_ = signal(SIGABRT, &segfault_handler::abort_handler);
     }
 
     ~segfault_handler() {
         callback() = 0;
         signal(SIGSEGV, old_func_);
+        signal(SIGABRT, old_abort_func_);
     }
 
 private:
@@ -44,6 +47,7 @@ private:
     static void handler(int signum) {
         if (signum == SIGSEGV) {
             std::cerr << "The program was terminated by segmentation fault" << std::endl;
+            logging::flush_logger();
             print_stacktrace();
 
             if (callback())
@@ -57,8 +61,17 @@ private:
         kill(getpid(), signum);
     }
 
+    // Failed VERIFY: write out the buffered log messages and abort as usual
+    static void abort_handler(int signum) {
+        logging::flush_logger();
+
+        signal(signum, SIG_DFL);
+        kill(getpid(), signum);
+    }
+
 private:
     seg_handler_t old_func_;
+    seg_handler_t old_abort_func_;
 };
 
 }
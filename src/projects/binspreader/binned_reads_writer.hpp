@@ -0,0 +1,126 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "io/reads/osequencestream.hpp"
+#include "io/reads/paired_read.hpp"
+#include "io/reads/orientation.hpp"
+#include "utils/logger/logger.hpp"
+
+#include <zlib.h>
+
+#include <filesystem>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace binning {
+
+// Paired FASTQ files of all the bins. Reads are formatted into per-thread
+// buffers and appended to the files in large chunks under per-bin locks, so
+// different bins are written (and compressed) concurrently.
+class BinnedReadsWriter {
+    // Default size of the reads buffered by a single thread over all the bins
+    static constexpr size_t BUFFER_SIZE = 4 << 20;
+
+    struct BinFiles {
+        gzFile left = nullptr, right = nullptr;
+        std::mutex mutex;
+    };
+
+    struct BinBuffer {
+        std::ostringstream left, right;
+    };
+
+  public:
+    // Buffers of a single thread. The budget is shared by all the bins, so the
+    // memory used does not grow with the number of bins
+    class Buffer {
+        friend class BinnedReadsWriter;
+
+        Buffer(size_t bins) : bins_(bins) {}
+
+        std::vector<BinBuffer> bins_;
+        size_t size_ = 0;
+
+      public:
+        // Bytes currently buffered
+        size_t size() const { return size_; }
+    };
+
+    BinnedReadsWriter(const std::vector<std::filesystem::path> &prefixes,
+                      io::LibraryOrientation orientation, bool gzip,
+                      size_t buffer_size = BUFFER_SIZE)
+            : files_(prefixes.size()), buffer_size_(buffer_size) {
+        std::tie(rc1_, rc2_) = io::GetRCFlags(orientation);
+        // Transparent mode writes plain uncompressed files
+        const char *mode = gzip ? "wb" : "wbT";
+        std::string ext = gzip ? ".fastq.gz" : ".fastq";
+        for (size_t i = 0; i < prefixes.size(); ++i) {
+            std::string left = prefixes[i].string() + "_1" + ext, right = prefixes[i].string() + "_2" + ext;
+            files_[i].left = gzopen(left.c_str(), mode);
+            CHECK_FATAL_ERROR(files_[i].left, "Cannot open " << left);
+            files_[i].right = gzopen(right.c_str(), mode);
+            CHECK_FATAL_ERROR(files_[i].right, "Cannot open " << right);
+        }
+    }
+
+    ~BinnedReadsWriter() {
+        for (auto &files : files_) {
+            CHECK_FATAL_ERROR(gzclose(files.left) == Z_OK && gzclose(files.right) == Z_OK,
+                              "Failed to write binned reads");
+        }
+    }
+
+    size_t size() const { return files_.size(); }
+
+    Buffer buffer() const { return Buffer(files_.size()); }
+
+    void Add(Buffer &buffer, size_t bin, const io::PairedReadSeq &read) {
+        BinBuffer &bin_buffer = buffer.bins_[bin];
+        auto left = bin_buffer.left.tellp(), right = bin_buffer.right.tellp();
+        io::FastqWriter::Write(bin_buffer.left, rc1_ ? !read.first() : read.first());
+        io::FastqWriter::Write(bin_buffer.right, rc2_ ? !read.second(): read.second());
+        buffer.size_ += size_t(bin_buffer.left.tellp() - left) + size_t(bin_buffer.right.tellp() - right);
+        if (buffer.size_ >= buffer_size_)
+            Flush(buffer);
+    }
+
+    void Flush(Buffer &buffer) {
+        for (size_t bin = 0; bin < buffer.bins_.size(); ++bin)
+            Flush(buffer.bins_[bin], bin);
+        buffer.size_ = 0;
+    }
+
+  private:
+    void Flush(BinBuffer &buffer, size_t bin) {
+        if (buffer.left.tellp() == 0 && buffer.right.tellp() == 0)
+            return;
+
+        std::string left = buffer.left.str(), right = buffer.right.str();
+        // Fresh streams give the memory back, str("") would keep the capacity
+        buffer.left = std::ostringstream();
+        buffer.right = std::ostringstream();
+
+        BinFiles &files = files_[bin];
+        std::lock_guard<std::mutex> lock(files.mutex);
+        Write(files.left, left);
+        Write(files.right, right);
+    }
+
+    static void Write(gzFile file, const std::string &data) {
+        CHECK_FATAL_ERROR(data.empty() || gzwrite(file, data.data(), unsigned(data.size())) == int(data.size()),
+                          "Failed to write binned reads");
+    }
+
+    std::vector<BinFiles> files_;
+    size_t buffer_size_;
+    bool rc1_, rc2_;
+};
+
+}
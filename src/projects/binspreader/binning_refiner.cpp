@@ -69,6 +69,8 @@ struct gcfg {
     bool bin_dist = false;
     uint64_t out_options = 0;
     bool split_reads = false;
+    bool split_by_index = false;
+    bool split_gzip = false;
     double bin_weight_threshold = 0.1;
 };
 
@@ -107,7 +109,9 @@ static void process_cmdline(int argc, char** argv, gcfg& cfg) {
       ),
       "Read splitting options:" % (
           (option("-r", "--reads").set(cfg.split_reads) % "split reads according to binning"),
-          (option("-b", "--bin-weight") & value("threshold", cfg.bin_weight_threshold)) % "reads bin weight threshold"
+          (option("-b", "--bin-weight") & value("threshold", cfg.bin_weight_threshold)) % "reads bin weight threshold",
+          (option("--reads-by-index").set(cfg.split_by_index)) % "record read indices during mapping and write bins in a separate parallel pass",
+          (option("--reads-gzip").set(cfg.split_gzip)) % "gzip split reads (implies --reads-by-index)"
       ),
       "Developer options:" % (
           (option("--bin-load").set(cfg.bin_load)) % "load binary-converted reads from tmpdir",
@@ -417,7 +421,8 @@ int main(int argc, char** argv) {
                                       cfg.tmpdir,
                                       cfg.prefix,
                                       cfg.nthreads,
-                                      cfg.bin_weight_threshold);
+                                      cfg.bin_weight_threshold,
+                                      cfg.split_by_index, cfg.split_gzip);
           INFO("Splitting reads ended");
       }
 
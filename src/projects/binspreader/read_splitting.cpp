@@ -6,6 +6,7 @@
 //***************************************************************************
 
 #include "read_splitting.hpp"
+#include "binned_reads_writer.hpp"
 #include "binning.hpp"
 
 #include "alignment/sequence_mapper_notifier.hpp"
@@ -15,10 +16,12 @@
 #include "io/reads/osequencestream.hpp"
 #include "io/reads/io_helper.hpp"
 #include "io/dataset_support/read_converter.hpp"
+#include "utils/parallel/openmp_wrapper.h"
 
-#include <filesystem>
 #include <threadpool/threadpool.hpp>
 
+#include <algorithm>
+#include <filesystem>
 #include <vector>
 
 using namespace debruijn_graph;
@@ -26,6 +29,44 @@ using namespace bin_stats;
 
 namespace binning {
 
+// Chooses the bins for a read pair. Pairs with an unmapped read are unbinned
+class ReadBinsAssigner {
+  public:
+    typedef std::unordered_set<bin_stats::Binning::BinId> ReadBins;
+
+    ReadBinsAssigner(const Binning &binning,
+                     const SoftBinsAssignment &soft_edge_labels,
+                     const BinningAssignmentStrategy &assignment_strategy)
+        : binning_(binning),
+          soft_edge_labels_(soft_edge_labels),
+          assignment_strategy_(assignment_strategy) {}
+
+    bool AssignBins(const MappingPath<EdgeId>& first_path,
+                    const MappingPath<EdgeId>& second_path,
+                    ReadBins &read_bins) const {
+        if (first_path.empty() || second_path.empty())
+            return false;
+
+        auto first_read_bins =
+                assignment_strategy_.ChooseMajorBins(assignment_strategy_.AssignScaffoldBins(first_path.simple_path(),
+                                                                                             soft_edge_labels_, binning_),
+                                                     soft_edge_labels_, binning_);
+        auto second_read_bins =
+                assignment_strategy_.ChooseMajorBins(assignment_strategy_.AssignScaffoldBins(second_path.simple_path(),
+                                                                                             soft_edge_labels_, binning_),
+                                                     soft_edge_labels_, binning_);
+
+        read_bins.insert(first_read_bins.begin(), first_read_bins.end());
+        read_bins.insert(second_read_bins.begin(), second_read_bins.end());
+        return true;
+    }
+
+  private:
+    const Binning &binning_;
+    const SoftBinsAssignment& soft_edge_labels_;
+    const BinningAssignmentStrategy& assignment_strategy_;
+};
+
 class ReadsPathsToComponentsListener : public debruijn_graph::SequenceMapperListener {
  public:
     ReadsPathsToComponentsListener(const Binning &binning,
@@ -36,9 +77,7 @@ class ReadsPathsToComponentsListener : public debruijn_graph::SequenceMapperList
                                    const double bin_weight_threshold)
         : binned_reads_ostreams_(binned_reads_ostreams),
           unbinned_reads_ostream_(unbinned_reads_ostream),
-          binning_(binning),
-          soft_edge_labels_(soft_edge_labels),
-          assignment_strategy_(assignment_strategy),
+          assigner_(binning, soft_edge_labels, assignment_strategy),
           bin_weight_threshold_(bin_weight_threshold) {}
 
     void StartProcessLibrary(size_t threads_count) override {
@@ -71,20 +110,8 @@ class ReadsPathsToComponentsListener : public debruijn_graph::SequenceMapperList
         BinnedReads &reads = binned_reads_[thread_index];
         ReadVector &unbinned =  unbinned_reads_[thread_index];
 
-        if (!first_path.empty() && !second_path.empty()) {
-            auto first_read_bins =
-                    assignment_strategy_.ChooseMajorBins(assignment_strategy_.AssignScaffoldBins(first_path.simple_path(),
-                                                                                                 soft_edge_labels_, binning_),
-                                                         soft_edge_labels_, binning_);
-            auto second_read_bins =
-                    assignment_strategy_.ChooseMajorBins(assignment_strategy_.AssignScaffoldBins(second_path.simple_path(),
-                                                                                                 soft_edge_labels_, binning_),
-                                                         soft_edge_labels_, binning_);
-
-            std::unordered_set<bin_stats::Binning::BinId> read_bins;
-            read_bins.insert(first_read_bins.begin(), first_read_bins.end());
-            read_bins.insert(second_read_bins.begin(), second_read_bins.end());
-
+        ReadBinsAssigner::ReadBins read_bins;
+        if (assigner_.AssignBins(first_path, second_path, read_bins)) {
             for (auto bin : read_bins)
                 reads[bin].push_back(paired_read);
         } else 
@@ -101,13 +128,118 @@ class ReadsPathsToComponentsListener : public debruijn_graph::SequenceMapperList
     std::vector<io::OFastqPairedStream> &binned_reads_ostreams_;
     io::OFastqPairedStream &unbinned_reads_ostream_;
 
-    const Binning &binning_;
-    const SoftBinsAssignment& soft_edge_labels_;
-    const BinningAssignmentStrategy& assignment_strategy_;
+    ReadBinsAssigner assigner_;
 
     double bin_weight_threshold_;
 };
 
+// Only remembers the bins of every read pair: pairs are identified by the
+// stream they come from and the ordinal number within this stream. Note that
+// the notifier processes every stream by a single thread and passes the stream
+// index as the thread index.
+class ReadIndicesListener : public debruijn_graph::SequenceMapperListener {
+ public:
+    // Ordinal number of a read pair in its stream and its bin, unbinned pairs
+    // are marked with bins count
+    typedef std::pair<uint32_t, uint32_t> ReadBin;
+
+    ReadIndicesListener(const Binning &binning,
+                        const SoftBinsAssignment &soft_edge_labels,
+                        const BinningAssignmentStrategy &assignment_strategy)
+        : unbinned_(uint32_t(binning.bins().size())),
+          assigner_(binning, soft_edge_labels, assignment_strategy) {}
+
+    void StartProcessLibrary(size_t threads_count) override {
+        read_bins_.assign(threads_count, {});
+        read_counts_.assign(threads_count, 0);
+    }
+
+    void ProcessPairedRead(size_t thread_index,
+                           const io::PairedReadSeq&,
+                           const MappingPath<EdgeId>& first_path,
+                           const MappingPath<EdgeId>& second_path) override {
+        size_t idx = read_counts_[thread_index]++;
+        CHECK_FATAL_ERROR(idx <= std::numeric_limits<uint32_t>::max(),
+                          "Too many reads in a single stream");
+
+        auto &read_bins = read_bins_[thread_index];
+        ReadBinsAssigner::ReadBins bins;
+        if (assigner_.AssignBins(first_path, second_path, bins)) {
+            for (auto bin : bins)
+                read_bins.emplace_back(uint32_t(idx), uint32_t(bin));
+        } else
+            read_bins.emplace_back(uint32_t(idx), unbinned_);
+    }
+
+    // Sorted by ordinal number for every stream
+    const std::vector<ReadBin> &read_bins(size_t stream) const {
+        return read_bins_[stream];
+    }
+
+    size_t size() const { return read_bins_.size(); }
+
+ private:
+    uint32_t unbinned_;
+    std::vector<std::vector<ReadBin>> read_bins_;
+    std::vector<size_t> read_counts_;
+
+    ReadBinsAssigner assigner_;
+};
+
+static std::filesystem::path BinPrefix(const Binning &binning, size_t bin_id,
+                                       const std::filesystem::path &prefix) {
+    auto bin_label = binning.bin_labels().at(bin_id);
+    std::replace(bin_label.begin(), bin_label.end(), '/', '_');
+    return prefix / bin_label;
+}
+
+// Maps the reads recording only the bins of every pair, then re-streams the
+// binary reads and writes all the bins in parallel
+static void SplitAndWriteReadsByIndex(const debruijn_graph::Graph &graph,
+                                      SequencingLib &lib,
+                                      const Binning &binning,
+                                      const SoftBinsAssignment& edge_soft_labels,
+                                      const BinningAssignmentStrategy& assignment_strategy,
+                                      const std::filesystem::path &work_dir,
+                                      const std::filesystem::path &prefix,
+                                      unsigned nthreads, bool gzip) {
+    auto paired_streams = paired_binary_readers(lib, /*followed by rc*/ false, 0,
+                                                /*include merged*/true);
+    ReadIndicesListener listener(binning, edge_soft_labels, assignment_strategy);
+    {
+        SequenceMapperNotifier notifier;
+        auto mapper = alignment::ShortKMerReadMapper(graph, work_dir);
+        notifier.Subscribe(&listener);
+        notifier.ProcessLibrary(paired_streams, mapper);
+    }
+    VERIFY(listener.size() == paired_streams.size());
+
+    std::vector<std::filesystem::path> prefixes;
+    for (size_t bin_id = 0; bin_id < binning.bins().size(); ++bin_id)
+        prefixes.push_back(BinPrefix(binning, bin_id, prefix));
+    prefixes.push_back(prefix / "unbinned");
+    BinnedReadsWriter writer(prefixes, lib.orientation(), gzip);
+
+    INFO("Writing binned reads");
+    paired_streams.reset();
+#   pragma omp parallel for num_threads(std::min<size_t>(nthreads, paired_streams.size())) schedule(dynamic, 1)
+    for (size_t i = 0; i < paired_streams.size(); ++i) {
+        const auto &read_bins = listener.read_bins(i);
+        auto buffer = writer.buffer();
+        auto &stream = paired_streams[i];
+        io::PairedReadSeq read;
+        uint32_t idx = 0;
+        for (auto it = read_bins.begin(); it != read_bins.end(); ++idx) {
+            VERIFY(!stream.eof());
+            stream >> read;
+            for (; it != read_bins.end() && it->first == idx; ++it)
+                writer.Add(buffer, it->second, read);
+        }
+
+        writer.Flush(buffer);
+    }
+}
+
 void SplitAndWriteReads(const debruijn_graph::Graph &graph,
                         SequencingLib &lib,
                         const Binning &binning,
@@ -116,7 +248,8 @@ void SplitAndWriteReads(const debruijn_graph::Graph &graph,
                         const std::filesystem::path &work_dir,
                         const std::filesystem::path &prefix,
                         unsigned nthreads,
-                        const double bin_weight_threshold) {
+                        const double bin_weight_threshold,
+                        bool by_index, bool gzip) {
     if (!io::ReadConverter::LoadLibIfExists(lib)) {
         std::unique_ptr<ThreadPool::ThreadPool> pool;
         if (nthreads > 1)
@@ -124,19 +257,21 @@ void SplitAndWriteReads(const debruijn_graph::Graph &graph,
         io::ReadConverter::ConvertToBinary(lib, pool.get());
     }
 
+    if (by_index || gzip) {
+        SplitAndWriteReadsByIndex(graph, lib, binning, edge_soft_labels, assignment_strategy,
+                                  work_dir, prefix, nthreads, gzip);
+        return;
+    }
+
     io::OFastqPairedStream unbinned_reads_ostream(prefix / "unbinned_1.fastq",
                                                   prefix / "unbinned_2.fastq",
                                                   lib.orientation());
 
     std::vector<io::OFastqPairedStream> binned_reads_ostreams;
     for (size_t bin_id = 0; bin_id < binning.bins().size(); ++bin_id) {
-        auto bin_label = binning.bin_labels().at(bin_id);
-        std::replace(bin_label.begin(), bin_label.end(), '/', '_');
-        const std::pair<std::string, std::string> cur_part_paired_reads_filenames
-                {prefix / (bin_label + "_1.fastq"),
-                 prefix / (bin_label + "_2.fastq")};
-        binned_reads_ostreams.emplace_back(cur_part_paired_reads_filenames.first,
-                                           cur_part_paired_reads_filenames.second,
+        std::filesystem::path bin_prefix = BinPrefix(binning, bin_id, prefix);
+        binned_reads_ostreams.emplace_back(bin_prefix.string() + "_1.fastq",
+                                           bin_prefix.string() + "_2.fastq",
                                            lib.orientation());
     }
 
@@ -19,6 +19,10 @@ typedef io::SequencingLibrary<debruijn_graph::config::LibraryData> SequencingLib
 
 namespace binning {
 
+// Writes paired reads of every bin into <prefix>/<bin>_{1,2}.fastq. By
+// default the reads are copied during mapping. In the by-index mode only the
+// bins of every read pair are recorded and the reads are re-streamed
+// afterwards, with all the bins written in parallel (and gzipped, if asked).
 void SplitAndWriteReads(const debruijn_graph::Graph &graph,
                         SequencingLib &lib,
                         const bin_stats::Binning &binning,
@@ -27,6 +31,7 @@ void SplitAndWriteReads(const debruijn_graph::Graph &graph,
                         const std::filesystem::path &work_dir,
                         const std::filesystem::path &prefix,
                         unsigned nthreads,
-                        const double bin_weight_threshold);
+                        const double bin_weight_threshold,
+                        bool by_index = false, bool gzip = false);
 
 }
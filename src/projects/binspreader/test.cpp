@@ -0,0 +1,124 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "binned_reads_writer.hpp"
+
+#include "utils/filesystem/temporary.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace binning;
+
+namespace {
+
+std::string RandomNucls(std::mt19937 &rnd, size_t size) {
+    std::string res(size, 'A');
+    for (char &c : res)
+        c = "ACGT"[rnd() % 4];
+    return res;
+}
+
+// Sequences of the FASTQ file, sorted
+std::vector<std::string> ReadSequences(const std::string &filename) {
+    gzFile file = gzopen(filename.c_str(), "rb");
+    EXPECT_TRUE(file) << filename;
+    if (!file)
+        return {};
+
+    std::string content;
+    char buf[1 << 16];
+    int n;
+    while ((n = gzread(file, buf, sizeof(buf))) > 0)
+        content.append(buf, n);
+    gzclose(file);
+
+    std::vector<std::string> res;
+    std::istringstream ss(content);
+    std::string line;
+    for (size_t i = 0; std::getline(ss, line); ++i) {
+        if (i % 4 == 1)
+            res.push_back(line);
+    }
+    std::sort(res.begin(), res.end());
+
+    return res;
+}
+
+void CheckBinnedReads(bool gzip) {
+    const size_t BINS = 5, READS = 3000, BUFFER_SIZE = 4096;
+    auto dir = fs::tmp::make_temp_dir(std::filesystem::temp_directory_path(), "binned_reads");
+
+    std::vector<std::filesystem::path> prefixes;
+    for (size_t bin = 0; bin < BINS; ++bin)
+        prefixes.push_back(dir->dir() / ("bin" + std::to_string(bin)));
+
+    std::mt19937 rnd(42);
+    std::vector<io::PairedReadSeq> reads;
+    for (size_t i = 0; i < READS; ++i)
+        reads.emplace_back(io::SingleReadSeq(Sequence(RandomNucls(rnd, 100 + rnd() % 50))),
+                           io::SingleReadSeq(Sequence(RandomNucls(rnd, 100 + rnd() % 50))), 0);
+
+    // Some reads belong to two bins
+    auto read_bins = [&](size_t i) {
+        std::vector<size_t> bins = { i % BINS };
+        if (i % 7 == 0)
+            bins.push_back((i + 1) % BINS);
+        return bins;
+    };
+
+    size_t overflows = 0;
+    {
+        BinnedReadsWriter writer(prefixes, io::LibraryOrientation::FR, gzip, BUFFER_SIZE);
+        ASSERT_EQ(BINS, writer.size());
+
+#       pragma omp parallel num_threads(4) reduction(+:overflows)
+        {
+            auto buffer = writer.buffer();
+#           pragma omp for schedule(static, 100)
+            for (size_t i = 0; i < READS; ++i) {
+                for (size_t bin : read_bins(i)) {
+                    writer.Add(buffer, bin, reads[i]);
+                    // The budget is per thread, not per bin
+                    overflows += buffer.size() >= BUFFER_SIZE;
+                }
+            }
+            writer.Flush(buffer);
+            overflows += buffer.size() != 0;
+        }
+    }
+    EXPECT_EQ(0u, overflows);
+
+    std::string ext = gzip ? ".fastq.gz" : ".fastq";
+    for (size_t bin = 0; bin < BINS; ++bin) {
+        std::vector<std::string> left, right;
+        for (size_t i = 0; i < READS; ++i) {
+            auto bins = read_bins(i);
+            if (std::find(bins.begin(), bins.end(), bin) == bins.end())
+                continue;
+            left.push_back(reads[i].first().sequence().str());
+            // FR orientation: the right read is reverse-complemented
+            right.push_back((!reads[i].second().sequence()).str());
+        }
+        std::sort(left.begin(), left.end());
+        std::sort(right.begin(), right.end());
+
+        EXPECT_EQ(left, ReadSequences(prefixes[bin].string() + "_1" + ext));
+        EXPECT_EQ(right, ReadSequences(prefixes[bin].string() + "_2" + ext));
+    }
+}
+
+}
+
+TEST(BinnedReadsWriter, Plain) {
+    CheckBinnedReads(/* gzip */ false);
+}
+
+TEST(BinnedReadsWriter, Gzip) {
+    CheckBinnedReads(/* gzip */ true);
+}
@@ -121,6 +121,23 @@ class PoissonGammaDistribution {
     return ll;
   }
 
+  // LogLikelihood() for every count in [from, to] at once. Consecutive values
+  // differ by log((a + c) / (c + 1)) - log(b + 1), so only the first one
+  // needs log-gamma evaluations
+  std::vector<double> LogLikelihoods(size_t from, size_t to) const {
+    const double a = prior_.GetShape();
+    const double log_rate_step = log(prior_.GetRate() + 1);
+
+    std::vector<double> res;
+    res.reserve(to >= from ? to - from + 1 : 0);
+    double ll = LogLikelihood(from);
+    for (size_t count = from; count <= to; ++count) {
+      res.push_back(ll);
+      ll += log((a + (double)count) / ((double)count + 1)) - log_rate_step;
+    }
+    return res;
+  }
+
   inline double Quantile(double p) const {
     const double a = prior_.GetShape();
     const double b = prior_.GetRate();
@@ -562,7 +579,7 @@ class TClusterModelEstimator {
         digamma_sum_first_ += other.digamma_sum_first_;
         trigamma_sum_first_ += other.trigamma_sum_first_;
 
-        digamma_sum_second_ = other.digamma_sum_second_;
+        digamma_sum_second_ += other.digamma_sum_second_;
         trigamma_sum_second_ += other.trigamma_sum_second_;
       }
       return *this;
@@ -847,15 +864,27 @@ class TClusterModelEstimator {
       sum2 += (double)count * (double)count;
     }
 
+    // Counts repeat a lot, so digamma and trigamma are evaluated once per
+    // distinct value and weighted by its multiplicity
+    std::vector<size_t> sorted(counts);
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<std::pair<double, double>> histogram;
+    for (size_t i = 0, j = 0; i < sorted.size(); i = j) {
+      while (j < sorted.size() && sorted[j] == sorted[i]) {
+        ++j;
+      }
+      histogram.emplace_back((double)sorted[i], (double)(j - i));
+    }
+
     GammaDistribution prior =
         TClusterModelEstimator::MomentMethodEstimator(sum, sum2, (double)observations);
 
     for (unsigned i = 0, steps = 0; i < 10; ++i, ++steps) {
       double digammaSum = 0;
       double trigammaSum = 0;
-      for (auto count : counts) {
-        digammaSum += boost::math::digamma((double)count + prior.GetShape());
-        trigammaSum += boost::math::trigamma((double)count + prior.GetShape());
+      for (const auto& entry : histogram) {
+        digammaSum += entry.second * boost::math::digamma(entry.first + prior.GetShape());
+        trigammaSum += entry.second * boost::math::trigamma(entry.first + prior.GetShape());
       }
 
       auto direction = MoveDirection(prior.GetShape(), sum, (double)observations,
@@ -145,7 +145,18 @@ class Binarizer {
 
 class NormalClusterModel {
  private:
+  // Per-bin mixture constants for the batched posterior evaluation:
+  // component log-likelihood is log_norm - (x - mean)^2 * half_inv_sigma_sqr
+  struct PosteriorCoefs {
+    double first_mean;
+    double first_half_inv_sigma_sqr;
+    double second_mean;
+    double second_half_inv_sigma_sqr;
+    double log_odds;  // Second minus first component log normalizers
+  };
+
   std::vector<NormalMixture> mixtures_;
+  std::vector<PosteriorCoefs> posterior_coefs_;
   Binarizer binarizer_;
   std::vector<double> median_qualities_;
   QualityTransform trans_;
@@ -167,6 +178,16 @@ class NormalClusterModel {
         median_qualities_(medianQualities),
         trans_(trans) {
     lower_quality_threshold_ = cfg::get().noise_filter_count_threshold;  // threshold >= 10 ? 1 : 0;
+
+    for (const auto& mixture : mixtures_) {
+      const auto& first = mixture.GetFirst();
+      const auto& second = mixture.GetSecond();
+      const double first_log_norm = -0.5 * log(2 * M_PI * first.GetSigmaSqr()) + log(mixture.GetFirstWeight());
+      const double second_log_norm = -0.5 * log(2 * M_PI * second.GetSigmaSqr()) + log(1.0 - mixture.GetFirstWeight());
+      posterior_coefs_.push_back({first.GetMean(), 0.5 / first.GetSigmaSqr(),
+                                  second.GetMean(), 0.5 / second.GetSigmaSqr(),
+                                  second_log_norm - first_log_norm});
+    }
   }
 
   NormalClusterModel(const NormalClusterModel& other) = default;
@@ -199,6 +220,37 @@ class NormalClusterModel {
     return mixtures_[bin].FirstComponentPosterior(x);
   }
 
+  // Batched StatTransform() and GenomicLogLikelihood() for n k-mers of a
+  // cluster. Bins and transformed qualities are gathered first, then the
+  // posteriors are evaluated in a flat loop over the per-bin constants.
+  void GenomicLogLikelihoods(const KMerData& data, const size_t* kmers, size_t n,
+                             double* transformed, double* posteriors) const {
+    thread_local std::vector<int> bins;
+    thread_local std::vector<double> counts;
+    bins.resize(n);
+    counts.resize(n);
+
+    for (size_t i = 0; i < n; ++i) {
+      const auto& stat = data[kmers[i]];
+      bins[i] = binarizer_.GetBin((double)GetKmerBinIdx(stat.kmer));
+      counts[i] = stat.count;
+      transformed[i] = trans_.Apply(stat.qual, stat.count);
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+      const auto& c = posterior_coefs_[bins[i]];
+      const double x = transformed[i];
+      const double d1 = x - c.first_mean;
+      const double d2 = x - c.second_mean;
+      // secondLL - firstLL, see NormalMixture::FirstComponentPosterior
+      const double diff = c.log_odds - d2 * d2 * c.second_half_inv_sigma_sqr +
+                          d1 * d1 * c.first_half_inv_sigma_sqr;
+      const double expDiff = exp(diff);
+      const double posterior = std::isfinite(expDiff) ? -log(1.0 + expDiff) : -diff;
+      posteriors[i] = counts[i] <= lower_quality_threshold_ ? -1e5 : posterior;
+    }
+  }
+
   static size_t GetKmerBinIdx(const hammer::HKMer& kmer) {
     if (kmer.size() > 21) {
       return 1 + kmer.max_run_length();
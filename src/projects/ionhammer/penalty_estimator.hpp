@@ -55,6 +55,9 @@ class GammaPoissonLikelihoodCalcer {
   double lower_quantile_;
   size_t noise_quantiles_lower_;
   size_t noise_quantile_upper_;
+  // Count log-likelihoods for the range of clamped counts, starting from noise_table_from_
+  size_t noise_table_from_;
+  std::vector<double> noise_log_likelihoods_;
   double correction_penalty_;
   double bad_kmer_penalty_;
   const KMerData& data_;
@@ -130,6 +133,8 @@ class GammaPoissonLikelihoodCalcer {
     const double eps = cfg::get().count_dist_eps;
     noise_quantiles_lower_ = (size_t)max(count_distribution_.Quantile(eps), 1.0);
     noise_quantile_upper_ = (size_t)count_distribution_.Quantile(1.0 - eps);
+    noise_table_from_ = std::min(noise_quantiles_lower_, noise_quantile_upper_);
+    noise_log_likelihoods_ = count_distribution_.LogLikelihoods(noise_table_from_, noise_quantile_upper_);
 
     correction_penalty_ = cfg::get().correction_penalty;
     bad_kmer_penalty_ = cfg::get().bad_kmer_penalty;
@@ -178,7 +183,7 @@ class GammaPoissonLikelihoodCalcer {
 
       // state.Likelihood += dist * log(Model.ErrorRate(event.FixedSize));
       state.likelihood_ += (double)state.hkmer_distance_to_read_ * correction_penalty_;
-      state.likelihood_ += count_distribution_.LogLikelihood(cnt);
+      state.likelihood_ += noise_log_likelihoods_[cnt - noise_table_from_];
     }
 
     if (!is_good) {
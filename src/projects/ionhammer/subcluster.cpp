@@ -81,17 +81,21 @@ void TGenomicHKMersEstimator::ProceedCluster(std::vector<size_t>& cluster) {
   std::vector<double> qualities;
   std::vector<size_t> candidates;
 
-  for (size_t i = 0; i < cluster.size(); ++i) {
+  // The cluster is sorted by count, so only its prefix is ever considered
+  size_t considered = std::min(cluster.size(), (size_t)1);
+  while (considered < cluster.size() &&
+         (uint)data_[cluster[considered]].count >= cfg::get().subcluster_min_count) {
+    ++considered;
+  }
 
-    const auto idx = cluster[i];
-    const auto& stat = data_[idx];
+  std::vector<double> transformed(considered), posteriors(considered);
+  cluster_model_.GenomicLogLikelihoods(data_, cluster.data(), considered,
+                                       transformed.data(), posteriors.data());
 
-    if ((uint)stat.count < cfg::get().subcluster_min_count && (i > 0)) {
-      break;
-    }
-
-    const double qual = cluster_model_.StatTransform(stat);
-    const double posterior = cluster_model_.GenomicLogLikelihood(stat);
+  for (size_t i = 0; i < considered; ++i) {
+    const auto idx = cluster[i];
+    const double qual = transformed[i];
+    const double posterior = posteriors[i];
 
     if (!std::isfinite(posterior)) {
       continue;
@@ -242,6 +246,7 @@ void TGenomicHKMersEstimator::ProceedCluster(std::vector<size_t>& cluster) {
     posteriorQualities.push_back(std::max(quality, -1000.0));
   }
 
+  auto& counters = counters_[omp_get_thread_num()];
   for (size_t i = 0; i < posteriorQualities.size(); ++i) {
     const auto idx = centerCandidates[i];
     data_[idx].lock();
@@ -250,16 +255,13 @@ void TGenomicHKMersEstimator::ProceedCluster(std::vector<size_t>& cluster) {
     data_[idx].dist_one_subcluster |= distOneGoodCenters[i];
     data_[idx].unlock();
     if (!wasGood && data_[idx].good()) {
-#pragma omp atomic
-      GoodKmers++;
+      counters.good_kmers++;
     }
     if (!wasGood && data_[idx].skip()) {
-#pragma omp atomic
-      SkipKmers++;
+      counters.skip_kmers++;
     }
     if (wasGood) {
-#pragma omp atomic
-      ReasignedByConsenus++;
+      counters.reassigned_by_consensus++;
     }
   }
 }
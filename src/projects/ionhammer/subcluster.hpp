@@ -30,19 +30,31 @@ class TGenomicHKMersEstimator {
   KMerData& data_;
   const n_normal_model::NormalClusterModel& cluster_model_;
   hammer_config::CenterType consensus_type_;
-  size_t GoodKmers = 0;
-  size_t SkipKmers = 0;
-  size_t ReasignedByConsenus = 0;
+
+  // Per-thread counters, padded to separate cache lines and summed up at the end
+  struct alignas(64) TCounters {
+    size_t good_kmers = 0;
+    size_t skip_kmers = 0;
+    size_t reassigned_by_consensus = 0;
+  };
+  std::vector<TCounters> counters_;
 
  public:
   TGenomicHKMersEstimator(KMerData& data, const n_normal_model::NormalClusterModel& clusterModel,
       hammer_config::CenterType consensusType = hammer_config::CenterType::CONSENSUS)
-      : data_(data), cluster_model_(clusterModel), consensus_type_(consensusType) {}
+      : data_(data), cluster_model_(clusterModel), consensus_type_(consensusType),
+        counters_(std::max((unsigned)omp_get_max_threads(), cfg::get().max_nthreads)) {}
 
   ~TGenomicHKMersEstimator() {
-    INFO("Good kmers: " << GoodKmers);
-    INFO("Perfect kmers: " << SkipKmers);
-    INFO("Reasigned by consensus: " << ReasignedByConsenus);
+    TCounters total;
+    for (const auto& counters : counters_) {
+      total.good_kmers += counters.good_kmers;
+      total.skip_kmers += counters.skip_kmers;
+      total.reassigned_by_consensus += counters.reassigned_by_consensus;
+    }
+    INFO("Good kmers: " << total.good_kmers);
+    INFO("Perfect kmers: " << total.skip_kmers);
+    INFO("Reasigned by consensus: " << total.reassigned_by_consensus);
   }
 
   // we trying to find center candidate, not error candidates.
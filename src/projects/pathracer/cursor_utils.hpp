@@ -47,8 +47,8 @@ auto vertex_cursors(const std::vector<Cursor> &cursors, typename Cursor::Context
     return result;
 }
 
-template <typename Cursor>
-auto extract_leftmost_cursors(const phmap::flat_hash_set<Cursor> &cursors, const phmap::flat_hash_set<Cursor> &vertices,
+template <typename Cursor, typename CursorSet>
+auto extract_leftmost_cursors(const CursorSet &cursors, const phmap::flat_hash_set<Cursor> &vertices,
                               typename Cursor::Context context) {
     // Exclude all trivial cursors having preceding cursor on the same edge in the input set
     std::vector<Cursor> result;
@@ -0,0 +1,253 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "cached_cursor.hpp"
+
+#include <llvm/ADT/ArrayRef.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace impl {
+
+// Map from CachedCursor to Value stored in an array addressed by cursor index
+// (the empty cursor takes slot 0). Present keys are additionally kept in a list,
+// so iteration and clearing cost is proportional to the number of entries, not
+// to the size of the graph. Storage grows on demand up to the largest index seen.
+//
+// Mimics the subset of the flat_hash_map interface used by the state sets.
+// erase() moves the last entry to the erased position, so erase-while-iterating
+// loops keep working, but the order of the entries is not preserved.
+template <typename Value>
+class DenseCursorMap {
+  static constexpr uint32_t NONE = uint32_t(-1);
+
+ public:
+  using key_type = CachedCursor;
+  using mapped_type = Value;
+  using value_type = std::pair<CachedCursor, Value>;
+
+ private:
+  using Entry = value_type;
+
+ public:
+  template <bool Const>
+  class Iterator {
+    using Map = std::conditional_t<Const, const DenseCursorMap, DenseCursorMap>;
+    using Ref = std::conditional_t<Const, const Entry &, Entry &>;
+    using Ptr = std::conditional_t<Const, const Entry *, Entry *>;
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = Entry;
+    using pointer = Ptr;
+    using reference = Ref;
+
+    Iterator(Map *map = nullptr, size_t pos = 0) : map_{map}, pos_{pos} {}
+    template <bool C = Const, typename = std::enable_if_t<!C>>
+    operator Iterator<true>() const { return {map_, pos_}; }
+
+    Ref operator*() const { return map_->slots_[map_->keys_[pos_]]; }
+    Ptr operator->() const { return &**this; }
+
+    Iterator &operator++() {
+      ++pos_;
+      return *this;
+    }
+
+    bool operator==(const Iterator &that) const { return pos_ == that.pos_; }
+    bool operator!=(const Iterator &that) const { return pos_ != that.pos_; }
+
+   private:
+    friend class DenseCursorMap;
+    Map *map_;
+    size_t pos_;
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  iterator begin() { return {this, 0}; }
+  iterator end() { return {this, keys_.size()}; }
+  const_iterator begin() const { return {this, 0}; }
+  const_iterator end() const { return {this, keys_.size()}; }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  size_t size() const { return keys_.size(); }
+  bool empty() const { return keys_.empty(); }
+
+  size_t count(const CachedCursor &cursor) const {
+    size_t s = slot(cursor);
+    return s < where_.size() && where_[s] != NONE;
+  }
+
+  iterator find(const CachedCursor &cursor) {
+    return count(cursor) ? iterator(this, where_[slot(cursor)]) : end();
+  }
+
+  const_iterator find(const CachedCursor &cursor) const {
+    return count(cursor) ? const_iterator(this, where_[slot(cursor)]) : end();
+  }
+
+  std::pair<iterator, bool> insert(const value_type &kv) {
+    size_t s = slot(kv.first);
+    bool inserted = add(s);
+    if (inserted)
+      slots_[s].second = kv.second;
+    return {iterator(this, where_[s]), inserted};
+  }
+
+  Value &operator[](const CachedCursor &cursor) {
+    size_t s = slot(cursor);
+    add(s);
+    return slots_[s].second;
+  }
+
+  iterator erase(const_iterator it) {
+    size_t pos = it.pos_;
+    uint32_t s = keys_[pos];
+    keys_[pos] = keys_.back();
+    where_[keys_[pos]] = uint32_t(pos);
+    keys_.pop_back();
+    where_[s] = NONE;
+    slots_[s].second = Value();
+    return {this, pos};
+  }
+
+  void clear() {
+    for (uint32_t s : keys_) {
+      where_[s] = NONE;
+      slots_[s].second = Value();
+    }
+    keys_.clear();
+  }
+
+ private:
+  static size_t slot(const CachedCursor &cursor) {
+    return size_t(cursor.index() + 1);  // The empty cursor wraps to zero
+  }
+
+  bool add(size_t s) {
+    if (s >= where_.size()) {
+      size_t size = std::max(2 * where_.size(), s + 1);
+      size_t old = slots_.size();
+      where_.resize(size, NONE);
+      slots_.resize(size);
+      for (size_t i = old; i < size; ++i)
+        slots_[i].first = CachedCursor(CachedCursor::Index(i - 1));
+    }
+    if (where_[s] != NONE)
+      return false;
+    where_[s] = uint32_t(keys_.size());
+    keys_.push_back(uint32_t(s));
+    return true;
+  }
+
+  std::vector<value_type> slots_;
+  std::vector<uint32_t> where_;
+  std::vector<uint32_t> keys_;
+};
+
+// Set of CachedCursors as a bitmap over cursor indices plus the list of members
+class DenseCursorSet {
+ public:
+  DenseCursorSet() = default;
+
+  template <typename Iterator>
+  DenseCursorSet(Iterator b, Iterator e) {
+    insert(b, e);
+  }
+
+  auto begin() const { return cursors_.begin(); }
+  auto end() const { return cursors_.end(); }
+  size_t size() const { return cursors_.size(); }
+  bool empty() const { return cursors_.empty(); }
+
+  size_t count(const CachedCursor &cursor) const {
+    size_t s = slot(cursor);
+    return s / 64 < bits_.size() && (bits_[s / 64] >> (s % 64) & 1);
+  }
+
+  bool insert(const CachedCursor &cursor) {
+    size_t s = slot(cursor);
+    if (s / 64 >= bits_.size())
+      bits_.resize(std::max(2 * bits_.size(), s / 64 + 1), 0);
+    uint64_t mask = uint64_t(1) << (s % 64);
+    if (bits_[s / 64] & mask)
+      return false;
+    bits_[s / 64] |= mask;
+    cursors_.push_back(cursor);
+    return true;
+  }
+
+  template <typename Iterator>
+  void insert(Iterator b, Iterator e) {
+    for (; b != e; ++b)
+      insert(*b);
+  }
+
+ private:
+  static size_t slot(const CachedCursor &cursor) {
+    return size_t(cursor.index() + 1);
+  }
+
+  std::vector<uint64_t> bits_;
+  std::vector<CachedCursor> cursors_;
+};
+
+// Successors of all the cursors of the run in compressed sparse row form
+// together with the digital codes of their letters, so transitions scan
+// contiguous arrays instead of chasing per-cursor vectors
+class CachedCursorGraph {
+ public:
+  template <typename Code>
+  CachedCursorGraph(const std::vector<CachedCursor> &cursors, CachedCursor::Context context, const Code &code) {
+    size_t n = 0;
+    for (const auto &cursor : cursors)
+      n = std::max(n, size_t(cursor.index()) + 1);
+
+    offsets_.assign(n + 1, 0);
+    codes_.assign(n, 0);
+    for (const auto &cursor : cursors) {
+      offsets_[cursor.index() + 1] = uint32_t(cursor.next(context).size());
+      codes_[cursor.index()] = uint32_t(code(cursor.letter(context)));
+    }
+    for (size_t i = 0; i < n; ++i)
+      offsets_[i + 1] += offsets_[i];
+
+    successors_.resize(offsets_[n]);
+    for (const auto &cursor : cursors) {
+      const auto &next = cursor.next(context);
+      std::copy(next.begin(), next.end(), successors_.begin() + offsets_[cursor.index()]);
+    }
+  }
+
+  llvm::ArrayRef<CachedCursor> next(const CachedCursor &cursor) const {
+    return llvm::makeArrayRef(successors_.data() + offsets_[cursor.index()],
+                              successors_.data() + offsets_[cursor.index() + 1]);
+  }
+
+  size_t code(const CachedCursor &cursor) const {
+    return codes_[cursor.index()];
+  }
+
+ private:
+  std::vector<uint32_t> offsets_;
+  std::vector<CachedCursor> successors_;
+  std::vector<uint32_t> codes_;
+};
+
+}  // namespace impl
+
+// vim: set ts=2 sw=2 et :
@@ -49,6 +49,7 @@ struct Fees {
   size_t minimal_match_length = 50;
 
   bool use_experimental_i_loop_processing = false;
+  bool use_dense_state_sets = false;
 
   double empty_sequence_score() const;
   double all_matches_score(const std::string &seq) const;
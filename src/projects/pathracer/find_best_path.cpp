@@ -45,6 +45,8 @@ PathSet<StringCursor> find_best_path(const hmm::Fees &fees, const std::vector<St
 
 PathSet<CachedCursor> find_best_path(const hmm::Fees &fees, const std::vector<CachedCursor> &initial,
                                      CachedCursor::Context context) {
+    if (fees.use_dense_state_sets)
+        return impl::find_best_path<CachedCursor, impl::DenseStateSets>(fees, initial, context);
     return impl::find_best_path(fees, initial, context);
 }
 
@@ -11,6 +11,7 @@
 #include "pathtree.hpp"
 #include "depth_filter.hpp"
 #include "cursor_utils.hpp"
+#include "dense_state_set.hpp"
 
 #include "utils/logger/logger.hpp"
 
@@ -267,9 +268,9 @@ class StateMap : public ScoresFilterMapMixin<Map> {
   const Map *crtp_this() const { return static_cast<const Map *>(this); }
 };
 
-template <typename GraphCursor>
-class DeletionStateSet : public phmap::flat_hash_map<GraphCursor, ScoredPLink<GraphCursor>>,
-                         public StateMap<DeletionStateSet<GraphCursor>> {
+template <typename GraphCursor, typename Base = phmap::flat_hash_map<GraphCursor, ScoredPLink<GraphCursor>>>
+class DeletionStateSet : public Base,
+                         public StateMap<DeletionStateSet<GraphCursor, Base>> {
  public:
   template <typename KV>
   static State<GraphCursor> kv2state(const KV &kv) {
@@ -322,9 +323,9 @@ class DeletionStateSet : public phmap::flat_hash_map<GraphCursor, ScoredPLink<Gr
   }
 };
 
-template <typename GraphCursor>
-class StateSet : public phmap::flat_hash_map<GraphCursor, PathLinkRef<GraphCursor>>,
-                 public StateMap<StateSet<GraphCursor>> {
+template <typename GraphCursor, typename Base = phmap::flat_hash_map<GraphCursor, PathLinkRef<GraphCursor>>>
+class StateSet : public Base,
+                 public StateMap<StateSet<GraphCursor, Base>> {
  public:
   bool equal(const StateSet &S) const {
     if (this->size() != S.size()) {
@@ -440,13 +441,51 @@ class StateSet : public phmap::flat_hash_map<GraphCursor, PathLinkRef<GraphCurso
 
 };
 
+// State sets keyed by arbitrary cursors, successors and letters are taken
+// from the cursors themselves
 template <typename GraphCursor>
+struct HashStateSets {
+  using StateSet = impl::StateSet<GraphCursor>;
+  using DeletionStateSet = impl::DeletionStateSet<GraphCursor>;
+  using CursorSet = phmap::flat_hash_set<GraphCursor>;
+
+  class Graph {
+   public:
+    Graph(const std::vector<GraphCursor> &, typename GraphCursor::Context context, const hmm::DigitalCodind &code)
+        : context_{context}, code_{code} {}
+
+    decltype(auto) next(const GraphCursor &cursor) const { return cursor.next(context_); }
+    size_t code(const GraphCursor &cursor) const { return code_(cursor.letter(context_)); }
+
+   private:
+    typename GraphCursor::Context context_;
+    const hmm::DigitalCodind &code_;
+  };
+};
+
+// State sets stored in dense arrays addressed by cached cursor indices with
+// the successors of all the cursors precomputed in CSR form. Every set (and
+// every copy of it) takes memory proportional to the largest cursor index, so
+// these pay off only when the frontier is a noticeable part of the graph.
+struct DenseStateSets {
+  using StateSet = impl::StateSet<CachedCursor, DenseCursorMap<PathLinkRef<CachedCursor>>>;
+  using DeletionStateSet = impl::DeletionStateSet<CachedCursor, DenseCursorMap<ScoredPLink<CachedCursor>>>;
+  using CursorSet = DenseCursorSet;
+  using Graph = CachedCursorGraph;
+};
+
+template <typename GraphCursor, typename StateSets = HashStateSets<GraphCursor>>
 PathSet<GraphCursor> find_best_path(const hmm::Fees &fees,
                                     const std::vector<GraphCursor> &cursors,
                                     typename GraphCursor::Context context) {
-  using StateSet = StateSet<GraphCursor>;
-  using DeletionStateSet = DeletionStateSet<GraphCursor>;
-  const auto &code = fees.code;
+  using StateSet = typename StateSets::StateSet;
+  using DeletionStateSet = typename StateSets::DeletionStateSet;
+  using CursorSet = typename StateSets::CursorSet;
+  const typename StateSets::Graph graph(cursors, context, fees.code);
+
+  // All the links of the run live in its own arena, released together with the result
+  auto arena = std::make_shared<pathtree::PathLinkArena>();
+  pathtree::PathLinkArena::Scope arena_scope(arena.get());
 
   INFO("pHMM size: " << fees.M);
   if (!fees.check_i_loop(0)) {
@@ -475,14 +514,17 @@ PathSet<GraphCursor> find_best_path(const hmm::Fees &fees,
 
   std::vector<GraphCursor> initial;
 
-  auto transfer = [&code, &initial, context](StateSet &to, const auto &from, double transfer_fee,
-                                             const std::vector<double> &emission_fees) {
+  auto transfer = [&graph, &initial](StateSet &to, const auto &from, double transfer_fee,
+                                     const std::vector<double> &emission_fees) {
     DEBUG_ASSERT((void*)(&to) != (void*)(&from), hmmpath_assert{});
     for (const auto &state : from.states()) {
-      for (const auto &next : (state.cursor.is_empty() ? initial : state.cursor.next(context))) {
-        double cost = state.score + transfer_fee + emission_fees[code(next.letter(context))];
-        to.update(next, cost, state.plink);
-      }
+      auto relax = [&](const auto &nexts) {
+        for (const auto &next : nexts) {
+          double cost = state.score + transfer_fee + emission_fees[graph.code(next)];
+          to.update(next, cost, state.plink);
+        }
+      };
+      state.cursor.is_empty() ? relax(initial) : relax(graph.next(state.cursor));
     }
   };
 
@@ -497,14 +539,14 @@ PathSet<GraphCursor> find_best_path(const hmm::Fees &fees,
     }
   };
 
-  auto loop_transfer_ff= [&code, context, &fees, &depth, &vcursors](StateSet &I, double transfer_fee,
-                                                                    const std::vector<double> &emission_fees,
-                                                                    const phmap::flat_hash_set<GraphCursor> &keys) {
+  auto loop_transfer_ff= [&graph, context, &fees, &depth, &vcursors](StateSet &I, double transfer_fee,
+                                                                     const std::vector<double> &emission_fees,
+                                                                     const CursorSet &keys) {
     DEBUG("loop_transfer_ff begins");
     StateSet Inext;
     std::vector<GraphCursor> updated_vertices;
     std::vector<GraphCursor> updated_nonvertices;
-    phmap::flat_hash_set<GraphCursor> relaxed;
+    CursorSet relaxed;
 
     std::vector<GraphCursor> stack = extract_leftmost_cursors(keys, vcursors, context);
     while (!stack.empty()) {
@@ -515,8 +557,8 @@ PathSet<GraphCursor> find_best_path(const hmm::Fees &fees,
       relaxed.insert(cursor);
 
       double required_cursor_depth = static_cast<double>(fees.minimal_match_length) - static_cast<double>(plink->max_prefix_size());
-      for (const auto &next : cursor.next(context)) {
-        double cost = plink->score() + transfer_fee + emission_fees[code(next.letter(context))];
+      for (const auto &next : graph.next(cursor)) {
+        double cost = plink->score() + transfer_fee + emission_fees[graph.code(next)];
         if (!vcursors.count(next)) {
           VERIFY(next.prev(context).size() == 1 && next.next(context).size() == 1);
           DEBUG("FAST FORWARD");
@@ -567,7 +609,7 @@ PathSet<GraphCursor> find_best_path(const hmm::Fees &fees,
       I[cursor] = std::move(plink);
     }
 
-    phmap::flat_hash_set<GraphCursor> updated;
+    CursorSet updated;
     updated.insert(updated_vertices.cbegin(), updated_vertices.cend());
     updated.insert(updated_nonvertices.cbegin(), updated_nonvertices.cend());
 
@@ -608,17 +650,17 @@ PathSet<GraphCursor> find_best_path(const hmm::Fees &fees,
   //   return updated;
   // };
 
-  auto loop_transfer_negative = [&code, context, &fees, &depth](StateSet &I, double transfer_fee,
-                                                                const std::vector<double> &emission_fees,
-                                                                const auto &keys,
-                                                                bool just_all = false) {
+  auto loop_transfer_negative = [&graph, context, &fees, &depth](StateSet &I, double transfer_fee,
+                                                                 const std::vector<double> &emission_fees,
+                                                                 const auto &keys,
+                                                                 bool just_all = false) {
     StateSet Inext;
     std::vector<GraphCursor> updated;
     auto process = [&](const auto &collection) -> void {
       for (const auto &state : collection) {
         double required_cursor_depth = static_cast<double>(fees.minimal_match_length) - static_cast<double>(state.plink->max_prefix_size());
-        for (const auto &next : state.cursor.next(context)) {
-          double cost = state.score + transfer_fee + emission_fees[code(next.letter(context))];
+        for (const auto &next : graph.next(state.cursor)) {
+          double cost = state.score + transfer_fee + emission_fees[graph.code(next)];
           if (cost > fees.absolute_threshold) continue;
           if (!depth.depth_at_least(next, required_cursor_depth, context)) continue;
           Inext.update(next, cost, state.plink);
@@ -641,7 +683,7 @@ PathSet<GraphCursor> find_best_path(const hmm::Fees &fees,
   };
 
   auto i_loop_processing_ff_simple = [&loop_transfer_ff, &fees](StateSet &I, size_t m) {
-    phmap::flat_hash_set<GraphCursor> updated;
+    CursorSet updated;
     for (const auto &kv : I) {
       updated.insert(kv.first);
     }
@@ -878,13 +920,14 @@ PathSet<GraphCursor> find_best_path(const hmm::Fees &fees,
   update_sink(M, fees.t[fees.M][p7H_MM]);
   sink->collapse_and_trim();
 
-  DEBUG(sink->object_count_current() << " pathlink objects");
-  DEBUG(sink->object_count_max() << " pathlink objects maximum");
-  DEBUG(sink->object_count_constructed() << " pathlink objects constructed");
+  DEBUG(arena->links_current() << " pathlink objects");
+  DEBUG(arena->links_max() << " pathlink objects maximum");
+  DEBUG(arena->links_constructed() << " pathlink objects constructed");
+  DEBUG(arena->peak_allocated() << " bytes allocated in pathlink arena at peak");
 
   INFO("Sink size: " << sink->size());
 
-  PathSet<GraphCursor> result(sink);
+  PathSet<GraphCursor> result(sink, arena);
   return result;
 }
 
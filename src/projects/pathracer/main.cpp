@@ -105,6 +105,7 @@ struct PathracerConfig {
     bool disable_depth_filter = false;
     size_t memory = 100;  // 100GB
     int use_experimental_i_loop_processing = true;
+    bool use_dense_state_sets = false;
     std::string known_sequences = "";
     bool export_event_graph = false;
     double minimal_match_length = 0.9;
@@ -192,12 +193,13 @@ void process_cmdline(int argc, char **argv, PathracerConfig &cfg) {
           (option("--F3") & number("value", cfg.hcfg.F3)) % "Stage 3 (Fwd) threshold: promote hits w/ P <= F3"
       ),
       "Developer options:" % (
-          cfg.parallel_component_processing << option("--parallel-components") % "process connected components of neighborhood subgraph in parallel [default: false]",
+          cfg.parallel_component_processing << option("--parallel-components") % "process connected components of neighborhood subgraph in parallel, lets idle threads help with the remaining heavy HMMs [default: false]",
           (option("--max-insertion-length") & integer("x", cfg.max_insertion_length)) % "maximal allowed number of successive I-emissions [default: 30]",
           (option("--expand-coef") & number("value", cfg.expand_coef)) % "overhang expansion coefficient for neighborhood search [default: 2]",
           (option("--expand-const") & integer("value", cfg.expand_const)) % "const addition to overhang values for neighborhood search [default: 20]",
           (option("--no-top-score-filter").set(cfg.state_limits_coef, size_t(100500))) % "disable top score Event Graph vertices filter [default: false]",
           option("--no-fast-forward").set(cfg.use_experimental_i_loop_processing, 0) % "disable fast forward in I-loops processing [default: false]",
+          option("--dense-states").set(cfg.use_dense_state_sets, true) % "keep DP states in dense arrays over cursor indices instead of hash maps, faster for small graphs with large frontiers [default: false]",
           // cfg.disable_depth_filter << option("--disable-depth-filter") % "disable depth filter",  // TODO restore this option
           (option("--known-sequences") & value("filename", cfg.known_sequences)) % "FASTA file with known sequnces that should be definitely found",
           cfg.export_event_graph << option("--export-event-graph") % "export event graph in binary format"
@@ -764,6 +766,7 @@ void TraceHMM(const hmmer::HMM &hmm,
     fees.max_insertion_length = cfg.max_insertion_length;
     fees.local = cfg.local;
     fees.use_experimental_i_loop_processing = cfg.use_experimental_i_loop_processing;
+    fees.use_dense_state_sets = cfg.use_dense_state_sets;
     fees.frame_shift_cost = fees.all_matches_score() / static_cast<double>(fees.M) / cfg.indel_rate / 3;
     if (cfg.indel_rate > 0.0 && fees.minimal_match_length) {
         WARN("Current depth filter implementation does not support alignment with frame shifts! minimal_match_length will be set to 0");
@@ -976,8 +979,9 @@ void TraceHMM(const hmmer::HMM &hmm,
     }
     remove_duplicates(match_edges);
 
-    auto process_component = [&hmm, &run_search, &cfg, &results, &graph](const auto &component_cursors,
-                                                                         const std::string &component_name = "") -> std::unordered_set<std::vector<EdgeId>> {
+    auto process_component = [&hmm, &run_search, &cfg, &graph](const auto &component_cursors,
+                                                               std::vector<HMMPathInfo> &local_results,
+                                                               const std::string &component_name = "") -> std::unordered_set<std::vector<EdgeId>> {
         assert(!component_cursors.empty());
         INFO("Component size " << component_cursors.size());
 
@@ -1001,7 +1005,6 @@ void TraceHMM(const hmmer::HMM &hmm,
         DEBUG("Edges: " << edges);
 
         INFO("Running path search");
-        std::vector<HMMPathInfo> local_results;
         std::unordered_set<GraphCursor> component_set(component_cursors.cbegin(), component_cursors.cend());
         auto restricted_context = make_optimized_restricted_cursor_context(component_set, &graph);
         auto restricted_component_cursors = make_optimized_restricted_cursors(component_cursors);
@@ -1023,8 +1026,6 @@ void TraceHMM(const hmmer::HMM &hmm,
             run_search(ccc, restricted_component_cursors, &restricted_context, cfg.top, local_results, component_name);
         }
 
-        results.insert(results.end(), local_results.begin(), local_results.end());
-
         std::unordered_set<std::vector<EdgeId>> paths;
         for (const auto& entry : local_results) {
             paths.insert(entry.path);
@@ -1033,11 +1034,28 @@ void TraceHMM(const hmmer::HMM &hmm,
     };
 
 
-    //#pragma omp parallel for schedule(dynamic)
+    // Components are processed as tasks, so the components of a single huge
+    // HMM could be picked up by threads idle in the outer loop over HMMs.
+    // Without --parallel-components the whole neighborhood is a single
+    // component and the HMM is processed by one thread.
+    // Results are merged in component order regardless of the schedule.
+    std::vector<std::vector<HMMPathInfo>> component_results(cursor_conn_comps.size());
+    std::vector<std::unordered_set<std::vector<EdgeId>>> component_paths(cursor_conn_comps.size());
+    for (size_t i = 0; i < cursor_conn_comps.size(); ++i) {
+        #pragma omp task default(none) firstprivate(i) shared(cursor_conn_comps, component_names, component_results, component_paths, process_component) if(cursor_conn_comps.size() > 1)
+        {
+            const std::string &component_name = component_names.size() ? component_names[i] : "";
+            component_paths[i] = process_component(cursor_conn_comps[i], component_results[i], component_name);
+        }
+    }
+    #pragma omp taskwait
+
     for (size_t i = 0; i < cursor_conn_comps.size(); ++i) {
         const auto &component_cursors = cursor_conn_comps[i];
         const std::string &component_name = component_names.size() ? component_names[i] : "";
-        auto paths = process_component(component_cursors, component_name);
+        const auto &paths = component_paths[i];
+        results.insert(results.end(),
+                       std::make_move_iterator(component_results[i].begin()), std::make_move_iterator(component_results[i].end()));
 
         INFO("Total " << paths.size() << " unique edge paths extracted");
         // size_t count = 0;  // FIXME this ad-hoc
@@ -1088,10 +1106,14 @@ void hmm_main(const PathracerConfig &cfg,
                    hmms.end());
     }
 
-    // Outer loop: over each query HMM in <hmmfile>.
+    // Outer loop: over each query HMM in <hmmfile>. Every HMM is a task, the
+    // connected components inside are nested tasks (see TraceHMM)
     omp_set_num_threads(cfg.threads);
-    #pragma omp parallel for schedule(guided)
-    for (size_t _i = 0; _i < hmms.size(); ++_i) {
+    #pragma omp parallel
+    #pragma omp single
+    for (size_t _i = 0; _i < hmms.size(); ++_i)
+    #pragma omp task default(shared) firstprivate(_i)
+    {
         const auto &hmm = hmms[_i];
 
         std::vector<HMMPathInfo> results;
@@ -0,0 +1,196 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+namespace pathtree {
+
+// Memory arena for the event graph built by a single HMM run. Blocks are carved
+// from large chunks and recycled through per-size free lists, so the millions of
+// short-lived links created and dropped during the run never hit the global
+// allocator. All the memory is returned at once when the arena is destroyed.
+//
+// The arena is not thread-safe: it is owned by the run (and then by the
+// resulting PathSet) and used by one thread at a time.
+class PathLinkArena {
+  struct FreeBlock {
+    FreeBlock *next;
+  };
+
+  static constexpr size_t GRANULARITY = 16;
+  static constexpr size_t SMALL_CLASSES = 32;   // 16..512 bytes with 16 bytes step
+  static constexpr size_t LARGE_CLASSES = 7;    // 1K..64K, powers of two
+  static constexpr size_t MAX_BLOCK = size_t(512) << LARGE_CLASSES;
+  static constexpr size_t CHUNK_SIZE = size_t(1) << 20;
+
+ public:
+  PathLinkArena() : free_(SMALL_CLASSES + LARGE_CLASSES, nullptr) {}
+  PathLinkArena(const PathLinkArena &) = delete;
+  PathLinkArena &operator=(const PathLinkArena &) = delete;
+
+  ~PathLinkArena() {
+    for (void *p : chunks_)
+      ::operator delete(p);
+    for (void *p : large_)
+      ::operator delete(p);
+  }
+
+  void *allocate(size_t size) {
+    allocated_ += size;
+    peak_allocated_ = std::max(peak_allocated_, allocated_);
+
+    if (size > MAX_BLOCK) {
+      void *p = ::operator new(size);
+      large_.insert(p);
+      return p;
+    }
+
+    size_t cls = size_class(size);
+    if (FreeBlock *b = free_[cls]) {
+      free_[cls] = b->next;
+      return b;
+    }
+
+    size_t bytes = block_size(cls);
+    if (size_t(end_ - cur_) < bytes) {
+      size_t chunk = std::max(CHUNK_SIZE, bytes);
+      cur_ = static_cast<char*>(::operator new(chunk));
+      end_ = cur_ + chunk;
+      chunks_.push_back(cur_);
+    }
+    void *p = cur_;
+    cur_ += bytes;
+    return p;
+  }
+
+  void deallocate(void *p, size_t size) {
+    if (releasing_)
+      return;
+
+    allocated_ -= size;
+    if (size > MAX_BLOCK) {
+      large_.erase(p);
+      ::operator delete(p);
+      return;
+    }
+
+    size_t cls = size_class(size);
+    FreeBlock *b = static_cast<FreeBlock*>(p);
+    b->next = free_[cls];
+    free_[cls] = b;
+  }
+
+  // After this call freed blocks are not recycled anymore, the memory is
+  // dropped together with the arena. Must be called by its last owner only
+  void release_all() { releasing_ = true; }
+
+  void link_constructed() {
+    ++links_constructed_;
+    ++links_current_;
+    links_max_ = std::max(links_max_, links_current_);
+  }
+  void link_destroyed() { --links_current_; }
+
+  size_t links_constructed() const { return links_constructed_; }
+  size_t links_current() const { return links_current_; }
+  size_t links_max() const { return links_max_; }
+  size_t peak_allocated() const { return peak_allocated_; }
+  size_t reserved() const { return chunks_.size() * CHUNK_SIZE; }
+
+  // Arena used for the links created by the current thread, if any
+  static PathLinkArena *&current() {
+    static thread_local PathLinkArena *arena = nullptr;
+    return arena;
+  }
+
+  class Scope {
+   public:
+    explicit Scope(PathLinkArena *arena) : prev_(current()) { current() = arena; }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+    ~Scope() { current() = prev_; }
+
+   private:
+    PathLinkArena *prev_;
+  };
+
+ private:
+  static size_t size_class(size_t size) {
+    if (size <= SMALL_CLASSES * GRANULARITY)
+      return size ? (size - 1) / GRANULARITY : 0;
+    size_t cls = SMALL_CLASSES;
+    for (size_t bytes = 2 * SMALL_CLASSES * GRANULARITY; bytes < size; bytes *= 2)
+      ++cls;
+    return cls;
+  }
+
+  static size_t block_size(size_t cls) {
+    return cls < SMALL_CLASSES ? (cls + 1) * GRANULARITY
+                               : (2 * SMALL_CLASSES * GRANULARITY) << (cls - SMALL_CLASSES);
+  }
+
+  std::vector<FreeBlock*> free_;
+  std::vector<char*> chunks_;
+  std::unordered_set<void*> large_;
+  char *cur_ = nullptr;
+  char *end_ = nullptr;
+  bool releasing_ = false;
+
+  size_t allocated_ = 0;
+  size_t peak_allocated_ = 0;
+  size_t links_constructed_ = 0;
+  size_t links_current_ = 0;
+  size_t links_max_ = 0;
+};
+
+// STL allocator on top of the arena, falls back to the global heap for
+// containers created outside of any arena
+template <class T>
+class PathLinkArenaAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  PathLinkArenaAllocator(PathLinkArena *arena = nullptr) noexcept : arena_(arena) {}
+  template <class U>
+  PathLinkArenaAllocator(const PathLinkArenaAllocator<U> &other) noexcept : arena_(other.arena()) {}
+
+  T *allocate(size_t n) {
+    size_t size = n * sizeof(T);
+    return static_cast<T*>(arena_ ? arena_->allocate(size) : ::operator new(size));
+  }
+
+  void deallocate(T *p, size_t n) noexcept {
+    if (arena_)
+      arena_->deallocate(p, n * sizeof(T));
+    else
+      ::operator delete(p);
+  }
+
+  PathLinkArena *arena() const { return arena_; }
+
+  template <class U>
+  bool operator==(const PathLinkArenaAllocator<U> &other) const { return arena_ == other.arena(); }
+  template <class U>
+  bool operator!=(const PathLinkArenaAllocator<U> &other) const { return arena_ != other.arena(); }
+
+ private:
+  PathLinkArena *arena_;
+};
+
+}  // namespace pathtree
+
+// vim: set ts=2 sw=2 et :
@@ -9,7 +9,7 @@
 
 #include "pathtrie.hpp"
 #include "trie.hpp"
-#include "object_counter.hpp"
+#include "pathlink_arena.hpp"
 
 #include "utils/logger/logger.hpp"
 #include "io/binary/binary.hpp"
@@ -192,17 +192,49 @@ struct AnnotatedPath {
 };
 
 template <typename GraphCursor>
-class PathLink : public llvm::RefCountedBase<PathLink<GraphCursor>>,
-                 public AtomicObjectCounter<PathLink<GraphCursor>> {
+class PathLink {
   using This = PathLink<GraphCursor>;
   using ThisRef = llvm::IntrusiveRefCntPtr<This>;
+  using Scores = std::vector<std::pair<double, ThisRef>, PathLinkArenaAllocator<std::pair<double, ThisRef>>>;
 
   // Make it private
   void* operator new (size_t sz) {
       return ::operator new(sz);
   }
+  void* operator new (size_t, void *p) {
+      return p;
+  }
+
+  // Copies start with no references
+  struct RefCount {
+    unsigned count = 0;
+    RefCount() = default;
+    RefCount(const RefCount &) {}
+    RefCount &operator=(const RefCount &) { return *this; }
+  };
 
 public:
+  // Links are owned by a single thread during the run, so the reference
+  // count is a plain integer. Arena-backed links go back to their arena.
+  // They are always destroyed, so the links they refer to (possibly on the
+  // heap or in another arena) are released as well.
+  void Retain() const { ++refs_.count; }
+
+  void Release() const {
+    DEBUG_ASSERT(refs_.count > 0, pathtree_assert{});
+    if (--refs_.count)
+      return;
+
+    PathLinkArena *arena = arena_;
+    if (!arena) {
+      delete this;
+      return;
+    }
+    This *p = const_cast<This*>(this);
+    p->~This();
+    arena->deallocate(p, sizeof(This));
+  }
+
   double score() const {
     return score_;
   }
@@ -233,8 +265,23 @@ public:
     return scores_.empty();
   }
 
-  PathLink(const GraphCursor &cursor = GraphCursor()) : score_{std::numeric_limits<score_t>::infinity()}, cursor_{cursor} {
+  PathLink(const GraphCursor &cursor = GraphCursor(), PathLinkArena *arena = nullptr)
+      : scores_(arena), score_{std::numeric_limits<score_t>::infinity()}, cursor_{cursor}, arena_{arena} {
     scores_.reserve(8);
+    if (arena_)
+      arena_->link_constructed();
+  }
+
+  PathLink(const PathLink &other)
+      : refs_(other.refs_), scores_(other.scores_), score_{other.score_}, cursor_{other.cursor_},
+        event_{other.event_}, max_prefix_size_{other.max_prefix_size_}, arena_{other.arena_} {
+    if (arena_)
+      arena_->link_constructed();
+  }
+
+  ~PathLink() {
+    if (arena_)
+      arena_->link_destroyed();
   }
 
   const GraphCursor &cursor() const {
@@ -248,21 +295,21 @@ public:
   }
 
 
-  static void collapse_scores_left(std::vector<std::pair<double, ThisRef>> &scores) {
+  static void collapse_scores_left(Scores &scores) {
     sort_by(scores.begin(), scores.end(), [](const auto &p) { return std::make_tuple(triplet_form(p.second->cursor()), p.first); }); // TODO prefer matchs to insertions in case of eveness
     auto it = unique_copy_by(scores.cbegin(), scores.cend(), scores.begin(),
                              [](const auto &p){ return triplet_form(p.second->cursor()); });
     scores.resize(std::distance(scores.begin(), it));
   }
 
-  static void trim_scores_left_to_one(std::vector<std::pair<double, ThisRef>> &scores) {
+  static void trim_scores_left_to_one(Scores &scores) {
     sort_by(scores.begin(), scores.end(), [](const auto &p) { return p.first; });
     if (scores.size() > 1) {
       scores.resize(1);
     }
   }
 
-  static void trim_scores_left(std::vector<std::pair<double, ThisRef>> &scores) {
+  static void trim_scores_left(Scores &scores) {
     sort_by(scores.begin(), scores.end(), [](const auto &p) { return p.first; });
 
     for (size_t i = 0; i < scores.size(); ++i) {
@@ -325,8 +372,19 @@ public:
     }
   }
 
-  static ThisRef create(const GraphCursor &cursor) { return new This(cursor); }
-  ThisRef clone() const { return new This(*this); }
+  // Links are allocated from the arena of the current run, if any
+  static ThisRef create(const GraphCursor &cursor) {
+    PathLinkArena *arena = PathLinkArena::current();
+    if (!arena)
+      return new This(cursor);
+    return new (arena->allocate(sizeof(This))) This(cursor, arena);
+  }
+
+  ThisRef clone() const {
+    if (!arena_)
+      return new This(*this);
+    return new (arena_->allocate(sizeof(This))) This(*this);
+  }
 
   static ThisRef create_sink() {
     return create(GraphCursor());
@@ -576,11 +634,13 @@ public:
 private:
   // std::unordered_map<GraphCursor, std::pair<double, ThisRef>> scores_;
   // std::vector<std::pair<GraphCursor, std::pair<double, ThisRef>>> scores_;
-  std::vector<std::pair<double, ThisRef>> scores_;
+  mutable RefCount refs_;
+  Scores scores_;
   score_t score_;
   GraphCursor cursor_;
   Event event_;
   size_t max_prefix_size_ = 0;
+  PathLinkArena *arena_;
 
   void update_score() {
     if (!scores_.empty()) {
@@ -636,31 +696,55 @@ class PathSet {
     std::vector<AnnotatedPath<GraphCursor>> paths_;
   };
 
-  PathSet(const PathLinkRef<GraphCursor> &pathlink) : pathlink_{pathlink} {}
+  PathSet(const PathLinkRef<GraphCursor> &pathlink,
+          std::shared_ptr<PathLinkArena> arena = nullptr)
+      : graph_{std::make_shared<EventGraph>(pathlink, std::move(arena))} {}
 
-  double best_score() const { return -pathlink_->score(); }  // FIXME sign
+  double best_score() const { return -pathlink()->score(); }  // FIXME sign
   // AnnotatedPath<GraphCursor> best_path(typename GraphCursor::Context context) const { return top_k(context, 1, -std::numeric_limits<double>::infinity())[0]; }
   // std::string best_path_string() const { return path_container::str(best_path().path); }
 
   path_container top_k(typename GraphCursor::Context context,
                        size_t k,
-                       double min_score = 0) const { return path_container(pathlink_, context, k, min_score); }
+                       double min_score = 0) const { return path_container(graph_->pathlink, context, k, min_score); }
 
   const PathLink<GraphCursor> *pathlink() const {
-    return pathlink_.get();
+    return graph_->pathlink.get();
   }
 
   PathLinkRef<GraphCursor> pathlink_mutable() {
-    return pathlink_;
+    return graph_->pathlink;
   }
 
   template <class Archive>
   void BinArchive(Archive &ar) {
-    ar(pathlink_);
+    ar(graph_->pathlink);
   }
   
  private:
-  PathLinkRef<GraphCursor> pathlink_;
+  // Copies of the set share the event graph, so the links are released
+  // strictly before the arena they live in, whatever the copies and
+  // assignments are. The last owner drops the whole graph at once.
+  struct EventGraph {
+    EventGraph(const PathLinkRef<GraphCursor> &pathlink, std::shared_ptr<PathLinkArena> arena)
+        : arena{std::move(arena)}, pathlink{pathlink} {}
+    EventGraph(const EventGraph &) = delete;
+    EventGraph &operator=(const EventGraph &) = delete;
+
+    ~EventGraph() {
+      // Other graphs may live in the same arena, only the last owner may
+      // stop recycling its memory
+      if (arena && arena.use_count() == 1)
+        arena->release_all();
+      pathlink.reset();
+    }
+
+    // Must outlive the links
+    std::shared_ptr<PathLinkArena> arena;
+    PathLinkRef<GraphCursor> pathlink;
+  };
+
+  std::shared_ptr<EventGraph> graph_;
 };
 
 }  // namespace pathtree
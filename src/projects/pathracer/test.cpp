@@ -44,3 +44,98 @@ TEST(LevenshteinNonZero, LEVENSHTEIN_SUBSTRING) {
   EXPECT_DOUBLE_EQ(levenshtein_substring_score("ATA", "TA"), 0);
   EXPECT_DOUBLE_EQ(levenshtein_substring_score("", "AA"), 2);
 }
+
+double cached_substring_score(const std::string &s, const std::string &query, bool dense, bool fast_forward) {
+  auto fees = hmm::levenshtein_fees(query);
+  fees.minimal_match_length = 0;
+  fees.use_dense_state_sets = dense;
+  fees.use_experimental_i_loop_processing = fast_forward;
+  std::vector<StringCursor> cursors;
+  for (size_t i = 0; i < s.length(); ++i) {
+    cursors.emplace_back(i);
+  }
+  CachedCursorContext ccc(cursors, &s);
+  return -find_best_path(fees, ccc.Cursors(), &ccc).best_score();
+}
+
+TEST(LevenshteinDenseStates, LEVENSHTEIN_SUBSTRING) {
+  const std::vector<std::pair<std::string, std::string>> cases = {
+    {"AAAAACGTAAAAAAACGT", "CGT"},
+    {"TTTTTTTTTTTTTAAAAACGTAAAAAAACGTTTTTTTTTTTTCCCCT", "AAAAACGTAAAAAAACGT"},
+    {"AAAAAAAAACGGGGGGGCCCCCAAAAAAGGGGGGCCCCGGG", "T"},
+    {"ACGTACGTTGCAACGGTACGATCGATCGGATCCGTAGCTAGCTAGGCTAGCA", "CGATCGGTTCCGTAG"},
+    {"AT", "TA"}
+  };
+  for (const auto &c : cases) {
+    for (bool fast_forward : {false, true}) {
+      double hash_score = cached_substring_score(c.first, c.second, false, fast_forward);
+      EXPECT_DOUBLE_EQ(cached_substring_score(c.first, c.second, true, fast_forward), hash_score);
+      EXPECT_DOUBLE_EQ(hash_score, levenshtein_substring_score(c.first, c.second));
+    }
+  }
+}
+
+TEST(PathSetSharedArena, PATHSET) {
+  using Link = pathtree::PathLink<StringCursor>;
+  const std::string s = "ACGT";
+
+  // Sets sharing one arena, the arena is owned by the sets only
+  std::vector<PathSet<StringCursor>> sets;
+  pathtree::PathLinkArena *shared_arena;
+  {
+    auto arena = std::make_shared<pathtree::PathLinkArena>();
+    shared_arena = arena.get();
+    pathtree::PathLinkArena::Scope scope(arena.get());
+    for (size_t i = 0; i < s.size(); ++i) {
+      auto source = Link::create_source();
+      auto link = Link::create(StringCursor(i));
+      link->update(-double(i), source);
+      auto sink = Link::create_sink();
+      sink->update(-double(i), link);
+      sets.emplace_back(sink, arena);
+    }
+  }
+
+  auto check = [&](const PathSet<StringCursor> &set, size_t i) {
+    EXPECT_DOUBLE_EQ(double(i), set.best_score());
+    auto paths = set.top_k(&s, 1, -1);
+    ASSERT_EQ(1u, paths.size());
+    EXPECT_EQ(s.substr(i, 1), paths.str(0, &s));
+  };
+
+  PathSet<StringCursor> copy = sets[0];
+  copy = sets[1];
+  sets[1] = sets[2];
+  sets[2] = std::move(copy);
+  sets[0] = sets[0];
+  check(sets[0], 0);
+  check(sets[1], 2);
+  check(sets[2], 1);
+
+  // Dropping the sets one by one keeps the rest intact and destroys the
+  // links of the dropped set
+  size_t links = shared_arena->links_current();
+  sets.erase(sets.begin());
+  check(sets[0], 2);
+  EXPECT_EQ(links - 3, shared_arena->links_current());
+  sets[0] = PathSet<StringCursor>(sets[2]);
+  sets.pop_back();
+  check(sets[0], 3);
+  check(sets[1], 1);
+  sets[1] = std::move(sets[0]);
+  check(sets[1], 3);
+
+  // Results of separate runs
+  auto fees = hmm::levenshtein_fees("CGT");
+  fees.minimal_match_length = 0;
+  const std::string t = "AAAAACGTAAAAAAACGT";
+  std::vector<StringCursor> cursors;
+  for (size_t i = 0; i < t.length(); ++i)
+    cursors.emplace_back(i);
+  PathSet<StringCursor> first = find_best_path(fees, cursors, &t);
+  PathSet<StringCursor> second = find_best_path(fees, cursors, &t);
+  first = second;
+  second = std::move(sets[1]);
+  EXPECT_DOUBLE_EQ(0, first.best_score());
+  check(second, 3);
+}
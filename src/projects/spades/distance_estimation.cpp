@@ -8,6 +8,7 @@
 
 #include "distance_estimation.hpp"
 
+#include "paired_info/compressed_paired_info.hpp"
 #include "paired_info/distance_estimation_utils.hpp"
 
 #include "configs/distance_estimation.hpp"
@@ -47,6 +48,14 @@ void DistanceEstimation::run(graph_pack::GraphPack &gp, const char*) {
                                              config.ade, config.de);
         }
 
+        if (config.developer_mode) {
+            // Check the read-only packed representation against the raw index
+            CompressedUnclusteredPairedInfoIndexT<Graph> compressed(paired_indices[i]);
+            VERIFY_MSG(compressed.Matches(paired_indices[i]), "Packed paired index differs from the raw one");
+            INFO("Raw paired index of " << paired_indices[i].size() << " points takes "
+                 << (compressed.mem_size() >> 20) << " MB packed");
+        }
+
         if (!cfg::get().preserve_raw_paired_index) {
             INFO("Clearing raw paired index");
             paired_indices[i].clear();
@@ -14,6 +14,7 @@
 #include "modules/simplification/compressor.hpp"
 #include "paired_info/concurrent_pair_info_buffer.hpp"
 #include "pipeline/sequence_mapper_gp_api.hpp"
+#include "sequence/suffix_prefix_hamming.hpp"
 
 #include <parallel_hashmap/phmap.h>
 #include <parallel_hashmap/btree.h>
@@ -183,18 +184,6 @@ class GapCloser {
         return answer;
     }
 
-    size_t LimitedHammingDistance(const Sequence &s1, const Sequence &s2, size_t bound) const {
-        VERIFY(s1.size() == s2.size());
-        size_t dist = 0;
-        for (size_t i = 0; i < s1.size(); ++i) {
-            dist += (s1[i] != s2[i]);
-            if (dist > bound)
-                return dist;
-        }
-
-        return dist;
-    }
-
     std::vector<size_t> PosThatCanCorrect(size_t overlap_length/*in nucls*/, const MismatchPos &mismatch_pos,
                                           size_t edge_length/*in nucls*/, bool left_edge) const {
         TRACE("Try correct left edge " << left_edge);
@@ -312,10 +301,11 @@ class GapCloser {
 
         Sequence seq1 = g_.EdgeNucls(first), seq2 = g_.EdgeNucls(second);
         TRACE("Checking possible gaps from 1 to " << k_ - min_intersection_);
+        // Ends are packed once, distances for all gaps are word-parallel
+        SuffixPrefixHamming hamming(seq1, seq2, k_ - 1);
         for (int gap = 1; gap <= k_ - (int) min_intersection_; ++gap) {
             int overlap = k_ - gap;
-            size_t hamming_distance = LimitedHammingDistance(seq1.Last(overlap), seq2.First(overlap),
-                                                             hamming_dist_bound_);
+            size_t hamming_distance = hamming.LimitedDistance(overlap, hamming_dist_bound_);
             if (hamming_distance > hamming_dist_bound_)
                 continue;
 
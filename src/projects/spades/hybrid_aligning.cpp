@@ -152,7 +152,7 @@ void CloseGaps(graph_pack::GraphPack& gp, bool rtype,
 
     HybridGapCloser::ConsensusF consensus_f;
     if (rtype) {
-        consensus_f = &SPOAConsensus;
+        consensus_f = SPOAConsensus();
     } else {
         consensus_f = [=](const std::vector<string>& gap_seqs, const debruijn_graph::config::pacbio_processor &pb_) {
             return TrivialConsenus(gap_seqs, pb_.max_contigs_gap_length);
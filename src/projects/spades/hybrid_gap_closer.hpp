@@ -17,6 +17,7 @@
 #include <spoa/spoa.hpp>
 #include <algorithm>
 #include <fstream>
+#include <memory>
 
 namespace debruijn_graph {
 namespace gap_closing {
@@ -309,33 +310,56 @@ public:
     }
 };
 
-inline std::string SPOAConsensus(const std::vector<std::string> &gap_seqs, const debruijn_graph::config::pacbio_processor &pb_) {
-//Default values from SPOA man
-    auto alignment_engine = spoa::AlignmentEngine::Create(spoa::AlignmentType::kNW,
-            pb_.match, pb_.mismatch, pb_.gap_open, pb_.gap_extend, pb_.gap_open_second, pb_.gap_extend_second);
-    spoa::Graph spoa_graph{};
-
-    for (const auto& it : gap_seqs) {
-        std::int32_t score = 0;
-        auto alignment = alignment_engine->Align(it, spoa_graph, &score);
-        spoa_graph.AddAlignment(alignment, it);
-    }
-
-    std::vector<uint32_t > coverages;
-    std::string consensus = spoa_graph.GenerateConsensus(&coverages);
-    size_t cov = gap_seqs.size();
-    int pref_remove = 0;
-    int suf_remove = int(coverages.size()) - 1;
-    while (pref_remove < coverages.size() && coverages[pref_remove] < cov / 2 )
-        pref_remove ++;
-    while (suf_remove >= 0 && coverages[suf_remove] < cov / 2 )
-        suf_remove --;
-    if (pref_remove > suf_remove) {
-        return "";
-    }
-    return consensus.substr(pref_remove, suf_remove - pref_remove + 1);
-}
+// Consensus of the gap sequences built with partial order alignment. Every
+// thread keeps its own alignment engine and graph and reuses them across the
+// gaps, so the alignment matrices are allocated once per thread rather than
+// once per gap. Copies share the per-thread state.
+class SPOAConsensus {
+    struct Aligner {
+        std::unique_ptr<spoa::AlignmentEngine> engine;
+        spoa::Graph graph;
+    };
+
+    std::shared_ptr<std::vector<Aligner>> aligners_;
 
+public:
+    SPOAConsensus()
+            : aligners_(std::make_shared<std::vector<Aligner>>(omp_get_max_threads())) {}
+
+    std::string operator()(const std::vector<std::string> &gap_seqs,
+                           const debruijn_graph::config::pacbio_processor &pb_) const {
+        size_t thread_num = omp_get_thread_num();
+        VERIFY(thread_num < aligners_->size());
+        Aligner &aligner = (*aligners_)[thread_num];
+        if (!aligner.engine) {
+            //Default values from SPOA man
+            aligner.engine = spoa::AlignmentEngine::Create(spoa::AlignmentType::kNW,
+                    pb_.match, pb_.mismatch, pb_.gap_open, pb_.gap_extend, pb_.gap_open_second, pb_.gap_extend_second);
+        }
+
+        spoa::Graph &spoa_graph = aligner.graph;
+        spoa_graph.Clear();
+        for (const auto& it : gap_seqs) {
+            std::int32_t score = 0;
+            auto alignment = aligner.engine->Align(it, spoa_graph, &score);
+            spoa_graph.AddAlignment(alignment, it);
+        }
+
+        std::vector<uint32_t > coverages;
+        std::string consensus = spoa_graph.GenerateConsensus(&coverages);
+        size_t cov = gap_seqs.size();
+        int pref_remove = 0;
+        int suf_remove = int(coverages.size()) - 1;
+        while (pref_remove < coverages.size() && coverages[pref_remove] < cov / 2 )
+            pref_remove ++;
+        while (suf_remove >= 0 && coverages[suf_remove] < cov / 2 )
+            suf_remove --;
+        if (pref_remove > suf_remove) {
+            return "";
+        }
+        return consensus.substr(pref_remove, suf_remove - pref_remove + 1);
+    }
+};
 
 inline std::string TrivialConsenus(const std::vector<std::string> &gap_seqs, size_t max_length) {
     VERIFY(!gap_seqs.empty());
@@ -581,6 +605,15 @@ private:
 
     const GapDescription INVALID_GAP;
 
+    // Supporting sequences of the unique closure of an edge
+    struct ConsensusJob {
+        EdgeId left, right;
+        size_t left_trim, right_trim;
+        std::vector<std::string> gap_variants;
+        // Estimated alignment work: every sequence is aligned to the graph of the previous ones
+        size_t cost;
+    };
+
     std::string PrintLengths(const std::vector<std::string>& gap_seqs) const {
         std::stringstream ss;
         for (const auto& gap_v : gap_seqs)
@@ -588,19 +621,38 @@ private:
         return ss.str();
     }
 
-    GapDescription ConstructConsensus(EdgeId left, EdgeId right, size_t left_trim, size_t right_trim,
-                                      const std::vector<std::string> &gap_variants) const {
-        DEBUG(gap_variants.size() << " gap closing variants, lengths: " << PrintLengths(gap_variants));
-        DEBUG("var size original " << gap_variants.size());
-        auto new_gap_variants(gap_variants);
-        new_gap_variants.resize(std::min(max_consensus_reads_, gap_variants.size()));
-        auto s = consensus_(new_gap_variants, pb_config_);
-        DEBUG("consenus for " << g_.int_id(left)
-                              << " and " << g_.int_id(right)
+    // Keeps at most max_consensus_reads_ (if set) sequences whose lengths are the
+    // closest to the median one, outliers are the least likely to be spanning the gap well
+    std::vector<std::string> SelectVariants(std::vector<std::string> gap_variants) const {
+        if (!max_consensus_reads_ || gap_variants.size() <= max_consensus_reads_)
+            return gap_variants;
+
+        std::vector<size_t> lengths;
+        for (const auto &s : gap_variants)
+            lengths.push_back(s.length());
+        std::nth_element(lengths.begin(), lengths.begin() + lengths.size() / 2, lengths.end());
+        size_t median = lengths[lengths.size() / 2];
+
+        auto deviation = [=](const std::string &s) {
+            return s.length() > median ? s.length() - median : median - s.length();
+        };
+        std::stable_sort(gap_variants.begin(), gap_variants.end(),
+                         [&](const std::string &a, const std::string &b) {
+                             return deviation(a) < deviation(b);
+                         });
+        gap_variants.resize(max_consensus_reads_);
+        return gap_variants;
+    }
+
+    GapDescription ConstructConsensus(const ConsensusJob &job) const {
+        DEBUG(job.gap_variants.size() << " gap closing variants, lengths: " << PrintLengths(job.gap_variants));
+        auto s = consensus_(job.gap_variants, pb_config_);
+        DEBUG("consenus for " << g_.int_id(job.left)
+                              << " and " << g_.int_id(job.right)
                               << " found: '" << s << "'");
-        return GapDescription(left, right,
+        return GapDescription(job.left, job.right,
                               Sequence(s),
-                              left_trim, right_trim);
+                              job.left_trim, job.right_trim);
     }
 
     //all gaps guaranteed to correspond to a single edge pair
@@ -654,7 +706,7 @@ private:
         return answer;
     }
 
-    GapDescription ConstructConsensus(gap_info_it start_it, gap_info_it end_it) const {
+    bool PrepareConsensus(gap_info_it start_it, gap_info_it end_it, ConsensusJob &job) const {
         DEBUG("Considering extension " << g_.str(start_it->right()));
         size_t cur_len = end_it - start_it;
 
@@ -665,7 +717,7 @@ private:
         //all start and end positions are equal here
         if (padded_gaps.size() < min_weight_) {
             DEBUG("Connection weight too low after padding");
-            return INVALID_GAP;
+            return false;
         }
 
         std::vector<std::string> gap_variants;
@@ -680,67 +732,86 @@ private:
         //    VERIFY(it->edge_gap_start_position == start_it->edge_gap_start_position);
         //    VERIFY(it->edge_gap_end_position == start_it->edge_gap_end_position);
         //}
-        auto padded_gap = padded_gaps.front();
-
-        return ConstructConsensus(padded_gap.left(), padded_gap.right(),
-                                  padded_gap.left_trim(),
-                                  padded_gap.right_trim(),
-                                  gap_variants);
+        const auto &padded_gap = padded_gaps.front();
+        DEBUG("var size original " << gap_variants.size());
+        job.left = padded_gap.left();
+        job.right = padded_gap.right();
+        job.left_trim = padded_gap.left_trim();
+        job.right_trim = padded_gap.right_trim();
+        job.gap_variants = SelectVariants(std::move(gap_variants));
+
+        size_t total_length = 0, max_length = 0;
+        for (const auto &s : job.gap_variants) {
+            total_length += s.length();
+            max_length = std::max(max_length, s.length());
+        }
+        job.cost = total_length * max_length;
+        return true;
     }
 
-    GapDescription ConstructConsensus(EdgeId e) const {
+    //consensus is only needed if the extension of the edge is unique
+    bool PrepareConsensus(EdgeId e, ConsensusJob &job) const {
         DEBUG("Constructing consensus for edge " << g_.str(e));
-        std::vector<GapDescription> closures;
+        size_t closures = 0;
         for (const auto& edge_pair_gaps : storage_.EdgePairGaps(utils::get(storage_.inner_index(), e))) {
-            auto consensus = ConstructConsensus(edge_pair_gaps.first, edge_pair_gaps.second);
-            if (consensus != INVALID_GAP) {
-                closures.push_back(consensus);
-            }
-        }
+            ConsensusJob candidate;
+            if (!PrepareConsensus(edge_pair_gaps.first, edge_pair_gaps.second, candidate))
+                continue;
 
-        if (closures.size() == 1) {
-            DEBUG("Found unique extension " << closures.front().str(g_));
-            return closures.front();
+            if (++closures > 1) {
+                DEBUG("Non-unique extension");
+                return false;
+            }
+            job = std::move(candidate);
         }
 
-        if (closures.size() > 1) {
-            DEBUG("Non-unique extension");
-        }
-        return INVALID_GAP;
+        return closures == 1;
     }
 
     std::vector<GapDescription> ConstructConsensus() const {
-        std::vector<std::vector<GapDescription>> closures_by_thread(omp_get_max_threads());
+        std::vector<std::vector<std::pair<size_t, ConsensusJob>>> jobs_by_thread(omp_get_max_threads());
 
-        # pragma omp parallel for
+        # pragma omp parallel for schedule(guided)
         for (size_t i = 0; i < storage_.size(); i++) {
-            EdgeId e = storage_[i];
-            size_t thread_num = omp_get_thread_num();
-            GapDescription gap = ConstructConsensus(e);
-            if (gap != INVALID_GAP) {
-                closures_by_thread[thread_num].push_back(gap);
-            }
+            ConsensusJob job;
+            if (PrepareConsensus(storage_[i], job))
+                jobs_by_thread[omp_get_thread_num()].emplace_back(i, std::move(job));
         }
 
-        std::vector<GapDescription> closures;
-        for (auto& new_per_thread : closures_by_thread) {
-            std::copy(new_per_thread.begin(), new_per_thread.end(), std::back_inserter(closures));
+        std::vector<std::pair<size_t, ConsensusJob>> jobs;
+        for (auto& new_per_thread : jobs_by_thread) {
+            std::move(new_per_thread.begin(), new_per_thread.end(), std::back_inserter(jobs));
             new_per_thread.clear();
         }
+
+        // The most expensive gaps go first, so that they do not form a single-threaded tail.
+        // Ties are broken by the edge for the deterministic order of the closures.
+        std::sort(jobs.begin(), jobs.end(),
+                  [](const std::pair<size_t, ConsensusJob> &a, const std::pair<size_t, ConsensusJob> &b) {
+                      return std::make_pair(b.second.cost, a.first) < std::make_pair(a.second.cost, b.first);
+                  });
+        DEBUG("Constructing consensus for " << jobs.size() << " gaps");
+
+        std::vector<GapDescription> closures(jobs.size());
+        # pragma omp parallel for schedule(dynamic, 1)
+        for (size_t i = 0; i < jobs.size(); i++) {
+            closures[i] = ConstructConsensus(jobs[i].second);
+            DEBUG("Found unique extension " << closures[i].str(g_));
+        }
+
         return closures;
     }
 
 public:
     HybridGapCloser(Graph& g, const GapStorage& storage,
                     size_t min_weight, ConsensusF consensus,
-                    debruijn_graph::config::pacbio_processor pb_config,
-                    size_t max_consensus_reads = 20)
+                    debruijn_graph::config::pacbio_processor pb_config)
             : g_(g), storage_(storage),
               min_weight_(min_weight),
               consensus_(consensus),
               pb_config_(pb_config),
               long_seq_limit_(pb_config.long_seq_limit),
-              max_consensus_reads_(max_consensus_reads) {
+              max_consensus_reads_(pb_config.max_consensus_reads) {
     }
 
     std::map<EdgeId, EdgeId> operator()() {
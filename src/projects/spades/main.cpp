@@ -76,6 +76,9 @@ int main(int argc, char **argv) {
     srand(42);
     srandom(42);
 
+    // Buffered log messages are written out on crashes
+    utils::segfault_handler sh;
+
     try {
         using namespace debruijn_graph;
 
@@ -114,12 +117,15 @@ int main(int argc, char **argv) {
         TIME_TRACE_SCOPE("spades");
         spades::assemble_genome();
     } catch (std::bad_alloc const &e) {
+        logging::flush_logger();
         std::cerr << "Not enough memory to run SPAdes. " << e.what() << std::endl;
         return EINTR;
     } catch (std::exception const &e) {
+        logging::flush_logger();
         std::cerr << "Exception caught " << e.what() << std::endl;
         return EINTR;
     } catch (...) {
+        logging::flush_logger();
         std::cerr << "Unknown exception caught " << std::endl;
         return EINTR;
     }
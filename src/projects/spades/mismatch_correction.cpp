@@ -11,7 +11,6 @@
 #include "alignment/sequence_mapper.hpp"
 #include "alignment/sequence_mapper_notifier.hpp"
 #include "io/dataset_support/read_converter.hpp"
-#include "modules/simplification/compressor.hpp"
 #include "pipeline/graph_pack.hpp"
 #include "pipeline/graph_pack_helpers.h"
 #include "pipeline/sequence_mapper_gp_api.hpp"
@@ -20,6 +19,9 @@
 #include <parallel_hashmap/phmap.h>
 #include <parallel_hashmap/btree.h>
 
+#include <algorithm>
+#include <atomic>
+
 template <typename Iter>
 std::vector<Iter> split_iterator(size_t chunks, Iter b, Iter e, size_t n) {
     std::vector<Iter> result(chunks + 1, e);
@@ -44,68 +46,49 @@ std::vector<Iter> split_iterator(size_t chunks, Iter b, Iter e, size_t n) {
 namespace debruijn_graph {
 
 namespace mismatches {
-struct NuclCount {
-    std::array<size_t, 4> counts_;
-
-    NuclCount()
-            : counts_{} {}
-
-    size_t &operator[](size_t nucl) {
-        return counts_[nucl];
-    }
+typedef std::array<uint32_t, 4> NuclCount;
 
-    size_t operator[](size_t nucl) const {
-        return counts_[nucl];
-    }
+// Nucleotide counts at the potential mismatch positions of a single edge.
+// Positions are sorted, the counts for the i-th one are stored at
+// counts[4 * i, 4 * i + 4).
+class MismatchEdgeInfo {
+    const uint32_t *positions_ = nullptr;
+    size_t size_ = 0;
+    const std::atomic<uint32_t> *counts_ = nullptr;
 
-    NuclCount &operator+=(const NuclCount &other) {
-        counts_[0] += other.counts_[0];
-        counts_[1] += other.counts_[1];
-        counts_[2] += other.counts_[2];
-        counts_[3] += other.counts_[3];
-        return *this;
-    }
-};
+public:
+    MismatchEdgeInfo() = default;
 
-struct MismatchEdgeInfo {
-    NuclCount operator[](size_t i) const {
-        auto it = info_.find(uint32_t(i));
-        if (it == info_.end())
-            return NuclCount();
-        else
-            return it->second;
-    }
+    MismatchEdgeInfo(const std::vector<uint32_t> &positions, const std::atomic<uint32_t> *counts)
+            : positions_(positions.data()), size_(positions.size()), counts_(counts) {}
 
-    void operator+=(const MismatchEdgeInfo &other) {
-        for (const auto &entry : other.info_) {
-            info_[entry.first] += entry.second;
-        }
-    }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
 
-    void increment(size_t position, size_t nucl) {
-        info_[uint32_t(position)][nucl] += 1;
-    }
+    size_t position(size_t i) const { return positions_[i]; }
 
-    void ClearValues() {
-        for (auto &kv : info_) {
-            kv.second = NuclCount();
-        }
+    NuclCount operator[](size_t i) const {
+        const std::atomic<uint32_t> *c = counts_ + 4 * i;
+        return { c[0].load(std::memory_order_relaxed), c[1].load(std::memory_order_relaxed),
+                 c[2].load(std::memory_order_relaxed), c[3].load(std::memory_order_relaxed) };
     }
-
-public:
-    phmap::flat_hash_map<uint32_t, NuclCount> info_;
 };
 
+// Counts are kept only for the positions where kmer mapper suggests a
+// mismatch. All of them live in a single preallocated array shared by all
+// threads, so reads are counted in place without per-thread buffers.
 class MismatchStatistics : public SequenceMapperListener {
 private:
     typedef Graph::EdgeId EdgeId;
-    typedef phmap::node_hash_map<EdgeId, MismatchEdgeInfo> InnerMismatchStatistics;
-    typedef typename InnerMismatchStatistics::const_iterator const_iterator;
-    InnerMismatchStatistics statistics_;
-    std::vector<InnerMismatchStatistics> statistics_buffers_;
-
     typedef phmap::node_hash_map<EdgeId, adt::flat_set<uint32_t>> MismatchCandidates;
-    MismatchCandidates candidates_;
+
+    struct EdgeCandidates {
+        std::vector<uint32_t> positions;
+        size_t offset = 0;
+    };
+
+    phmap::flat_hash_map<EdgeId, EdgeCandidates> candidates_;
+    std::vector<std::atomic<uint32_t>> counts_;
 
     const Graph &g_;
 
@@ -175,28 +158,33 @@ private:
             CollectPotentialMismatches(gp, iters[i], iters[i + 1], potential_mismatches[i]);
         }
 
+        MismatchCandidates candidates;
         for (auto &entry : potential_mismatches) {
             for (const auto &candidate : entry) {
-                candidates_[candidate.first].insert(candidate.second.begin(),
-                                                    candidate.second.end());
+                candidates[candidate.first].insert(candidate.second.begin(),
+                                                   candidate.second.end());
             }
             entry.clear();
         }
 
-        {
-            size_t edges = candidates_.size();
-            size_t positions = 0;
-            for (const auto &candidate : candidates_) {
-                positions += candidate.second.size();
-            }
-
-            INFO("Total " << edges << " edges (out of " << gp.get<Graph>().e_size() <<  ") with " << positions << " potential mismatch positions ("
-                 << double(positions) / double(edges) << " positions per edge)");
+        // Lay out the counts of all candidate positions one edge after another
+        size_t positions = 0;
+        candidates_.reserve(candidates.size());
+        for (auto &candidate : candidates) {
+            EdgeCandidates &edge_candidates = candidates_[candidate.first];
+            edge_candidates.positions.assign(candidate.second.begin(), candidate.second.end());
+            edge_candidates.offset = 4 * positions;
+            positions += candidate.second.size();
+            candidate.second.clear();
         }
+        counts_ = std::vector<std::atomic<uint32_t>>(4 * positions);
+
+        INFO("Total " << candidates_.size() << " edges (out of " << gp.get<Graph>().e_size() <<  ") with " << positions << " potential mismatch positions ("
+             << double(positions) / double(candidates_.size()) << " positions per edge)");
     }
 
     template <typename Read>
-    void ProcessSingleReadImpl(size_t thread_index, const Read& read, const MappingPath<EdgeId> &path) {
+    void ProcessSingleReadImpl(const Read& read, const MappingPath<EdgeId> &path) {
         // VERIFY(path.size() <= 1);
         if (path.size() != 1)  // TODO Use only_simple feature
             return;
@@ -204,7 +192,6 @@ private:
         EdgeId e = path[0].first;
         MappingRange mr = path[0].second;
         const Sequence &s_read = read.sequence();
-        auto &buffer = statistics_buffers_[thread_index];
 
         if (mr.initial_range.size() != mr.mapped_range.size())
             return;
@@ -225,23 +212,14 @@ private:
             return;
 
         TRACE("statistics might be changing");
-        for (size_t i = 0; i < len; i++) {
-            size_t pos = mr.mapped_range.start_pos + i;
-            if (pos > std::numeric_limits<uint32_t>::max())
-                continue;
-
-            if (!it->second.count(uint32_t(pos)))
-                continue;
-
-            char nucl_code = s_read[mr.initial_range.start_pos + i];
-            buffer[e].increment(pos, nucl_code);
-        }
-    }
-
-    void Merge(InnerMismatchStatistics &other_statistics) {
-        for (auto &e_info : other_statistics) {
-            statistics_[e_info.first] += e_info.second;
-            e_info.second.ClearValues();
+        // Visit only the candidate positions covered by the read
+        const auto &positions = it->second.positions;
+        std::atomic<uint32_t> *counts = counts_.data() + it->second.offset;
+        size_t start = mr.mapped_range.start_pos;
+        for (auto pos = std::lower_bound(positions.begin(), positions.end(), start);
+             pos != positions.end() && *pos < start + len; ++pos) {
+            char nucl_code = s_read[mr.initial_range.start_pos + (*pos - start)];
+            counts[4 * (pos - positions.begin()) + nucl_code].fetch_add(1, std::memory_order_relaxed);
         }
     }
 
@@ -251,37 +229,21 @@ public:
         CollectPotentialMismatches(gp);
     }
 
-    void StartProcessLibrary(size_t threads_count) override {
-        statistics_buffers_.clear();
-        statistics_buffers_.resize(threads_count, statistics_);
+    void ProcessSingleRead(size_t /* thread_index */, const io::SingleReadSeq &read, const MappingPath<EdgeId> &path) override {
+        ProcessSingleReadImpl(read, path);
     }
 
-    void StopProcessLibrary() override {
-        statistics_buffers_.clear();
+    void ProcessSingleRead(size_t /* thread_index */, const io::SingleRead &read, const MappingPath<EdgeId> &path) override {
+        ProcessSingleReadImpl(read, path);
     }
 
-    void ProcessSingleRead(size_t thread_index, const io::SingleReadSeq &read, const MappingPath<EdgeId> &path) override {
-        ProcessSingleReadImpl(thread_index, read, path);
-    }
-
-    void ProcessSingleRead(size_t thread_index, const io::SingleRead &read, const MappingPath<EdgeId> &path) override {
-        ProcessSingleReadImpl(thread_index, read, path);
-    }
-
-    void MergeBuffer(size_t thread_index) override {
-        Merge(statistics_buffers_[thread_index]);
-    }
-
-    const_iterator begin() const {
-        return statistics_.begin();
-    }
-
-    const_iterator end() const {
-        return statistics_.end();
-    }
+    // Empty if there are no potential mismatches on the edge
+    MismatchEdgeInfo find(EdgeId edge) const {
+        auto it = candidates_.find(edge);
+        if (it == candidates_.end())
+            return MismatchEdgeInfo();
 
-    const_iterator find(const EdgeId &edge) const {
-        return statistics_.find(edge);
+        return MismatchEdgeInfo(it->second.positions, counts_.data() + it->second.offset);
     }
 };
 
@@ -295,51 +257,43 @@ private:
     const size_t k_;
     const double relative_threshold_;
 
-    EdgeId CorrectNucl(EdgeId edge, size_t position, char nucl) {
-        VERIFY(position >= k_);
-        if (position + 1 < graph_.length(edge)) {
-            auto tmp = graph_.SplitEdge(edge, position + 1);
-            edge = tmp.first;
-        }
-        EdgeId mismatch = edge;
-        if (position > k_) {
-            auto tmp = graph_.SplitEdge(edge, position - k_);
-            edge = tmp.first;
-            mismatch = tmp.second;
-        }
-        Sequence s_mm = graph_.EdgeNucls(mismatch);
-        Sequence correct = s_mm.Subseq(0, k_) + Sequence(std::string(1, nucl)) +
-                           s_mm.Subseq(k_ + 1, k_ * 2 + 1);
-
-        VERIFY(nucl != s_mm[k_]);
-        EdgeId correct_edge = graph_.AddEdge(graph_.EdgeStart(mismatch), graph_.EdgeEnd(mismatch), correct);
-        EdgeId glued = graph_.GlueEdges(mismatch, correct_edge);
-        return position > k_ ? edge : glued;
-    }
+    typedef std::vector<std::pair<size_t, char>> Mismatches;
 
-    EdgeId CorrectNucls(EdgeId edge, const std::vector<std::pair<size_t, char>> &mismatches) {
+    // All the substitutions are applied to a single copy of the edge sequence
+    // which is then glued onto the edge, so the edge is rewritten once
+    // regardless of the number of mismatches. Mismatches never touch the
+    // terminal k-mers, so the new edge connects the same vertices.
+    void CorrectNucls(EdgeId edge, const Mismatches &mismatches) {
         // Nothing to correct, bail out.
-        // Note that this might be a correctness thing as well, as we're calling Compress
-        // down below.
         if (mismatches.empty())
-            return edge;
+            return;
 
-        for (auto it = mismatches.rbegin(); it != mismatches.rend(); ++it) {
-            edge = CorrectNucl(edge, it->first, it->second);
+        std::string correct = graph_.EdgeNucls(edge).str();
+        for (const auto &mismatch : mismatches) {
+            VERIFY(mismatch.first >= k_ && mismatch.first < graph_.length(edge));
+            VERIFY(nucl(mismatch.second) != correct[mismatch.first]);
+            correct[mismatch.first] = nucl(mismatch.second);
         }
-        EdgeId tmp = omnigraph::Compressor<Graph>(graph_).CompressVertexEdgeId(graph_.EdgeEnd(edge));
-        if (tmp == EdgeId())
-            return edge;
-        else
-            return tmp;
+
+        EdgeId correct_edge = graph_.AddEdge(graph_.EdgeStart(edge), graph_.EdgeEnd(edge), Sequence(correct));
+        graph_.GlueEdges(edge, correct_edge);
     }
 
-    std::vector<std::pair<size_t, char>> FindMismatches(EdgeId edge, const MismatchEdgeInfo &statistics) const {
-        std::vector<std::pair<size_t, char>> to_correct;
+    Mismatches FindMismatches(EdgeId edge, const MismatchEdgeInfo &statistics) const {
+        Mismatches to_correct;
         const Sequence &s_edge = graph_.EdgeNucls(edge);
-        for (size_t i = k_; i < graph_.length(edge); i++) {
+        // Positions without statistics have zero counts and never win, so
+        // only the candidate positions need to be considered
+        size_t next = k_;
+        for (size_t idx = 0; idx < statistics.size(); ++idx) {
+            size_t i = statistics.position(idx);
+            if (i < next)
+                continue;
+            if (i >= graph_.length(edge))
+                break;
+
             size_t cur_best = 0;
-            NuclCount nc = statistics[i];
+            NuclCount nc = statistics[idx];
             for (size_t j = 1; j < 4; j++) {
                 if (nc[j] > nc[cur_best]) {
                     cur_best = j;
@@ -348,24 +302,13 @@ private:
             char nucl_code = s_edge[i];
             if ((double) nc[cur_best] > relative_threshold_ * (double) nc[nucl_code] + 1.) {
                 to_correct.emplace_back(i, cur_best);
-                i += k_;
+                next = i + k_ + 1;
             }
-
         }
         return to_correct;
     }
 
-    size_t CorrectEdge(EdgeId edge, const MismatchEdgeInfo &statistics) {
-        auto to_correct = FindMismatches(edge, statistics);
-        EdgeId new_edge = CorrectNucls(edge, to_correct);
-        if (new_edge == EdgeId())
-            new_edge = edge;
-
-        return to_correct.size();
-    }
-
     size_t CorrectAllEdges(const MismatchStatistics &statistics) {
-        size_t res = 0;
         phmap::btree_set<EdgeId> conjugate_fix;
 
         for (EdgeId e : graph_.edges()) {
@@ -373,16 +316,27 @@ private:
                 conjugate_fix.insert(e);
         }
 
+        std::vector<EdgeId> edges;
         for (EdgeId e : conjugate_fix) {
-            DEBUG("processing edge" << graph_.int_id(e));
+            if (!statistics.find(e).empty())
+                edges.push_back(e);
+        }
 
-            auto stat_it = statistics.find(e);
-            if (stat_it == statistics.end())
-                continue;
+        // Detection only reads the graph and the statistics, so it is done in
+        // parallel, the edges are then rewritten one by one
+        std::vector<Mismatches> mismatches(edges.size());
+#       pragma omp parallel for schedule(guided)
+        for (size_t i = 0; i < edges.size(); ++i) {
+            EdgeId e = edges[i];
+            DEBUG("processing edge" << graph_.int_id(e));
+            if (!graph_.RelatedVertices(graph_.EdgeStart(e), graph_.EdgeEnd(e)))
+                mismatches[i] = FindMismatches(e, statistics.find(e));
+        }
 
-            if (!graph_.RelatedVertices(graph_.EdgeStart(e), graph_.EdgeEnd(e))) {
-                res += CorrectEdge(e, stat_it->second);
-            }
+        size_t res = 0;
+        for (size_t i = 0; i < edges.size(); ++i) {
+            CorrectNucls(edges[i], mismatches[i]);
+            res += mismatches[i].size();
         }
         INFO("All edges processed");
         return res;
@@ -127,6 +127,8 @@ struct Args {
     unsigned K = 21;
     std::filesystem::path workdir, dataset;
     size_t read_buffer_size = 536870912;
+    unsigned workers = 1;
+    size_t worker_memory = 0;
     std::vector<std::filesystem::path> input;
 };
 }
@@ -142,6 +144,8 @@ void process_cmdline(int argc, char **argv, kmer_count::Args &args) {
         (option("-t", "--threads") & integer("value", args.nthreads)) % "# of threads to use",
         (option("-w", "--workdir") & value("dir", workdir)) % "Working directory to use",
         (option("-b", "--bufsize") & integer("value", args.read_buffer_size)) % "Sorting buffer size, per thread",
+        (option("-p", "--workers") & integer("value", args.workers)) % "# of worker processes to count k-mer shards",
+        (option("-m", "--worker-memory") & integer("value", args.worker_memory)) % "Memory limit for every worker process (in Gb)",
         (option("-h", "--help").set(print_help)) % "Show help",
         opt_values("input files", input)
     );
@@ -219,7 +223,16 @@ int main(int argc, char* argv[]) {
                 splitter.push_back(s);
         }
         kmers::KMerDiskCounter<RtSeq> counter(args.workdir, std::move(splitter));
-        auto res = counter.CountAll(16, args.nthreads, /* merge */ true);
+        kmers::KMerDiskStorage<RtSeq> res;
+        if (args.workers > 1) {
+            kmers::ShardingOptions opts;
+            opts.num_workers = args.workers;
+            opts.worker_memory_limit = args.worker_memory << 30;
+            res = counter.CountSharded(16, args.nthreads, opts,
+                                       [](size_t, const kmers::KMerDiskStorage<RtSeq> &) {});
+            res.merge();
+        } else
+            res = counter.CountAll(16, args.nthreads, /* merge */ true);
         auto final_kmers = res.final_kmers();
         std::filesystem::path outputfile_name = args.workdir / "final_kmers";
         std::rename(final_kmers->file().c_str(), outputfile_name.c_str());
@@ -17,6 +17,7 @@
 #include "utils/segfault_handler.hpp"
 #include "kmer_index/kmer_counting.hpp"
 #include "utils/filesystem/temporary.hpp"
+#include "utils/memory_limit.hpp"
 
 #include "adt/cyclichash.hpp"
 #include "adt/cqf.hpp"
@@ -27,6 +28,7 @@
 
 #include <clipp/clipp.h>
 #include <sys/types.h>
+#include <future>
 #include <string>
 
 using namespace std;
@@ -45,8 +47,11 @@ struct Args {
     unsigned thr = 2, k = 21;
     std::filesystem::path dataset_desc, workdir;
     unsigned nthreads = (omp_get_max_threads() / 2);
+    size_t memory = 250;
     bool drop_names = false;
     bool drop_quality = false;
+    unsigned diginorm = 0;
+    size_t diginorm_kmers = 0;
 };
 }
 
@@ -61,8 +66,11 @@ void process_cmdline(int argc, char **argv, read_filter::Args &args) {
         (required("-d", "--dataset") & value("yaml", dataset_desc)) % "Dataset description (in YAML)",
         (option("-t", "--threads") & integer("value", args.nthreads)) % "# of threads to use",
         (option("-o", "--outdir") & value("dir", workdir)) %  "Output directory to use",
+        (option("-m", "--memory") & integer("value", args.memory)) % "RAM limit in GB (terminates if exceeded) [default: 250]",
         (option("--drop-names").set(args.drop_names)) % "Drop read names and quality (makes everything faster)",
         (option("--drop-quality").set(args.drop_quality)) % "Drop read quality (makes everything faster)",
+        (option("--diginorm") & integer("value", args.diginorm)) % "Streaming digital normalization: retain reads with median kmer count (among the reads retained so far) less than this value, input is read only once (-c is ignored)",
+        (option("--diginorm-kmers") & integer("value", args.diginorm_kmers)) % "Expected # of distinct kmers for digital normalization (estimated from the input size by default)",
         (option("-h", "--help").set(print_help)) % "Show help"
     );
 
@@ -80,16 +88,25 @@ void process_cmdline(int argc, char **argv, read_filter::Args &args) {
 }
 
 template<class IS, class OS, class Filter>
-void filter_reads(IS &input, OS &output, const Filter& filter, unsigned buffer_size, unsigned nthreads) {
-    std::vector<typename OS::ReadT> reads_buffer(buffer_size);
-    std::vector<bool> need_to_out(buffer_size);
+void filter_reads(IS &input, OS &output, const Filter& filter, unsigned buffer_size, unsigned nthreads,
+                  ThreadPool::ThreadPool *pool) {
+    // Retained reads of a chunk are written in background while the next
+    // chunk is being read and filtered
+    std::vector<typename OS::ReadT> reads_buffer[2];
+    std::vector<uint8_t> need_to_out[2];
     std::vector<unsigned> chunk_start(nthreads), chunk_end(nthreads);
+    std::future<void> writer;
 
     size_t read_count = 0, retained = 0;
-    while (!input.eof()) {
+    for (unsigned cur = 0; !input.eof(); cur ^= 1) {
+        auto &reads = reads_buffer[cur];
+        auto &out = need_to_out[cur];
+        reads.resize(buffer_size);
+        out.assign(buffer_size, false);
+
         unsigned reads_cnt = 0;
-        while (!input.eof() && reads_cnt < reads_buffer.size()) {
-            input >> reads_buffer[reads_cnt];
+        while (!input.eof() && reads_cnt < reads.size()) {
+            input >> reads[reads_cnt];
             ++reads_cnt; ++read_count;
         }
 
@@ -102,29 +119,75 @@ void filter_reads(IS &input, OS &output, const Filter& filter, unsigned buffer_s
         }
         chunk_end[nthreads - 1] = reads_cnt;
 
-#       pragma omp parallel for
+#       pragma omp parallel for num_threads(nthreads)
         for (unsigned i = 0; i < nthreads; ++i) {
             for (unsigned j = chunk_start[i]; j < chunk_end[i]; ++j) {
-                typename OS::ReadT longest_valid_read = reads_buffer[j];
+                typename OS::ReadT longest_valid_read = reads[j];
                 io::LongestValid(longest_valid_read);
 
-                need_to_out[j] = filter(longest_valid_read);
+                out[j] = filter(longest_valid_read);
             }
         }
 
-        for (size_t i = 0; i < reads_cnt; ++i) {
-            if (need_to_out[i]) {
-                output << reads_buffer[i];
-                retained += 1;
+        retained += std::count(out.begin(), out.begin() + reads_cnt, uint8_t(true));
+
+        if (writer.valid())
+            writer.get();
+        auto write = [&output, &reads, &out, reads_cnt] {
+            for (size_t i = 0; i < reads_cnt; ++i) {
+                if (out[i])
+                    output << reads[i];
             }
-            need_to_out[i] = false;
-        }
+        };
+        if (pool)
+            writer = pool->run(write);
+        else
+            write();
 
         VERBOSE_POWER(read_count, " reads processed");
     }
+    if (writer.valid())
+        writer.get();
+
     INFO("Total " << read_count << " reads processed, " << retained << " reads left after filtering");
 }
 
+template<class IS, class OS>
+void filter_reads(IS &input, OS &output, qf::cqf &cqf, const SeqHasher &hasher,
+                  const read_filter::Args &args, unsigned nthreads, ThreadPool::ThreadPool *pool) {
+    typedef typename OS::ReadT ReadT;
+    const unsigned FILTER_READS_BUFF_SIZE = 1 << 20;
+
+    if (args.diginorm) {
+        io::DigitalNormalizer<ReadT, SeqHasher> filter(args.k, hasher, cqf, args.diginorm);
+        filter_reads(input, output, filter, FILTER_READS_BUFF_SIZE, nthreads, pool);
+    } else {
+        io::CoverageFilter<ReadT, SeqHasher> filter(args.k, hasher, cqf, args.thr + 1);
+        filter_reads(input, output, filter, FILTER_READS_BUFF_SIZE, nthreads, pool);
+    }
+}
+
+// Upper bound for the number of distinct kmers from the size of the input
+// files, as they are not read before digital normalization
+template<class Dataset>
+size_t estimate_input_kmers(const Dataset &dataset) {
+    // Typical compression ratio of sequencing data
+    const size_t COMPRESSION_RATIO = 4;
+
+    size_t bytes = 0;
+    for (const auto &file : dataset.reads()) {
+        std::error_code ec;
+        size_t size = std::filesystem::file_size(file, ec);
+        if (ec)
+            continue;
+        auto ext = file.extension();
+        bytes += (ext == ".gz" || ext == ".bz2" || ext == ".bam") ? COMPRESSION_RATIO * size : size;
+    }
+
+    // Roughly a half of FASTQ is sequence, every base starts at most one kmer
+    return std::max<size_t>(bytes / 2, 1);
+}
+
 int main(int argc, char* argv[]) {
     typedef qf::cqf CQFKmerFilter;
     //typedef CyclicHash<64, uint8_t, NDNASeqHash<uint8_t>> SeqHasher;
@@ -147,6 +210,7 @@ int main(int argc, char* argv[]) {
         INFO("K-mer length set to " << args.k);
         INFO("# of threads to use: " << args.nthreads);
         INFO("Maximum # of threads to use (adjusted due to OMP capabilities): " << args.nthreads);
+        utils::limit_memory(args.memory << 30);
 
         io::DataSet<debruijn_graph::config::LibraryData> dataset;
         dataset.load(args.dataset_desc);
@@ -154,31 +218,53 @@ int main(int argc, char* argv[]) {
         auto tmpdir = fs::tmp::make_temp_dir(args.workdir, "binreads");
         debruijn_graph::config::init_libs(dataset, args.nthreads, tmpdir->dir());
 
-        std::unique_ptr<ThreadPool::ThreadPool> pool;
-
-        if (args.nthreads > 1) {
-            pool = std::make_unique<ThreadPool::ThreadPool>(args.nthreads);
-        }
-
-        for (size_t i = 0; i < dataset.lib_count(); ++i) {
-            io::ReadConverter::ConvertToBinary(dataset[i], pool.get());
-        }
-
-        std::vector<size_t> libs(dataset.lib_count());
-        std::iota(libs.begin(), libs.end(), 0);
-        io::BinarySingleStreams single_readers = io::single_binary_readers_for_libs(dataset, libs,
-                                                                                    /*followed by rc*/false, /*including paired*/true);
-        INFO("Estimating kmer cardinality");
         SeqHasher hasher(args.k);
+        std::unique_ptr<CQFKmerFilter> cqf;
+        if (args.diginorm) {
+            size_t kmers_cnt_est = args.diginorm_kmers ? args.diginorm_kmers : estimate_input_kmers(dataset);
+            INFO("Digital normalization to median kmer count " << args.diginorm << ", expecting up to " << kmers_cnt_est << " distinct kmers");
+            // The estimate from the input size is crude, never let it take
+            // more memory than there is
+            size_t cqf_memory = CQFKmerFilter::memory_estimate(kmers_cnt_est);
+            size_t max_memory = utils::get_free_memory() / 4 * 3;
+            INFO("Kmer counter takes " << (cqf_memory >> 20) << " MB");
+            CHECK_FATAL_ERROR(cqf_memory <= max_memory,
+                              "Kmer counter for " << kmers_cnt_est << " kmers needs " << (cqf_memory >> 20)
+                              << " MB, while only " << (max_memory >> 20) << " MB can be used. "
+                              << "Increase the memory limit with -m or "
+                              << (args.diginorm_kmers ? "decrease" : "specify")
+                              << " the expected number of distinct kmers with --diginorm-kmers");
+            cqf = std::make_unique<CQFKmerFilter>(kmers_cnt_est);
+        } else {
+            std::unique_ptr<ThreadPool::ThreadPool> pool;
+            if (args.nthreads > 1)
+                pool = std::make_unique<ThreadPool::ThreadPool>(args.nthreads);
 
-        size_t kmers_cnt_est = kmers::EstimateCardinalityUpperBound(args.k, single_readers, hasher);
+            for (size_t i = 0; i < dataset.lib_count(); ++i) {
+                io::ReadConverter::ConvertToBinary(dataset[i], pool.get());
+            }
 
-        CQFKmerFilter cqf(kmers_cnt_est);
-        INFO("Filling kmer coverage");
-        kmers::FillCoverageHistogram(cqf, args.k, hasher, single_readers, args.thr + 1);
-        INFO("Kmer coverage filled");
+            std::vector<size_t> libs(dataset.lib_count());
+            std::iota(libs.begin(), libs.end(), 0);
+            io::BinarySingleStreams single_readers = io::single_binary_readers_for_libs(dataset, libs,
+                                                                                        /*followed by rc*/false, /*including paired*/true);
+            INFO("Estimating kmer cardinality");
+            size_t kmers_cnt_est = kmers::EstimateCardinalityUpperBound(args.k, single_readers, hasher);
+
+            cqf = std::make_unique<CQFKmerFilter>(kmers_cnt_est);
+            INFO("Filling kmer coverage");
+            kmers::FillCoverageHistogram(*cqf, args.k, hasher, single_readers, args.thr + 1);
+            INFO("Kmer coverage filled");
+        }
 
-        const unsigned FILTER_READS_BUFF_SIZE = 1 << 20;
+        // Retained reads are written by a single background thread, it is
+        // taken out of the filtering threads
+        std::unique_ptr<ThreadPool::ThreadPool> pool;
+        unsigned filter_threads = args.nthreads;
+        if (args.nthreads > 1) {
+            pool = std::make_unique<ThreadPool::ThreadPool>(1);
+            filter_threads -= 1;
+        }
 
         io::DataSet<debruijn_graph::config::LibraryData> outdataset;
         for (size_t i = 0; i < dataset.lib_count(); ++i) {
@@ -193,21 +279,20 @@ int main(int argc, char* argv[]) {
                 io::PairedStream paired_reads_stream =
                         io::paired_easy_reader(dataset[i], /*followed by rc*/false, /*insert size*/0, false /* use orientation */, false /* handle Ns */,
                                                flags);
-                io::CoverageFilter<io::PairedRead, SeqHasher> filter(args.k, hasher, cqf, args.thr + 1);
                 // FIXME: we cannot use unique_ptr here as OFasta / OFastq streams do not have common base class :(
                 if (args.drop_names || args.drop_quality) {
                     std::filesystem::path left = to_string(i + 1) + ".1.fasta";
                     std::filesystem::path right = to_string(i + 1) + ".2.fasta";
 
                     io::OFastaPairedStream ostream(args.workdir / left, args.workdir / right);
-                    filter_reads(paired_reads_stream, ostream, filter, FILTER_READS_BUFF_SIZE, args.nthreads);
+                    filter_reads(paired_reads_stream, ostream, *cqf, hasher, args, filter_threads, pool.get());
                     outlib.push_back_paired(left, right);
                 } else {
                     std::filesystem::path left = args.workdir / (to_string(i + 1) + ".1.fastq");
                     std::filesystem::path right = args.workdir / (to_string(i + 1) + ".2.fastq");
 
                     io::OFastqPairedStream ostream(left, right);
-                    filter_reads(paired_reads_stream, ostream, filter, FILTER_READS_BUFF_SIZE, args.nthreads);
+                    filter_reads(paired_reads_stream, ostream, *cqf, hasher, args, filter_threads, pool.get());
                     outlib.push_back_paired(left, right);
                 }
             }
@@ -216,17 +301,16 @@ int main(int argc, char* argv[]) {
                 io::SingleStream single_reads_stream =
                         io::single_easy_reader(dataset[i], /*followed_by_rc*/ false, /*including_paired_reads*/ false,  /* handle Ns */ false,
                                                flags);
-                io::CoverageFilter<io::SingleRead, SeqHasher> filter(args.k, hasher, cqf, args.thr + 1);
                 // FIXME: we cannot use unique_ptr here as OFasta / OFastq streams do not have common base class :(
                 if (args.drop_names || args.drop_quality) {
                     std::filesystem::path single = to_string(i + 1) + ".s.fasta";
                     io::OFastqReadStream ostream(args.workdir / single);
-                    filter_reads(single_reads_stream, ostream, filter, FILTER_READS_BUFF_SIZE, args.nthreads);
+                    filter_reads(single_reads_stream, ostream, *cqf, hasher, args, filter_threads, pool.get());
                     outlib.push_back_single(single);
                 } else {
                     std::filesystem::path single = args.workdir / (to_string(i + 1) + ".s.fastq");
                     io::OFastqReadStream ostream(single);
-                    filter_reads(single_reads_stream, ostream, filter, FILTER_READS_BUFF_SIZE, args.nthreads);
+                    filter_reads(single_reads_stream, ostream, *cqf, hasher, args, filter_threads, pool.get());
                     outlib.push_back_single(single);
                 }
             }
@@ -235,23 +319,25 @@ int main(int argc, char* argv[]) {
                 io::SingleStream single_reads_stream =
                         io::merged_easy_reader(dataset[i], /*followed_by_rc*/ false, /*handle_Ns*/ false,
                                                flags);
-                io::CoverageFilter<io::SingleRead, SeqHasher> filter(args.k, hasher, cqf, args.thr + 1);
                 // FIXME: we cannot use unique_ptr here as OFasta / OFastq streams do not have common base class :(
                 if (args.drop_names || args.drop_quality) {
                     std::filesystem::path merged = args.workdir / (to_string(i + 1) + ".m.fasta");
                     io::OFastaReadStream ostream(merged);
-                    filter_reads(single_reads_stream, ostream, filter, FILTER_READS_BUFF_SIZE, args.nthreads);
+                    filter_reads(single_reads_stream, ostream, *cqf, hasher, args, filter_threads, pool.get());
                     outlib.push_back_merged(merged);
                 } else {
                     std::filesystem::path merged = to_string(i + 1) + ".m.fastq";
                     io::OFastqReadStream ostream(args.workdir / merged);
-                    filter_reads(single_reads_stream, ostream, filter, FILTER_READS_BUFF_SIZE, args.nthreads);
+                    filter_reads(single_reads_stream, ostream, *cqf, hasher, args, filter_threads, pool.get());
                     outlib.push_back_merged(merged);
                 }
             }
 
             outdataset.push_back(outlib);
         }
+        if (args.diginorm && cqf->full()) {
+            WARN("Kmer counter overflowed, increase --diginorm-kmers for more accurate normalization");
+        }
         INFO("Filtering finished");
         std::filesystem::path fname = args.workdir / "dataset.yaml";
         INFO("Saving filtered dataset description to " << fname);
@@ -0,0 +1,109 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "utils/logger/logger.hpp"
+#include "utils/logger/log_writers.hpp"
+#include "adt/bf.hpp"
+
+#include <vector>
+
+#define XXH_INLINE_ALL
+#include "xxh/xxhash.h"
+
+#include <gtest/gtest.h>
+
+static uint64_t Hash(const uint64_t &key, uint64_t seed) {
+    return XXH3_64bits_withSeed(&key, sizeof(key), seed);
+}
+
+static const size_t N = 100000;
+
+template<class Filter>
+double FalsePositiveRate(const Filter &filter) {
+    size_t fp = 0;
+    for (uint64_t i = N; i < 2 * N; ++i)
+        fp += filter.lookup(i) > 0;
+    return double(fp) / double(N);
+}
+
+TEST(BloomFilter, Blocked) {
+    bf::blocked_bloom_filter<uint64_t> filter(Hash, 16 * N, 8);
+    size_t added = 0;
+    for (uint64_t i = 0; i < N; ++i)
+        added += filter.add(i);
+    // add() reports false positives as duplicates
+    EXPECT_GT(added, N - N / 100);
+    for (uint64_t i = 0; i < N; ++i) {
+        EXPECT_FALSE(filter.add(i));
+        EXPECT_EQ(filter.lookup(i), 1);
+    }
+
+    double fpr = FalsePositiveRate(filter);
+    INFO("Blocked Bloom filter FPR: " << fpr);
+    EXPECT_LT(fpr, 0.002);
+
+    bf::blocked_bloom_filter<uint64_t> other(Hash, 16 * N, 8);
+    other.add(2 * N);
+    filter.merge(other);
+    EXPECT_EQ(filter.lookup(2 * N), 1);
+
+    filter.clear();
+    EXPECT_EQ(FalsePositiveRate(filter), 0);
+}
+
+TEST(BloomFilter, BlockedFalsePositiveRateIsTunable) {
+    bf::blocked_bloom_filter<uint64_t> small(Hash, 4 * N, 3), large(Hash, 32 * N, 6);
+    for (uint64_t i = 0; i < N; ++i) {
+        small.add(i);
+        large.add(i);
+    }
+
+    EXPECT_LT(FalsePositiveRate(large), FalsePositiveRate(small));
+}
+
+TEST(BloomFilter, BlockedCounting) {
+    bf::blocked_counting_bloom_filter<uint64_t, 4> filter(Hash, 8 * N, 4);
+    for (uint64_t i = 0; i < N; ++i)
+        for (uint64_t j = 0; j < i % 20; ++j)
+            filter.add(i);
+
+    // Never underestimates, saturates at 15
+    for (uint64_t i = 0; i < N; ++i)
+        EXPECT_GE(filter.lookup(i), std::min<size_t>(i % 20, 15));
+    EXPECT_LT(FalsePositiveRate(filter), 0.05);
+    EXPECT_GT(filter.load_factor(), 0);
+
+    bf::blocked_counting_bloom_filter<uint64_t, 4> other(Hash, 8 * N, 4);
+    for (size_t j = 0; j < 3; ++j)
+        other.add(1);
+    filter.merge(other);
+    EXPECT_GE(filter.lookup(1), 4);
+}
+
+TEST(BloomFilter, BlockedBitCounting) {
+    bf::blocked_bitcounting_bloom_filter<uint64_t, 4> filter(Hash, 8 * N, 4);
+    for (uint64_t i = 0; i < N; ++i)
+        for (uint64_t j = 0; j < i % 6; ++j)
+            filter.add(i);
+
+    for (uint64_t i = 0; i < N; ++i)
+        EXPECT_GE(filter.lookup(i), std::min<size_t>(i % 6, 4));
+}
+
+void create_console_logger() {
+    using namespace logging;
+
+    logger *lg = create_logger("");
+    lg->add_writer(std::make_shared<console_writer>());
+    attach_logger(lg);
+}
+
+GTEST_API_ int main(int argc, char **argv) {
+  create_console_logger();
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
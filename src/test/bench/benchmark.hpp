@@ -0,0 +1,142 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "utils/parallel/openmp_wrapper.h"
+#include "utils/perf/perfcounter.hpp"
+#include "utils/logger/logger.hpp"
+#include "utils/verify.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// A single kernel under measurement. Setup is called once before all the
+// runs (outside of the timed region), run should process the whole synthetic
+// workload using nthreads threads and return the number of items processed.
+class Benchmark {
+public:
+    Benchmark(std::string name, std::string unit)
+            : name_(std::move(name)), unit_(std::move(unit)) {}
+
+    virtual ~Benchmark() {}
+
+    const std::string &name() const { return name_; }
+    const std::string &unit() const { return unit_; }
+
+    virtual void Setup() {}
+    virtual size_t Run(unsigned nthreads) = 0;
+    virtual void TearDown() {}
+
+private:
+    std::string name_;
+    std::string unit_;
+};
+
+typedef std::vector<std::unique_ptr<Benchmark>> Benchmarks;
+
+struct Measurement {
+    std::string name;
+    std::string unit;
+    unsigned nthreads;
+    size_t items;
+    double best_time;
+    double median_time;
+
+    double throughput() const {
+        return best_time > 0 ? (double) items / best_time : 0.;
+    }
+};
+
+enum class OutputFormat {
+    Text,
+    TSV,
+    JSON
+};
+
+class Runner {
+public:
+    Runner(std::vector<unsigned> threads, unsigned repetitions)
+            : threads_(std::move(threads)), repetitions_(std::max(repetitions, 1u)) {}
+
+    std::vector<Measurement> Run(Benchmark &b) const {
+        std::vector<Measurement> res;
+        INFO("Setting up " << b.name());
+        b.Setup();
+        for (unsigned nthreads : threads_) {
+            omp_set_num_threads((int) nthreads);
+            // Warm up caches and allocator, this run is not measured
+            size_t items = b.Run(nthreads);
+            std::vector<double> times;
+            for (unsigned i = 0; i < repetitions_; ++i) {
+                utils::perf_counter pc;
+                size_t cur = b.Run(nthreads);
+                times.push_back(pc.time());
+                VERIFY_MSG(cur == items, "Benchmark " << b.name() << " is not reproducible");
+            }
+            std::sort(times.begin(), times.end());
+            res.push_back({ b.name(), b.unit(), nthreads, items,
+                            times.front(), times[times.size() / 2] });
+            INFO(b.name() << ", " << nthreads << " threads: "
+                 << res.back().throughput() << " " << b.unit() << "/s");
+        }
+        b.TearDown();
+        return res;
+    }
+
+private:
+    std::vector<unsigned> threads_;
+    unsigned repetitions_;
+};
+
+inline void Report(std::ostream &os, const std::vector<Measurement> &results, OutputFormat format) {
+    switch (format) {
+        case OutputFormat::Text:
+            os << std::left << std::setw(28) << "benchmark" << std::right
+               << std::setw(8) << "threads" << std::setw(14) << "items"
+               << std::setw(12) << "best, s" << std::setw(12) << "median, s"
+               << std::setw(16) << "throughput" << "  unit\n";
+            for (const auto &m : results)
+                os << std::left << std::setw(28) << m.name << std::right
+                   << std::setw(8) << m.nthreads << std::setw(14) << m.items
+                   << std::fixed << std::setprecision(4)
+                   << std::setw(12) << m.best_time << std::setw(12) << m.median_time
+                   << std::setprecision(1) << std::setw(16) << m.throughput()
+                   << "  " << m.unit << "/s\n";
+            break;
+        case OutputFormat::TSV:
+            os << "benchmark\tthreads\titems\tbest_time\tmedian_time\tthroughput\tunit\n";
+            for (const auto &m : results)
+                os << m.name << '\t' << m.nthreads << '\t' << m.items << '\t'
+                   << m.best_time << '\t' << m.median_time << '\t'
+                   << m.throughput() << '\t' << m.unit << "/s\n";
+            break;
+        case OutputFormat::JSON:
+            os << "[\n";
+            for (size_t i = 0; i < results.size(); ++i) {
+                const auto &m = results[i];
+                os << "  {\"benchmark\": \"" << m.name << "\", "
+                   << "\"threads\": " << m.nthreads << ", "
+                   << "\"items\": " << m.items << ", "
+                   << "\"best_time\": " << m.best_time << ", "
+                   << "\"median_time\": " << m.median_time << ", "
+                   << "\"throughput\": " << m.throughput() << ", "
+                   << "\"unit\": \"" << m.unit << "/s\"}"
+                   << (i + 1 < results.size() ? ",\n" : "\n");
+            }
+            os << "]\n";
+            break;
+    }
+}
+
+}
@@ -0,0 +1,567 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+// Microbenchmarks for the hot kernels of the assembler. All the workloads are
+// synthetic and generated from a fixed seed, so the numbers are comparable
+// between the runs and between the revisions.
+
+#include "benchmark.hpp"
+
+#include "alignment/pacbio/gap_dijkstra.hpp"
+#include "io/reads/fasta_fastq_gz_parser.hpp"
+#include "io/reads/rc_reader_wrapper.hpp"
+#include "io/reads/read_stream_vector.hpp"
+#include "io/reads/vector_reader.hpp"
+#include "kmer_index/kmer_mph/kmer_splitter.hpp"
+#include "modules/graph_construction.hpp"
+#include "paired_info/concurrent_pair_info_buffer.hpp"
+#include "pipeline/graph_pack.hpp"
+#include "pipeline/graph_pack_helpers.h"
+#include "pipeline/sequence_mapper_gp_api.hpp"
+#include "sequence/rtseq.hpp"
+
+#include "utils/filesystem/temporary.hpp"
+#include "utils/logger/log_writers.hpp"
+#include "utils/segfault_handler.hpp"
+
+#include <clipp/clipp.h>
+#include <zlib.h>
+
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using namespace debruijn_graph;
+
+namespace bench {
+
+struct Params {
+    double scale = 1.0;
+    uint64_t seed = 42;
+    std::filesystem::path workdir;
+};
+
+static size_t Scaled(const Params &p, size_t n) {
+    return std::max<size_t>(1, size_t((double) n * p.scale));
+}
+
+// Random genome with a number of mutated copies of its own fragments, so the
+// resulting de Bruijn graph is not just a single isolated edge. Genomes are
+// never shorter than MIN_GENOME_LENGTH, whatever the scale is
+static std::string RandomGenome(std::mt19937_64 &rnd, size_t len) {
+    static const char nucls[] = "ACGT";
+    // Longer than the longest repeat copied around
+    const size_t MIN_GENOME_LENGTH = 10000;
+    len = std::max(len, MIN_GENOME_LENGTH);
+
+    std::string genome(len, 'A');
+    for (char &c : genome)
+        c = nucls[rnd() & 3];
+
+    std::uniform_int_distribution<size_t> pos(0, len - 2001);
+    for (size_t r = 0; r < len / 5000; ++r) {
+        size_t from = pos(rnd), to = pos(rnd);
+        std::string repeat = genome.substr(from, 500 + rnd() % 1500);
+        for (size_t i = 0; i < repeat.size(); i += 50 + rnd() % 150)
+            repeat[i] = nucls[rnd() & 3];
+        genome.replace(to, repeat.size(), repeat);
+    }
+
+    return genome;
+}
+
+static std::string Mutate(std::mt19937_64 &rnd, std::string s, double error_rate) {
+    static const char nucls[] = "ACGT";
+    std::bernoulli_distribution error(error_rate);
+    for (char &c : s)
+        if (error(rnd))
+            c = nucls[rnd() & 3];
+    return s;
+}
+
+static std::vector<std::string> SampleReads(std::mt19937_64 &rnd, const std::string &genome,
+                                            size_t count, size_t len, double error_rate) {
+    std::uniform_int_distribution<size_t> pos(0, genome.size() - len);
+    std::vector<std::string> reads;
+    reads.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string read = Mutate(rnd, genome.substr(pos(rnd), len), error_rate);
+        if (rnd() & 1)
+            read = ReverseComplement(read);
+        reads.push_back(std::move(read));
+    }
+
+    return reads;
+}
+
+// Graph constructed from error-free reads over a synthetic genome, shared
+// between all the graph-based kernels and built on first request only
+class GraphFixture {
+public:
+    static const unsigned K = 55;
+
+    GraphFixture(const Params &p)
+            : rnd_(p.seed),
+              genome_(RandomGenome(rnd_, Scaled(p, 1000000))),
+              gp_(K, p.workdir, 0) {
+        INFO("Constructing graph over " << genome_.size() << " bp synthetic genome");
+        std::vector<io::SingleRead> reads;
+        for (const auto &r : SampleReads(rnd_, genome_, genome_.size() / 25, 150, 0))
+            reads.emplace_back("read_" + std::to_string(reads.size()), r);
+        // Make sure every position of the genome is covered
+        for (size_t i = 0; i + 150 <= genome_.size(); i += 100)
+            reads.emplace_back("tile_" + std::to_string(i), genome_.substr(i, 150));
+
+        auto workdir = fs::tmp::make_temp_dir(p.workdir, "graph");
+        io::ReadStreamList<io::SingleRead> streams(io::RCWrap<io::SingleRead>(io::VectorReadStream<io::SingleRead>(reads)));
+        ConstructGraphWithCoverage(config::debruijn_config::construction(), workdir, streams,
+                                   gp_.get_mutable<Graph>(), gp_.get_mutable<EdgeIndex<Graph>>(),
+                                   gp_.get_mutable<omnigraph::FlankingCoverage<Graph>>());
+        gp_.get_mutable<KmerMapper<Graph>>().Attach();
+        EnsureBasicMapping(gp_);
+
+        const Graph &g = graph();
+        for (EdgeId e : g.edges())
+            edges_.push_back(e);
+        INFO("Graph has " << g.size() << " vertices and " << edges_.size() << " edges");
+    }
+
+    const Graph &graph() const { return gp_.get<Graph>(); }
+    const graph_pack::GraphPack &gp() const { return gp_; }
+    const std::string &genome() const { return genome_; }
+    const std::vector<EdgeId> &edges() const { return edges_; }
+
+private:
+    std::mt19937_64 rnd_;
+    std::string genome_;
+    graph_pack::GraphPack gp_;
+    std::vector<EdgeId> edges_;
+};
+
+class FixtureHolder {
+public:
+    FixtureHolder(const Params &p) : p_(p) {}
+
+    const GraphFixture &get() {
+        if (!fixture_)
+            fixture_.reset(new GraphFixture(p_));
+        return *fixture_;
+    }
+
+private:
+    const Params &p_;
+    std::unique_ptr<GraphFixture> fixture_;
+};
+
+class RtSeqHashBenchmark : public Benchmark {
+public:
+    RtSeqHashBenchmark(const Params &p)
+            : Benchmark("rtseq_shift_hash", "kmers"), p_(p) {}
+
+    void Setup() override {
+        std::mt19937_64 rnd(p_.seed);
+        std::string genome = RandomGenome(rnd, Scaled(p_, 4000000));
+        for (size_t i = 0; i + 10000 <= genome.size(); i += 10000)
+            chunks_.emplace_back(genome.substr(i, 10000));
+    }
+
+    size_t Run(unsigned) override {
+        const unsigned k = 55;
+        size_t items = 0;
+        uint64_t checksum = 0;
+#       pragma omp parallel for schedule(guided) reduction(+:items) reduction(^:checksum)
+        for (size_t i = 0; i < chunks_.size(); ++i) {
+            const Sequence &seq = chunks_[i];
+            RtSeq kmer = seq.start<RtSeq>(k) >> 'A';
+            for (size_t j = k - 1; j < seq.size(); ++j) {
+                kmer <<= seq[j];
+                checksum ^= kmer.GetHash();
+                items += 1;
+            }
+        }
+        checksum_ = checksum;
+        return items;
+    }
+
+    void TearDown() override {
+        DEBUG("Checksum " << checksum_);
+        chunks_.clear();
+    }
+
+private:
+    const Params &p_;
+    std::vector<Sequence> chunks_;
+    uint64_t checksum_ = 0;
+};
+
+class BenchSortingSplitter : public kmers::KMerSortingSplitter<RtSeq> {
+public:
+    BenchSortingSplitter(const std::filesystem::path &workdir, unsigned K,
+                         const std::vector<Sequence> &reads)
+            : kmers::KMerSortingSplitter<RtSeq>(workdir, K), reads_(reads) {}
+
+    RawKMers Split(size_t num_files, unsigned nthreads) override {
+        auto out = PrepareBuffers(num_files, nthreads, 16 * 1024 * 1024);
+
+        const size_t batch = 4096;
+        unsigned K = this->K();
+        for (size_t start = 0; start < reads_.size(); start += batch) {
+            size_t end = std::min(reads_.size(), start + batch);
+#           pragma omp parallel for schedule(guided)
+            for (size_t i = start; i < end; ++i) {
+                const Sequence &seq = reads_[i];
+                if (seq.size() < K)
+                    continue;
+
+                unsigned thread_id = omp_get_thread_num();
+                RtSeq kmer = seq.start<RtSeq>(K) >> 'A';
+                for (size_t j = K - 1; j < seq.size(); ++j) {
+                    kmer <<= seq[j];
+                    push_back_internal(kmer, thread_id);
+                }
+            }
+            DumpBuffers(out);
+        }
+        ClearBuffers();
+
+        return out;
+    }
+
+private:
+    const std::vector<Sequence> &reads_;
+};
+
+class KMerSplitterBenchmark : public Benchmark {
+public:
+    KMerSplitterBenchmark(const Params &p)
+            : Benchmark("kmer_sorting_splitter", "kmers"), p_(p) {}
+
+    void Setup() override {
+        std::mt19937_64 rnd(p_.seed);
+        std::string genome = RandomGenome(rnd, Scaled(p_, 1000000));
+        for (const auto &r : SampleReads(rnd, genome, Scaled(p_, 200000), 150, 0.01))
+            reads_.emplace_back(r);
+    }
+
+    size_t Run(unsigned nthreads) override {
+        const unsigned k = 31;
+        BenchSortingSplitter splitter(p_.workdir, k, reads_);
+        auto files = splitter.Split(16 * nthreads, nthreads);
+        return reads_.size() * (150 - k + 1);
+    }
+
+    void TearDown() override {
+        reads_.clear();
+    }
+
+private:
+    const Params &p_;
+    std::vector<Sequence> reads_;
+};
+
+class SequenceMapperBenchmark : public Benchmark {
+public:
+    SequenceMapperBenchmark(const Params &p, FixtureHolder &fixture)
+            : Benchmark("sequence_mapper", "reads"), p_(p), fixture_(fixture) {}
+
+    void Setup() override {
+        const auto &f = fixture_.get();
+        std::mt19937_64 rnd(p_.seed);
+        for (const auto &r : SampleReads(rnd, f.genome(), Scaled(p_, 200000), 150, 0.01))
+            reads_.emplace_back(r);
+        mapper_ = MapperInstance(f.gp());
+    }
+
+    size_t Run(unsigned) override {
+        size_t mapped = 0;
+#       pragma omp parallel for schedule(guided) reduction(+:mapped)
+        for (size_t i = 0; i < reads_.size(); ++i)
+            mapped += mapper_->MapSequence(reads_[i]).size();
+        mapped_ = mapped;
+        return reads_.size();
+    }
+
+    void TearDown() override {
+        DEBUG("Mapped ranges " << mapped_);
+        reads_.clear();
+        mapper_.reset();
+    }
+
+private:
+    const Params &p_;
+    FixtureHolder &fixture_;
+    std::vector<Sequence> reads_;
+    std::shared_ptr<BasicSequenceMapper<Graph, EdgeIndex<Graph>>> mapper_;
+    size_t mapped_ = 0;
+};
+
+class PairedBufferBenchmark : public Benchmark {
+    struct PairPoint {
+        EdgeId e1, e2;
+        omnigraph::de::RawPoint p;
+    };
+
+public:
+    PairedBufferBenchmark(const Params &p, FixtureHolder &fixture)
+            : Benchmark("concurrent_paired_buffer", "points"), p_(p), fixture_(fixture) {}
+
+    void Setup() override {
+        const auto &edges = fixture_.get().edges();
+        std::mt19937_64 rnd(p_.seed);
+        // Skewed edge choice, so some edge pairs get contended a lot
+        std::geometric_distribution<size_t> offset(0.05);
+        std::uniform_int_distribution<size_t> edge(0, edges.size() - 1);
+        std::uniform_int_distribution<int> dist(0, 500);
+        size_t count = Scaled(p_, 2000000);
+        points_.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            size_t e1 = edge(rnd);
+            size_t e2 = (e1 + offset(rnd)) % edges.size();
+            points_.push_back({ edges[e1], edges[e2],
+                                omnigraph::de::RawPoint((float) dist(rnd), 1.f) });
+        }
+    }
+
+    size_t Run(unsigned) override {
+        omnigraph::de::ConcurrentPairedInfoBuffer<Graph> buffer(fixture_.get().graph());
+#       pragma omp parallel for schedule(guided)
+        for (size_t i = 0; i < points_.size(); ++i)
+            buffer.Add(points_[i].e1, points_[i].e2, points_[i].p);
+        return points_.size();
+    }
+
+    void TearDown() override {
+        points_.clear();
+    }
+
+private:
+    const Params &p_;
+    FixtureHolder &fixture_;
+    std::vector<PairPoint> points_;
+};
+
+class GapDijkstraBenchmark : public Benchmark {
+    struct Query {
+        EdgeId e;
+        int pos;
+        std::string s;
+    };
+
+public:
+    GapDijkstraBenchmark(const Params &p, FixtureHolder &fixture)
+            : Benchmark("gap_dijkstra", "queries"), p_(p), fixture_(fixture) {}
+
+    void Setup() override {
+        const auto &f = fixture_.get();
+        const Graph &g = f.graph();
+        const auto &edges = f.edges();
+        std::mt19937_64 rnd(p_.seed);
+        std::uniform_int_distribution<size_t> edge(0, edges.size() - 1);
+        const size_t len = 1000;
+        for (size_t i = 0, n = Scaled(p_, 200); i < n; ++i) {
+            // Random walk through the graph, it spells the query sequence
+            EdgeId e = edges[edge(rnd)];
+            int pos = int(rnd() % g.length(e));
+            std::string s = g.EdgeNucls(e).Subseq(pos, g.length(e)).str();
+            EdgeId cur = e;
+            while (s.size() < len && g.OutgoingEdgeCount(g.EdgeEnd(cur))) {
+                auto out = g.OutgoingEdges(g.EdgeEnd(cur));
+                auto it = out.begin();
+                std::advance(it, rnd() % g.OutgoingEdgeCount(g.EdgeEnd(cur)));
+                cur = *it;
+                s += g.EdgeNucls(cur).Subseq(0, g.length(cur)).str();
+            }
+            if (s.size() > len)
+                s.resize(len);
+            queries_.push_back({ e, pos, Mutate(rnd, s, 0.05) });
+        }
+    }
+
+    size_t Run(unsigned) override {
+        const Graph &g = fixture_.get().graph();
+        sensitive_aligner::EndsClosingConfig cfg;
+        int total = 0;
+#       pragma omp parallel for schedule(dynamic) reduction(+:total)
+        for (size_t i = 0; i < queries_.size(); ++i) {
+            const auto &q = queries_[i];
+            sensitive_aligner::DijkstraEndsReconstructor algo(g, cfg, q.s, q.e, q.pos,
+                                                              int(q.s.size() / 10));
+            algo.CloseGap();
+            total += algo.edit_distance();
+        }
+        total_ = total;
+        return queries_.size();
+    }
+
+    void TearDown() override {
+        DEBUG("Total edit distance " << total_);
+        queries_.clear();
+    }
+
+private:
+    const Params &p_;
+    FixtureHolder &fixture_;
+    std::vector<Query> queries_;
+    int total_ = 0;
+};
+
+class GzParserBenchmark : public Benchmark {
+public:
+    GzParserBenchmark(const Params &p)
+            : Benchmark("fasta_fastq_gz_parser", "reads"), p_(p) {}
+
+    void Setup() override {
+        std::mt19937_64 rnd(p_.seed);
+        std::string genome = RandomGenome(rnd, Scaled(p_, 1000000));
+        auto reads = SampleReads(rnd, genome, Scaled(p_, 200000), 150, 0.01);
+
+        file_ = p_.workdir / "reads.fastq.gz";
+        gzFile f = gzopen(file_.c_str(), "wb");
+        VERIFY_MSG(f, "Cannot open " << file_ << " for writing");
+        std::string qual(150, 'I');
+        for (size_t i = 0; i < reads.size(); ++i) {
+            std::string rec = "@read_" + std::to_string(i) + "\n" + reads[i] + "\n+\n" + qual + "\n";
+            gzwrite(f, rec.data(), (unsigned) rec.size());
+        }
+        gzclose(f);
+        count_ = reads.size();
+    }
+
+    // Every thread parses its own copy of the whole file
+    size_t Run(unsigned nthreads) override {
+        size_t items = 0;
+#       pragma omp parallel for reduction(+:items)
+        for (unsigned i = 0; i < nthreads; ++i) {
+            io::FastaFastqGzParser parser(file_);
+            io::SingleRead r;
+            while (!parser.eof()) {
+                parser >> r;
+                items += 1;
+            }
+        }
+        VERIFY(items == count_ * nthreads);
+        return items;
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(file_);
+    }
+
+private:
+    const Params &p_;
+    std::filesystem::path file_;
+    size_t count_ = 0;
+};
+
+}
+
+void create_console_logger() {
+    using namespace logging;
+
+    logger *lg = create_logger("");
+    lg->add_writer(std::make_shared<console_writer>());
+    attach_logger(lg);
+}
+
+static std::vector<unsigned> ParseThreads(const std::string &s) {
+    std::vector<unsigned> res;
+    std::istringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        res.push_back((unsigned) std::stoul(item));
+    return res;
+}
+
+int main(int argc, char *argv[]) {
+    utils::segfault_handler sh;
+    create_console_logger();
+
+    using namespace clipp;
+    bench::Params p;
+    unsigned repetitions = 3;
+    std::string threads, filter, format = "text", workdir = "bench_tmp", output;
+    bool list = false, print_help = false;
+    auto cli = (
+        (option("-t", "--threads") & value("list", threads)) % "Comma-separated list of thread counts (default: 1,2,4,... up to # of cores)",
+        (option("-r", "--repetitions") & integer("value", repetitions)) % "Number of measured runs (default: 3)",
+        (option("-f", "--filter") & value("substring", filter)) % "Run only benchmarks with matching name",
+        (option("--format") & value("text|tsv|json", format)) % "Report format (default: text)",
+        (option("-s", "--scale") & number("value", p.scale)) % "Workload size multiplier (default: 1.0)",
+        (option("--seed") & integer("value", p.seed)) % "Random seed for synthetic data (default: 42)",
+        (option("-w", "--workdir") & value("dir", workdir)) % "Directory for temporary files",
+        (option("-o", "--output") & value("file", output)) % "Write report to file instead of stdout",
+        (option("-l", "--list").set(list)) % "List available benchmarks",
+        (option("-h", "--help").set(print_help)) % "Show help"
+    );
+
+    auto result = parse(argc, argv, cli);
+    if (!result || print_help) {
+        std::cout << make_man_page(cli, argv[0]);
+        return print_help ? 0 : 1;
+    }
+
+    if (!(p.scale > 0)) {
+        std::cerr << "ERROR: Workload scale should be positive, got " << p.scale << std::endl;
+        return 1;
+    }
+
+    bench::OutputFormat fmt;
+    if (format == "text")
+        fmt = bench::OutputFormat::Text;
+    else if (format == "tsv")
+        fmt = bench::OutputFormat::TSV;
+    else if (format == "json")
+        fmt = bench::OutputFormat::JSON;
+    else {
+        std::cerr << "ERROR: Unknown report format " << format << std::endl;
+        return 1;
+    }
+
+    std::vector<unsigned> nthreads;
+    if (threads.empty()) {
+        for (unsigned t = 1; t < (unsigned) omp_get_max_threads(); t *= 2)
+            nthreads.push_back(t);
+        nthreads.push_back(omp_get_max_threads());
+    } else
+        nthreads = ParseThreads(threads);
+
+    std::filesystem::create_directories(workdir);
+    auto tmpdir = fs::tmp::make_temp_dir(workdir, "bench");
+    p.workdir = tmpdir->dir();
+
+    bench::FixtureHolder fixture(p);
+    bench::Benchmarks benchmarks;
+    benchmarks.emplace_back(new bench::RtSeqHashBenchmark(p));
+    benchmarks.emplace_back(new bench::KMerSplitterBenchmark(p));
+    benchmarks.emplace_back(new bench::SequenceMapperBenchmark(p, fixture));
+    benchmarks.emplace_back(new bench::PairedBufferBenchmark(p, fixture));
+    benchmarks.emplace_back(new bench::GapDijkstraBenchmark(p, fixture));
+    benchmarks.emplace_back(new bench::GzParserBenchmark(p));
+
+    if (list) {
+        for (const auto &b : benchmarks)
+            std::cout << b->name() << " (" << b->unit() << ")\n";
+        return 0;
+    }
+
+    bench::Runner runner(nthreads, repetitions);
+    std::vector<bench::Measurement> results;
+    for (const auto &b : benchmarks) {
+        if (b->name().find(filter) == std::string::npos)
+            continue;
+        auto res = runner.Run(*b);
+        results.insert(results.end(), res.begin(), res.end());
+    }
+
+    if (output.empty())
+        bench::Report(std::cout, results, fmt);
+    else {
+        std::ofstream os(output);
+        bench::Report(os, results, fmt);
+    }
+
+    return 0;
+}
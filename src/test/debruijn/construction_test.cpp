@@ -12,12 +12,16 @@
 #include "io/reads/rc_reader_wrapper.hpp"
 #include "io/reads/read_stream_vector.hpp"
 #include "io/reads/vector_reader.hpp"
+#include "kmer_index/kmer_mph/kmer_index_builder.hpp"
+#include "kmer_index/kmer_mph/kmer_splitters.hpp"
+#include "kmer_index/ph_map/storing_traits.hpp"
 #include "modules/graph_construction.hpp"
 #include "pipeline/graph_pack.hpp" // FIXME: get rid of it
 #include "utils/filesystem/temporary.hpp"
 
 #include <gtest/gtest.h>
 
+#include <random>
 #include <set>
 #include <vector>
 
@@ -94,6 +98,84 @@ TEST_F( GraphConstruction, TestKmerFreeIndex ) {
     CheckIndex(reads, tmp_folder(), 5);
 }
 
+TEST_F( GraphConstruction, WindowedCoverageFilling ) {
+    const unsigned k = 21;
+    // Random genome with a repeat, so there are several long edges
+    std::mt19937 rnd(17);
+    std::string genome(3000, 'A');
+    for (char &c : genome)
+        c = nucl((char) (rnd() % 4));
+    genome.replace(2000, 300, genome.substr(500, 300));
+
+    std::vector<std::string> reads;
+    for (size_t i = 0; i + 150 <= genome.size(); i += 7)
+        reads.push_back(genome.substr(i, 150));
+
+    typedef io::VectorReadStream<io::SingleRead> RawStream;
+    graph_pack::GraphPack gp(k, tmp_folder(), 0);
+    auto workdir = fs::tmp::make_temp_dir(gp.workdir(), "tests");
+    io::ReadStreamList<io::SingleRead> streams(io::RCWrap<io::SingleRead>(RawStream(MakeReads(reads))));
+    auto &graph = gp.get_mutable<Graph>();
+    auto &flanking_cov = gp.get_mutable<omnigraph::FlankingCoverage<Graph>>();
+    KMerFiles kmers = ConstructGraphWithIndex(config::debruijn_config::construction(), workdir, streams,
+                                              graph, gp.get_mutable<EdgeIndex<Graph>>());
+
+    using CoverageMap = kmers::PerfectHashMap<RtSeq, uint32_t, kmers::slim_kmer_index_traits<RtSeq>, kmers::DefaultStoring>;
+    CoverageMap coverage_map(k + 1);
+    kmers::CoverageHashMapBuilder().BuildIndex(coverage_map, kmers, streams);
+
+    auto fill = [&](size_t window) {
+        for (EdgeId e : graph.edges()) {
+            graph.data(e).set_raw_coverage(0);
+            graph.data(e).set_flanking_coverage(0);
+        }
+        GraphCoverageFiller<Graph, CoverageMap>(graph, k + 1, coverage_map,
+                                                flanking_cov, graph.coverage_index(), window).Fill(4);
+        std::vector<std::pair<unsigned, unsigned>> coverage;
+        for (EdgeId e : graph.edges())
+            coverage.emplace_back(graph.data(e).raw_coverage(), graph.data(e).flanking_coverage());
+        return coverage;
+    };
+
+    // Every edge split into several windows must give the same coverage
+    auto etalon = fill(0);
+    EXPECT_EQ(etalon, fill(7));
+    EXPECT_EQ(etalon, fill(50));
+}
+
+TEST_F( GraphConstruction, TestShardedKMerIndex ) {
+    const unsigned k = 21;
+    std::vector<std::string> reads;
+    for (size_t i = 0; i < 100; ++i) {
+        std::string read(150, 'A');
+        for (size_t j = 0; j < read.size(); ++j)
+            read[j] = nucl((char) ((i * 7919 + j * j * 31 + (j >> 2)) % 4));
+        reads.push_back(read);
+    }
+
+    typedef io::VectorReadStream<io::SingleRead> RawStream;
+    io::ReadStreamList<io::SingleRead> streams(RawStream(MakeReads(reads)));
+    auto workdir = fs::tmp::make_temp_dir(tmp_folder(), "tests");
+    using Splitter = kmers::DeBruijnReadKMerSplitter<io::SingleRead,
+                                                     kmers::StoringTypeFilter<kmers::SimpleStoring>>;
+    kmers::KMerDiskCounter<RtSeq> counter(workdir, Splitter(workdir, k, streams));
+
+    kmers::ShardingOptions opts;
+    opts.num_workers = 3;
+    kmers::KMerIndex<kmers::kmer_index_traits<RtSeq>> index;
+    auto storage = kmers::KMerIndexBuilder<decltype(index)>(8, 1).BuildIndexSharded(index, counter, opts);
+    EXPECT_EQ(storage.total_kmers(), index.size());
+
+    std::vector<bool> seen(index.size(), false);
+    for (size_t i = 0; i < storage.num_buckets(); ++i)
+        for (auto kmer : storage.bucket(i)) {
+            size_t idx = index.seq_idx(RtSeq(k, kmer.first));
+            ASSERT_LT(idx, index.size());
+            EXPECT_FALSE(seen[idx]);
+            seen[idx] = true;
+        }
+}
+
 TEST_F( GraphConstruction, SimpleTestEarlyPairedInfo ) {
     std::vector<MyPairedRead> paired_reads = {{"CCCAC", "CCACG"}, {"ACCAC", "CCACA"}};
     std::vector<MyEdge> edges = {"CCCA", "ACCA", "CCAC", "CACG", "CACA"};
@@ -6,6 +6,9 @@
 //***************************************************************************
 
 #include "assembly_graph/core/graph.hpp"
+#include "assembly_graph/dijkstra/dijkstra_helper.hpp"
+#include "assembly_graph/paths/path_length_oracle.hpp"
+#include "assembly_graph/paths/path_utils.hpp"
 
 #include <vector>
 #include <set>
@@ -107,3 +110,92 @@ TEST( GraphCore, SelfRCEdgeMerge ) {
     EXPECT_EQ(1u, g.OutgoingEdgeCount(v1));
     EXPECT_EQ(Sequence("AACGCTATTCACGTGAATAGCGTT"), g.EdgeNucls(g.GetUniqueOutgoingEdge(v1)));
 }
+
+TEST( GraphCore, DijkstraWorkspaceReuse ) {
+    typedef omnigraph::DijkstraHelper<Graph> DijkstraHelper;
+
+    Graph g(11);
+    auto data = createGraph(g, 5);
+    const auto &v = data.first;
+    // Every edge is 6 nucleotides long
+    for (size_t round = 0; round < 3; ++round) {
+        auto first = DijkstraHelper::CreateBoundedDijkstraWithTraceback(g, 20);
+        first.Run(v[0]);
+        {
+            // Simultaneously alive runs do not share the state
+            auto second = DijkstraHelper::CreateBoundedDijkstra(g, 20);
+            second.Run(v[2]);
+            EXPECT_FALSE(second.DistanceCounted(v[0]));
+            EXPECT_FALSE(second.DistanceCounted(v[1]));
+            EXPECT_EQ(0u, second.GetDistance(v[2]));
+            EXPECT_EQ(18u, second.GetDistance(v[5]));
+            EXPECT_EQ(4u, second.ReachedVertices().size());
+        }
+
+        EXPECT_EQ(4u, first.ReachedVertices().size());
+        EXPECT_FALSE(first.DistanceCounted(v[4]));
+        for (size_t i = 0; i < 4; ++i)
+            EXPECT_EQ(6 * i, first.GetDistance(v[i]));
+
+        size_t reached = 0;
+        for (const auto &entry : first.reached()) {
+            EXPECT_EQ(first.GetDistance(entry.first), entry.second);
+            reached += 1;
+        }
+        EXPECT_EQ(4u, reached);
+
+        std::vector<EdgeId> path = first.GetShortestPathTo(v[3]);
+        EXPECT_EQ(std::vector<EdgeId>(data.second.begin(), data.second.begin() + 3), path);
+        EXPECT_TRUE(first.GetShortestPathTo(v[4]).empty());
+    }
+}
+
+TEST( GraphCore, DijkstraEpochMap ) {
+    omnigraph::EpochMap<size_t> map;
+    // Sparse keys, enough to grow past the retained size
+    for (size_t size : { 10, 100000, 50, 100000 }) {
+        for (size_t i = 0; i < size; ++i) {
+            auto res = map.try_emplace(i * 1000003);
+            EXPECT_TRUE(res.second);
+            res.first = i;
+        }
+        EXPECT_FALSE(map.try_emplace(0).second);
+        for (size_t i = 0; i < size; ++i) {
+            const size_t *value = map.find(i * 1000003);
+            ASSERT_TRUE(value);
+            EXPECT_EQ(i, *value);
+        }
+        EXPECT_FALSE(map.find(size * 1000003));
+        EXPECT_FALSE(map.find(1));
+
+        map.clear();
+        EXPECT_FALSE(map.find(0));
+        EXPECT_FALSE(map.find((size - 1) * 1000003));
+    }
+}
+
+TEST( GraphCore, PathLengthOracle ) {
+    Graph g(11);
+    auto data = createGraph(g, 4);
+    const auto &v = data.first;
+    auto &e = data.second;
+    // Every edge is 6 nucleotides long, the loop makes v1 -> v3 paths of lengths 12 + 12 * i
+    g.AddEdge(v[2], v[1], Sequence("AAAAAAAAAAAAAAAAA"));
+
+    omnigraph::PathLengthOracle<Graph> oracle(g);
+    EXPECT_FALSE(oracle.HasPath(e[0], e[3], 0, 11));
+    EXPECT_TRUE(oracle.HasPath(e[0], e[3], 12, 12));
+    EXPECT_FALSE(oracle.HasPath(e[0], e[3], 13, 23));
+    EXPECT_TRUE(oracle.HasPath(e[0], e[3], 20, 100));
+    EXPECT_TRUE(oracle.HasPath(e[0], e[1], 0, 0));
+    EXPECT_FALSE(oracle.HasPath(e[3], e[0], 0, 100));
+    EXPECT_FALSE(oracle.HasPath(e[0], e[3], 12, 11));
+
+    // Agrees with the path enumeration
+    for (size_t lo = 0; lo < 80; lo += 5) {
+        for (size_t hi = lo; hi < 80; hi += 7) {
+            bool has_paths = !GetAllPathsBetweenEdges(g, e[0], e[3], lo, hi).empty();
+            EXPECT_EQ(has_paths, oracle.HasPath(e[0], e[3], lo, hi)) << lo << " " << hi;
+        }
+    }
+}
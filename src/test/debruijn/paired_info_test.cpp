@@ -7,6 +7,7 @@
 
 #include "random_graph.hpp"
 
+#include "paired_info/compressed_paired_info.hpp"
 #include "paired_info/index_point.hpp"
 #include "paired_info/paired_info_helpers.hpp"
 //#include "io/binary/paired_index.hpp"
@@ -66,15 +67,16 @@ using MockClIndex = PairedInfoIndexT<MockGraph>;
 using EdgeSet = std::set<MockIndex::EdgeId>;
 
 template<typename Index>
-EdgeSet GetNeighbours(const Index &pi, MockGraph::EdgeId e) {
-    EdgeSet result;
+std::set<typename Index::EdgeId> GetNeighbours(const Index &pi, typename Index::EdgeId e) {
+    std::set<typename Index::EdgeId> result;
     for (auto i : pi.Get(e))
         result.insert(i.first);
     return result;
 }
 
-EdgeSet GetHalfNeighbours(const MockIndex &pi, MockGraph::EdgeId e) {
-    EdgeSet result;
+template<typename Index>
+std::set<typename Index::EdgeId> GetHalfNeighbours(const Index &pi, typename Index::EdgeId e) {
+    std::set<typename Index::EdgeId> result;
     for (auto i : pi.GetHalf(e))
         result.insert(i.first);
     return result;
@@ -459,3 +461,77 @@ TEST(PairedInfo, RandomSymmetry) {
         }
     }
 }
+
+template<class Index, class Compressed, class Edges>
+void ExpectSameIndex(const Index &pi, const Compressed &cpi, const Edges &edges) {
+    EXPECT_EQ(pi.size(), cpi.size());
+    for (auto e1 : edges) {
+        EXPECT_EQ(pi.contains(e1), cpi.contains(e1));
+        EXPECT_EQ(GetNeighbours(pi, e1), GetNeighbours(cpi, e1));
+        EXPECT_EQ(GetHalfNeighbours(pi, e1), GetHalfNeighbours(cpi, e1));
+        for (auto e2 : edges) {
+            EXPECT_EQ(pi.contains(e1, e2), cpi.contains(e1, e2));
+            auto hist = pi.Get(e1, e2);
+            auto chist = cpi.Get(e1, e2);
+            ASSERT_EQ(hist.size(), chist.size());
+            for (auto i = hist.begin(), ci = chist.begin(); i != hist.end(); ++i, ++ci) {
+                auto p = *i, cp = *ci;
+                EXPECT_EQ(p.d, cp.d);
+                EXPECT_EQ(p.weight, cp.weight);
+                EXPECT_EQ(p.variance(), cp.variance());
+            }
+        }
+        for (auto i : cpi.Get(e1))
+            EXPECT_EQ(pi.Get(e1, i.first).Unwrap(), i.second.Unwrap());
+    }
+}
+
+TEST(PairedInfo, Compressed) {
+    MockGraph graph;
+    EdgeSet edges = {1, 2, 3, 4, 5, 7, 8, 9, 13, 14};
+
+    MockIndex pi(graph);
+    ExpectSameIndex(pi, CompressedUnclusteredPairedInfoIndexT<MockGraph>(pi), edges);
+    pi.Add(1, 8, {1, 3});
+    pi.Add(1, 3, {2, 2});
+    pi.Add(1, 3, {3, 1});
+    pi.Add(1, 1, {0, 1});
+    pi.Add(5, 13, {-7, 0.1});
+    pi.Add(14, 3, {100000, 2.5});
+    CompressedUnclusteredPairedInfoIndexT<MockGraph> cpi(pi);
+    ExpectSameIndex(pi, cpi, edges);
+    EXPECT_TRUE(cpi.Matches(pi));
+    EXPECT_TRUE(cpi.contains(9, 2));
+    EXPECT_FALSE(cpi.contains(7, 7));
+    pi.Add(1, 3, {2, 1});
+    EXPECT_FALSE(cpi.Matches(pi));
+
+    //Values which are not multiples of the quantum are kept exactly
+    MockClIndex cl(graph);
+    cl.Add(1, 3, {2.25, 1, 0.5});
+    cl.Add(1, 3, {10.3, 1.7, 1e-3});
+    cl.Add(7, 9, {-3.5, 1e9, 2});
+    cl.Add(8, 8, {0, 0.125, 0});
+    ExpectSameIndex(cl, CompressedPairedInfoIndexT<MockGraph>(cl), edges);
+}
+
+TEST(PairedInfo, CompressedRandom) {
+    debruijn_graph::Graph graph(55);
+    debruijn_graph::RandomGraph<debruijn_graph::Graph>(graph, /*max_size*/40).Generate(/*iterations*/300);
+
+    std::vector<EdgeId> edges;
+    for (EdgeId e : graph.edges())
+        edges.push_back(e);
+
+    //Dense enough to have more neighbours than a skip table block
+    srand(42);
+    TestIndex pi(graph);
+    for (EdgeId e1 : edges)
+        for (EdgeId e2 : edges)
+            for (size_t i = rand() % 4; i > 0; --i)
+                pi.Add(e1, e2, RawPoint(DEDistance(rand() % 1000 - 100), DEWeight(rand() % 8 / 4.0 + 0.1)));
+
+    CompressedUnclusteredPairedInfoIndexT<debruijn_graph::Graph> cpi(pi);
+    ExpectSameIndex(pi, cpi, edges);
+    EXPECT_TRUE(cpi.Matches(pi));
+}
@@ -301,6 +301,27 @@ TEST_F( Simplification,  BigComplexBulge ) {
     EXPECT_EQ(66, graph.size());
 }
 
+TEST_F( Simplification,  ParallelComplexBulge ) {
+    graph_pack::GraphPack gp(55, tmp_folder(), 0);
+    ASSERT_TRUE(graphio::ScanGraphPack("./src/test/debruijn/graph_fragments/complex_bulge/complex_bulge", gp));
+    auto &graph = gp.get_mutable<Graph>();
+
+    omnigraph::complex_br::ParallelComplexBulgeRemover<Graph> remover(graph, graph.k() * 5, 5, nullptr);
+    remover.Run();
+
+    EXPECT_EQ(8, graph.size());
+}
+
+TEST_F( Simplification,  ParallelBigComplexBulge ) {
+    graph_pack::GraphPack gp(55, tmp_folder(), 0);
+    ASSERT_TRUE(graphio::ScanGraphPack("./src/test/debruijn/graph_fragments/big_complex_bulge/big_complex_bulge", gp));
+    auto &graph = gp.get_mutable<Graph>();
+
+    omnigraph::complex_br::ParallelComplexBulgeRemover<Graph> remover(graph, graph.k() * 5, 5, nullptr);
+    remover.Run();
+    EXPECT_EQ(66, graph.size());
+}
+
 //Relative coverage removal tests
 
 void TestRelativeCoverageRemover(const std::string &path, const std::string &tmp_folder, size_t graph_size) {
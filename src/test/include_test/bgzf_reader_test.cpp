@@ -0,0 +1,336 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "io/sam/bgzf_reader.hpp"
+#include "io/sam/bam_parser.hpp"
+#include "utils/filesystem/temporary.hpp"
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <cstring>
+#include <fstream>
+#include <random>
+
+using namespace io;
+
+namespace {
+
+// The empty block every BGZF writer appends to mark the end of the stream
+const uint8_t BGZF_EOF[28] = { 31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 66, 67, 2, 0,
+                               27, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+void PutU16(std::string &out, uint16_t v) {
+    out.push_back(char(v & 0xFF));
+    out.push_back(char(v >> 8));
+}
+
+void PutU32(std::string &out, uint32_t v) {
+    PutU16(out, uint16_t(v & 0xFFFF));
+    PutU16(out, uint16_t(v >> 16));
+}
+
+// Compresses data into a single BGZF block
+std::string BGZFBlock(const std::string &data) {
+    std::string deflated(compressBound(uLong(data.size())) + 16, '\0');
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    EXPECT_EQ(Z_OK, deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY));
+    zs.next_in = (Bytef*)data.data();
+    zs.avail_in = uInt(data.size());
+    zs.next_out = (Bytef*)&deflated[0];
+    zs.avail_out = uInt(deflated.size());
+    EXPECT_EQ(Z_STREAM_END, deflate(&zs, Z_FINISH));
+    deflated.resize(zs.total_out);
+    deflateEnd(&zs);
+
+    std::string block("\x1f\x8b\x08\x04\0\0\0\0\0\xff\x06\0BC\x02\0", 16);
+    PutU16(block, uint16_t(block.size() + 2 + deflated.size() + 8 - 1));
+    block += deflated;
+    PutU32(block, uint32_t(crc32(crc32(0L, Z_NULL, 0), (const Bytef*)data.data(), uInt(data.size()))));
+    PutU32(block, uint32_t(data.size()));
+    EXPECT_LE(block.size(), 65536u);
+
+    return block;
+}
+
+// Splits data into blocks of the given sizes (the last one takes the rest)
+std::string BGZFCompress(const std::string &data, const std::vector<size_t> &sizes,
+                         bool eof_marker = true) {
+    std::string res;
+    size_t pos = 0;
+    for (size_t size : sizes) {
+        size = std::min(size, data.size() - pos);
+        res += BGZFBlock(data.substr(pos, size));
+        pos += size;
+    }
+    while (pos < data.size()) {
+        size_t size = std::min<size_t>(60000, data.size() - pos);
+        res += BGZFBlock(data.substr(pos, size));
+        pos += size;
+    }
+    if (eof_marker)
+        res.append((const char*)BGZF_EOF, sizeof(BGZF_EOF));
+
+    return res;
+}
+
+void WriteFile(const std::filesystem::path &filename, const std::string &content) {
+    std::ofstream out(filename, std::ios::binary);
+    out.write(content.data(), content.size());
+}
+
+std::string RandomNucls(size_t size, unsigned seed) {
+    std::mt19937 rnd(seed);
+    std::string res(size, 'A');
+    for (char &c : res)
+        c = "ACGT"[rnd() % 4];
+    return res;
+}
+
+// Reads everything back with a repeating pattern of chunk sizes
+std::string ReadAll(BGZFReader &reader, size_t total) {
+    const size_t chunks[] = { 1, 7, 4096, 70000, 3 };
+    std::string res;
+    for (size_t i = 0; res.size() < total; ++i) {
+        size_t size = std::min(chunks[i % 5], total - res.size());
+        std::string chunk(size, '\0');
+        if (!reader.read(&chunk[0], size))
+            break;
+        res += chunk;
+    }
+
+    return res;
+}
+
+class BGZFTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        dir_ = fs::tmp::make_temp_dir(std::filesystem::temp_directory_path(), "bgzf_test");
+        file_ = dir_->dir() / "test.gz";
+    }
+
+    fs::TmpDir dir_;
+    std::filesystem::path file_;
+};
+
+struct Record {
+    std::string name, seq, qual;
+};
+
+std::string EncodeBAM(const std::vector<Record> &records) {
+    std::string res("BAM\1", 4);
+    std::string text = "@HD\tVN:1.6\n@SQ\tSN:ref\tLN:100\n";
+    PutU32(res, uint32_t(text.size()));
+    res += text;
+    PutU32(res, 1);
+    PutU32(res, 4);
+    res += std::string("ref", 4);
+    PutU32(res, 100);
+
+    const std::string codes = "=ACMGRSVTWYHKDBN";
+    for (const auto &r : records) {
+        std::string rec;
+        PutU32(rec, uint32_t(-1));               // refID
+        PutU32(rec, uint32_t(-1));               // pos
+        rec.push_back(char(r.name.size() + 1));  // l_read_name
+        rec.push_back(char(255));                // mapq
+        PutU16(rec, 4680);                       // bin
+        PutU16(rec, 0);                          // n_cigar_op
+        PutU16(rec, 4);                          // flag: unmapped
+        PutU32(rec, uint32_t(r.seq.size()));
+        PutU32(rec, uint32_t(-1));               // next refID
+        PutU32(rec, uint32_t(-1));               // next pos
+        PutU32(rec, 0);                          // tlen
+        rec += r.name;
+        rec.push_back('\0');
+        for (size_t i = 0; i < r.seq.size(); i += 2) {
+            uint8_t hi = uint8_t(codes.find(r.seq[i]));
+            uint8_t lo = i + 1 < r.seq.size() ? uint8_t(codes.find(r.seq[i + 1])) : 0;
+            rec.push_back(char(hi << 4 | lo));
+        }
+        if (r.qual.empty())
+            rec.append(r.seq.size(), char(0xFF));
+        else
+            for (char q : r.qual)
+                rec.push_back(char(q - 33));
+        PutU32(res, uint32_t(rec.size()));
+        res += rec;
+    }
+
+    return res;
+}
+
+}
+
+TEST_F(BGZFTest, RoundTrip) {
+    std::string data = RandomNucls(300000, 42);
+    // Small blocks make reads span several of them, an empty block is skipped
+    WriteFile(file_, BGZFCompress(data, { 5, 1, 0, 65536, 4000, 0, 3 }));
+
+    for (unsigned nthreads : { 0u, 1u, 3u }) {
+        BGZFReader reader(file_, nthreads);
+        EXPECT_FALSE(reader.eof());
+        EXPECT_EQ(data, ReadAll(reader, data.size())) << "threads: " << nthreads;
+        EXPECT_TRUE(reader.eof());
+        char c;
+        EXPECT_FALSE(reader.read(&c, 1));
+        EXPECT_TRUE(reader.eof());
+    }
+}
+
+TEST_F(BGZFTest, NoEOFMarker) {
+    std::string data = RandomNucls(100000, 1);
+    WriteFile(file_, BGZFCompress(data, { 1000 }, /* eof marker */ false));
+
+    BGZFReader reader(file_, 0);
+    EXPECT_EQ(data, ReadAll(reader, data.size()));
+    EXPECT_TRUE(reader.eof());
+}
+
+TEST_F(BGZFTest, EmptyStream) {
+    WriteFile(file_, BGZFCompress("", {}));
+
+    for (unsigned nthreads : { 0u, 2u }) {
+        BGZFReader reader(file_, nthreads);
+        EXPECT_TRUE(reader.eof());
+        char c;
+        EXPECT_FALSE(reader.read(&c, 1));
+    }
+
+    WriteFile(file_, "");
+    BGZFReader reader(file_, 0);
+    EXPECT_TRUE(reader.eof());
+}
+
+TEST_F(BGZFTest, BAMRoundTrip) {
+    std::vector<Record> records;
+    std::mt19937 rnd(7);
+    for (size_t i = 0; i < 500; ++i) {
+        Record r;
+        r.name = "read" + std::to_string(i);
+        // Odd and even lengths, some reads without qualities
+        r.seq = RandomNucls(50 + rnd() % 101, unsigned(i));
+        if (i % 5)
+            for (size_t j = 0; j < r.seq.size(); ++j)
+                r.qual.push_back(char(33 + rnd() % 41));
+        records.push_back(r);
+    }
+    std::string bam = EncodeBAM(records);
+    // Tiny blocks make both the header and the records span block boundaries
+    std::vector<size_t> sizes(bam.size() / 37 + 1, 37);
+    WriteFile(file_, BGZFCompress(bam, sizes));
+
+    for (unsigned nthreads : { 0u, 2u }) {
+        FileReadFlags flags;
+        flags.inflate_threads = nthreads;
+        BAMParser parser(file_, flags);
+        SingleRead read;
+        for (const auto &r : records) {
+            ASSERT_FALSE(parser.eof());
+            parser >> read;
+            EXPECT_EQ(r.name, read.name());
+            EXPECT_EQ(r.seq, read.GetSequenceString());
+            if (!r.qual.empty())
+                EXPECT_EQ(r.qual, read.GetPhredQualityString());
+        }
+        EXPECT_TRUE(parser.eof());
+    }
+}
+
+TEST_F(BGZFTest, UnreadCorruptBlock) {
+    std::string data = RandomNucls(30000, 5);
+    std::string content = BGZFCompress(data, { 10000, 10000 });
+    // Corrupt the deflate data of the last block, which is never read
+    size_t last = BGZFBlock(data.substr(0, 10000)).size() + BGZFBlock(data.substr(10000, 10000)).size();
+    content[last + 100] ^= 0x55;
+    WriteFile(file_, content);
+
+    // Blocks read ahead are not inflated on the reading thread until needed,
+    // so dropping them in the destructor is not fatal
+    BGZFReader reader(file_, 0);
+    std::string buf(100, '\0');
+    EXPECT_TRUE(reader.read(&buf[0], buf.size()));
+    EXPECT_EQ(data.substr(0, 100), buf);
+}
+
+class BGZFDeathTest : public BGZFTest {
+  protected:
+    void SetUp() override {
+        BGZFTest::SetUp();
+        ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+        data_ = RandomNucls(200000, 3);
+        compressed_ = BGZFCompress(data_, { 10000, 10000 });
+    }
+
+    void ExpectFatal(const std::string &content, unsigned nthreads = 0) {
+        WriteFile(file_, content);
+        EXPECT_DEATH({
+            BGZFReader reader(file_, nthreads);
+            ReadAll(reader, data_.size());
+            reader.eof();
+        }, "");
+    }
+
+    std::string data_, compressed_;
+};
+
+TEST_F(BGZFDeathTest, TruncatedBlock) {
+    ExpectFatal(compressed_.substr(0, compressed_.size() / 2));
+    ExpectFatal(compressed_.substr(0, compressed_.size() / 2), 2);
+}
+
+TEST_F(BGZFDeathTest, TruncatedHeader) {
+    // The second block starts right after the first one
+    size_t second = BGZFBlock(data_.substr(0, 10000)).size();
+    ExpectFatal(compressed_.substr(0, second + 5));
+    ExpectFatal(compressed_.substr(0, second + 14));
+}
+
+TEST_F(BGZFDeathTest, Corrupted) {
+    std::string content = compressed_;
+    content[0] = 'x';
+    ExpectFatal(content);
+
+    // Broken deflate stream or CRC in the second block
+    size_t second = BGZFBlock(data_.substr(0, 10000)).size();
+    content = compressed_;
+    content[second + 100] ^= 0x55;
+    ExpectFatal(content);
+    ExpectFatal(content, 2);
+
+    // CRC of the second block
+    size_t third = second + BGZFBlock(data_.substr(10000, 10000)).size();
+    content = compressed_;
+    content[third - 8] ^= 1;
+    ExpectFatal(content);
+
+    // Missing block size subfield
+    content = compressed_;
+    content[second + 12] = 'X';
+    ExpectFatal(content);
+}
+
+TEST_F(BGZFDeathTest, TruncatedRead) {
+    // Stream ends in the middle of a read
+    WriteFile(file_, BGZFCompress(data_, {}));
+    EXPECT_DEATH({
+        BGZFReader reader(file_, 0);
+        std::string buf(data_.size() + 10, '\0');
+        reader.read(&buf[0], buf.size());
+    }, "");
+}
+
+TEST_F(BGZFDeathTest, TruncatedBAMRecord) {
+    std::string bam = EncodeBAM({ { "r1", "ACGTACGTA", "IIIIIIIII" }, { "r2", "ACGT", "" } });
+    WriteFile(file_, BGZFCompress(bam.substr(0, bam.size() - 3), { 20 }));
+    EXPECT_DEATH({
+        BAMParser parser(file_);
+        SingleRead read;
+        while (!parser.eof())
+            parser >> read;
+    }, "");
+}
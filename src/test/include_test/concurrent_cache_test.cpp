@@ -0,0 +1,80 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "adt/concurrent_cache.hpp"
+#include "utils/parallel/openmp_wrapper.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+struct Key {
+    uint64_t a, b;
+
+    bool operator==(const Key &other) const { return a == other.a && b == other.b; }
+};
+
+struct KeyHash {
+    size_t operator()(const Key &k) const {
+        uint64_t h = k.a * 0x9E3779B97F4A7C15ull ^ k.b;
+        return h ^ (h >> 29);
+    }
+};
+
+size_t ValueOf(const Key &k) { return k.a * 31 + k.b; }
+}
+
+TEST(ConcurrentCache, InsertFind) {
+    adt::concurrent_cache<Key, size_t, KeyHash> cache(1000);
+    EXPECT_LE(1000u, cache.capacity());
+
+    size_t value = 0;
+    EXPECT_FALSE(cache.find({1, 2}, value));
+    EXPECT_TRUE(cache.insert({1, 2}, 42));
+    EXPECT_TRUE(cache.find({1, 2}, value));
+    EXPECT_EQ(42u, value);
+    EXPECT_FALSE(cache.find({2, 1}, value));
+
+    // Same key is overwritten in place
+    EXPECT_TRUE(cache.insert({1, 2}, 43));
+    EXPECT_TRUE(cache.find({1, 2}, value));
+    EXPECT_EQ(43u, value);
+}
+
+TEST(ConcurrentCache, Eviction) {
+    adt::concurrent_cache<Key, size_t, KeyHash> cache(64);
+    const size_t N = 100 * cache.capacity();
+    for (uint64_t i = 0; i < N; ++i)
+        cache.insert({i, i + 1}, ValueOf({i, i + 1}));
+
+    size_t found = 0;
+    for (uint64_t i = 0; i < N; ++i) {
+        size_t value;
+        if (cache.find({i, i + 1}, value)) {
+            EXPECT_EQ(ValueOf({i, i + 1}), value);
+            found += 1;
+        }
+    }
+    EXPECT_LE(found, cache.capacity());
+    EXPECT_GT(found, 0u);
+}
+
+TEST(ConcurrentCache, Concurrent) {
+    adt::concurrent_cache<Key, size_t, KeyHash> cache(1 << 10);
+    const uint64_t N = 1 << 12;
+    size_t wrong = 0;
+
+#   pragma omp parallel for num_threads(4) reduction(+:wrong)
+    for (uint64_t i = 0; i < 64 * N; ++i) {
+        Key k{i % N, (i * 7) % N};
+        size_t value;
+        if (cache.find(k, value))
+            wrong += (value != ValueOf(k));
+        else
+            cache.insert(k, ValueOf(k));
+    }
+
+    EXPECT_EQ(0u, wrong);
+}
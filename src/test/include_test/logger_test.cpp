@@ -0,0 +1,140 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "utils/logger/log_writers_async.hpp"
+#include "utils/filesystem/temporary.hpp"
+#include "utils/parallel/openmp_wrapper.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace logging;
+
+namespace {
+// Collects the messages, the async writer calls it from a single thread
+struct collecting_writer : public writer {
+    std::vector<std::string> msgs;
+    std::vector<level> levels;
+
+    void write_msg(double, size_t, size_t, level l, const char*, size_t,
+                   const char*, const char *msg) {
+        msgs.emplace_back(msg);
+        levels.push_back(l);
+    }
+};
+
+// Marks the written messages, safe to query while the writer works
+struct marking_writer : public writer {
+    explicit marking_writer(size_t n)
+            : written(n) {}
+
+    std::vector<std::atomic<bool>> written;
+
+    void write_msg(double, size_t, size_t, level, const char*, size_t,
+                   const char*, const char *msg) {
+        written[std::stoul(msg)].store(true);
+    }
+};
+}
+
+TEST(AsyncWriter, Flush) {
+    auto collector = std::make_shared<collecting_writer>();
+    async_writer writer(collector, 4, std::chrono::milliseconds(1000));
+
+    for (size_t i = 0; i < 10; ++i)
+        writer.write_msg(0, 0, 0, L_INFO, "file.cpp", i, "Test", std::to_string(i).c_str());
+    writer.flush();
+
+    ASSERT_EQ(10u, collector->msgs.size());
+    for (size_t i = 0; i < 10; ++i)
+        EXPECT_EQ(std::to_string(i), collector->msgs[i]);
+}
+
+TEST(AsyncWriter, ConcurrentFlush) {
+    const size_t N = 2000;
+    auto marks = std::make_shared<marking_writer>(N);
+    async_writer writer(marks, 8, std::chrono::milliseconds(1000));
+    size_t missing = 0;
+
+#   pragma omp parallel for num_threads(4) reduction(+:missing)
+    for (size_t i = 0; i < N; ++i) {
+        writer.write_msg(0, 0, 0, L_INFO, "file.cpp", i, "Test", std::to_string(i).c_str());
+        writer.flush();
+        // Flush returns only after the own message of the thread is written
+        missing += !marks->written[i].load();
+    }
+
+    EXPECT_EQ(0u, missing);
+}
+
+TEST(AsyncWriter, ErrorIsWrittenImmediately) {
+    auto collector = std::make_shared<collecting_writer>();
+    async_writer writer(collector, 16, std::chrono::milliseconds(100000));
+
+    writer.write_msg(0, 0, 0, L_INFO, "file.cpp", 1, "Test", "info");
+    writer.write_msg(0, 0, 0, L_ERROR, "file.cpp", 2, "Test", "error");
+
+    ASSERT_EQ(2u, collector->msgs.size());
+    EXPECT_EQ("error", collector->msgs[1]);
+    EXPECT_EQ(L_ERROR, collector->levels[1]);
+}
+
+TEST(AsyncWriter, ManyThreads) {
+    const size_t N = 2000;
+    auto collector = std::make_shared<collecting_writer>();
+    {
+        async_writer writer(collector, 8, std::chrono::milliseconds(1));
+
+#       pragma omp parallel for num_threads(4)
+        for (size_t i = 0; i < N; ++i) {
+            std::string msg = std::to_string(omp_get_thread_num()) + " " + std::to_string(i);
+            writer.write_msg(0, 0, 0, L_DEBUG, "file.cpp", i, "Test", msg.c_str());
+        }
+        // The destructor writes out the rest
+    }
+
+    ASSERT_EQ(N, collector->msgs.size());
+    // Messages of every thread keep their order
+    std::map<std::string, size_t> last;
+    std::vector<bool> seen(N, false);
+    for (const auto &msg : collector->msgs) {
+        size_t space = msg.find(' ');
+        std::string thread = msg.substr(0, space);
+        size_t i = std::stoul(msg.substr(space + 1));
+        EXPECT_FALSE(seen[i]);
+        seen[i] = true;
+        if (last.count(thread)) {
+            EXPECT_LT(last[thread], i);
+        }
+        last[thread] = i;
+    }
+}
+
+TEST(AsyncWriter, EnabledByProperties) {
+    auto dir = fs::tmp::make_temp_dir(std::filesystem::temp_directory_path(), "logger");
+    auto filename = dir->dir() / "log.properties";
+    std::ofstream(filename) << "default=INFO\nasync=true\n";
+
+    properties props(filename);
+    EXPECT_TRUE(props.async);
+    EXPECT_FALSE(properties(L_INFO).async);
+
+    auto collector = std::make_shared<collecting_writer>();
+    logger lg(props);
+    lg.add_writer(collector);
+    for (size_t i = 0; i < 10; ++i)
+        lg.log(L_INFO, "file.cpp", i, "Test", std::to_string(i));
+    lg.flush();
+
+    ASSERT_EQ(10u, collector->msgs.size());
+    for (size_t i = 0; i < 10; ++i)
+        EXPECT_EQ(std::to_string(i), collector->msgs[i]);
+}
@@ -0,0 +1,82 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "sequence/myers_profile.hpp"
+#include "sequence/sequence_tools.hpp"
+
+#include <random>
+#include <string>
+#include <gtest/gtest.h>
+
+static std::string RandomString(std::mt19937_64 &rnd, size_t len) {
+    std::string res(len, 'A');
+    for (char &c : res)
+        c = nucl(rnd() & 3);
+    return res;
+}
+
+static std::string Mutate(std::mt19937_64 &rnd, const std::string &s, size_t len) {
+    std::string res = s.substr(0, std::min(s.size(), len));
+    while (res.size() < len)
+        res += nucl(rnd() & 3);
+    for (char &c : res)
+        if (rnd() % 10 == 0)
+            c = nucl(rnd() & 3);
+    return res;
+}
+
+TEST( MyersProfile, Simple ) {
+    MyersProfile p("ACGT");
+    int pos = -2;
+    EXPECT_EQ(0, p.BestPrefix(Sequence("ACGTTTT"), 7, 10, pos));
+    EXPECT_EQ(3, pos);
+    EXPECT_EQ(1, p.BestPrefix(Sequence("AGTTTT"), 6, 10, pos));
+    EXPECT_EQ(2, pos);
+    EXPECT_EQ(std::numeric_limits<int>::max(), p.BestPrefix(Sequence("TTTTTT"), 6, 2, pos));
+}
+
+TEST( MyersProfile, SameAsSHWDistance ) {
+    std::mt19937_64 rnd(42);
+    for (size_t it = 0; it < 2000; ++it) {
+        size_t m = 1 + rnd() % 500, n = 1 + rnd() % 500;
+        std::string a = RandomString(rnd, m);
+        std::string b = rnd() & 1 ? Mutate(rnd, a, n) : RandomString(rnd, n);
+        int k = int(rnd() % 300);
+
+        int pos1 = -2, pos2 = -2;
+        int score = SHWDistance(a, b, k, pos1);
+        EXPECT_EQ(score, MyersProfile(a).BestPrefix(Sequence(b), n, k, pos2));
+        if (score != std::numeric_limits<int>::max()) {
+            EXPECT_EQ(pos1, pos2);
+        }
+    }
+}
+
+TEST( MyersProfile, SameAsSHWDistanceExtended ) {
+    std::mt19937_64 rnd(239);
+    for (size_t it = 0; it < 2000; ++it) {
+        size_t m = 1 + rnd() % 500, n = 1 + rnd() % 500;
+        std::string a = RandomString(rnd, m);
+        std::string b = rnd() & 1 ? Mutate(rnd, a, n) : RandomString(rnd, n);
+        int k = int(rnd() % 300);
+
+        std::vector<int> pos1, scores1;
+        SHWDistanceExtended(a, b, k, pos1, scores1);
+
+        // Pattern is taken as a part of a larger profile to check the shifts
+        std::string text = RandomString(rnd, rnd() % 100) + b + RandomString(rnd, rnd() % 100);
+        size_t from = text.find(b);
+        MyersProfile p(MyersProfile(text), from, b.size());
+        std::vector<uint8_t> codes;
+        for (char c : a)
+            codes.push_back(dignucl(c));
+        std::vector<int> pos2, scores2;
+        p.PrefixScores(codes.data(), codes.size(), k, pos2, scores2);
+
+        EXPECT_EQ(pos1, pos2);
+        EXPECT_EQ(scores1, scores2);
+    }
+}
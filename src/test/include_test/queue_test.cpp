@@ -0,0 +1,81 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "adt/queue_iterator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+
+namespace {
+// Small priorities fall into buckets, large ones into the overflow heap
+struct ModPriority {
+    size_t operator()(uint64_t x) const {
+        return x % 7 == 0 ? 1000 + x % 13 : x % 50;
+    }
+};
+
+typedef adt::bucket_priority_queue<uint64_t, ModPriority> BucketQueue;
+typedef adt::erasable_priority_queue_key_dirty_heap<uint64_t, ModPriority> HeapQueue;
+}
+
+TEST( BucketQueue, SameOrderAsHeap ) {
+    std::mt19937_64 rnd(42);
+    std::vector<uint64_t> seed;
+    for (size_t i = 0; i < 5000; ++i)
+        seed.push_back(rnd() % 100000);
+
+    BucketQueue bucket(seed.begin(), seed.end(), ModPriority(), 512);
+    HeapQueue heap(seed.begin(), seed.end(), ModPriority());
+    ASSERT_EQ(bucket.size(), heap.size());
+
+    std::set<uint64_t> present(seed.begin(), seed.end());
+    while (!heap.empty()) {
+        ASSERT_FALSE(bucket.empty());
+        ASSERT_EQ(bucket.top(), heap.top());
+
+        uint64_t x = rnd() % 100000;
+        switch (rnd() % 4) {
+            case 0:
+                if (present.insert(x).second) {
+                    bucket.push(x);
+                    heap.push(x);
+                }
+                break;
+            case 1:
+                present.erase(x);
+                EXPECT_EQ(bucket.erase(x), heap.erase(x));
+                break;
+            default:
+                present.erase(heap.top());
+                bucket.pop();
+                heap.pop();
+        }
+        ASSERT_EQ(bucket.size(), heap.size());
+    }
+    EXPECT_TRUE(bucket.empty());
+}
+
+TEST( BucketQueue, LazyErase ) {
+    std::vector<uint64_t> seed = {1, 2, 3, 51, 7, 14};
+    BucketQueue queue(seed.begin(), seed.end(), ModPriority());
+    EXPECT_EQ(queue.size(), 6);
+    EXPECT_EQ(queue.top(), 1);
+
+    EXPECT_TRUE(queue.erase(51));
+    EXPECT_FALSE(queue.erase(51));
+    EXPECT_EQ(queue.top(), 1);
+    queue.pop();
+    EXPECT_EQ(queue.top(), 2);
+    queue.pop();
+    EXPECT_EQ(queue.top(), 3);
+
+    queue.push(101);
+    EXPECT_EQ(queue.top(), 101);
+    queue.clear();
+    EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,112 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "io/reads/read_batch.hpp"
+#include "io/reads/file_reader.hpp"
+#include "io/reads/fasta_fastq_gz_parser.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+using namespace io;
+
+TEST(ReadBatch, RoundTrip) {
+    ReadBatch batch;
+    batch.push_back("read1", "comment", "ACGTTGCA", "IIIIHHHH", PhredOffset);
+    batch.push_back("read2", "", "ACGNNRYA");
+    batch.push_back("", "", "acgtACGT");
+    batch.push_back("", "", "");
+    ASSERT_EQ(4u, batch.size());
+
+    EXPECT_EQ("read1", batch[0].name());
+    EXPECT_EQ("comment", batch[0].comment());
+    EXPECT_EQ("ACGTTGCA", batch[0].GetSequenceString());
+    EXPECT_TRUE(batch[0].IsValid());
+    EXPECT_EQ(8u, batch[0].qual_size());
+    EXPECT_EQ('I' - PhredOffset, batch[0].quality(0));
+    EXPECT_EQ('H' - PhredOffset, batch[0].quality(7));
+    EXPECT_EQ(Sequence("ACGTTGCA"), batch[0].sequence());
+    EXPECT_EQ(!Sequence("ACGTTGCA"), batch[0].sequence(true));
+    EXPECT_EQ(2, batch[0][2]);
+
+    EXPECT_EQ("ACGNNRYA", batch[1].GetSequenceString());
+    EXPECT_FALSE(batch[1].IsValid());
+    EXPECT_EQ(0u, batch[1].qual_size());
+
+    // Lowercase symbols are kept verbatim
+    EXPECT_EQ("acgtACGT", batch[2].GetSequenceString());
+    EXPECT_TRUE(batch[2].IsValid());
+    EXPECT_EQ(0u, batch[3].size());
+
+    SingleRead expected("read1", "comment", "ACGTTGCA", "IIIIHHHH", PhredOffset);
+    SingleRead read("some", "other", "TTTTTTTTTTTTTTTTTTTTTT", "IIIIIIIIIIIIIIIIIIIIII", PhredOffset);
+    batch[0].CopyTo(read);
+    EXPECT_EQ(expected.name(), read.name());
+    EXPECT_EQ(expected.comment(), read.comment());
+    EXPECT_EQ(expected.GetSequenceString(), read.GetSequenceString());
+    EXPECT_EQ(expected.GetQualityString(), read.GetQualityString());
+    EXPECT_TRUE(read.IsValid());
+
+    std::stringstream expected_bin, bin;
+    expected.BinWrite(expected_bin, true, 42);
+    batch[0].BinWrite(bin, true, 42);
+    EXPECT_EQ(expected_bin.str(), bin.str());
+
+    // Copying between the batches
+    ReadBatch other;
+    other.push_back(batch[1]);
+    other.push_back(batch[0]);
+    other.push_back(batch[2]);
+    EXPECT_EQ("ACGNNRYA", other[0].GetSequenceString());
+    EXPECT_EQ("read1", other[1].name());
+    EXPECT_EQ('H' - PhredOffset, other[1].quality(7));
+    EXPECT_EQ("acgtACGT", other[2].GetSequenceString());
+
+    batch.clear();
+    EXPECT_TRUE(batch.empty());
+}
+
+TEST(ReadBatch, FileReadStream) {
+    const char *filename = "./src/test/data/s_test.fastq.gz";
+
+    // Batched reading yields the same reads as the parser itself
+    FastaFastqGzParser parser(filename);
+    FileReadStream stream(filename);
+    size_t cnt = 0;
+    SingleRead expected, read;
+    while (!parser.eof()) {
+        ASSERT_FALSE(stream.eof());
+        parser >> expected;
+        stream >> read;
+        EXPECT_EQ(expected.name(), read.name());
+        EXPECT_EQ(expected.comment(), read.comment());
+        EXPECT_EQ(expected.GetSequenceString(), read.GetSequenceString());
+        EXPECT_EQ(expected.GetQualityString(), read.GetQualityString());
+        EXPECT_EQ(expected.IsValid(), read.IsValid());
+        cnt += 1;
+    }
+    EXPECT_TRUE(stream.eof());
+    EXPECT_LT(0u, cnt);
+
+    stream.reset();
+    ReadBatch batch;
+    size_t total = 0;
+    while (!stream.eof())
+        total += stream.Read(batch, 100);
+    EXPECT_EQ(cnt, total);
+    EXPECT_EQ(cnt, batch.size());
+
+    // The chunk stops at the byte budget, but always makes progress
+    stream.reset();
+    batch.clear();
+    EXPECT_EQ(1u, stream.Read(batch, 100, 1));
+    size_t bytes = batch.bytes();
+    size_t chunk = stream.Read(batch, 100, 3 * bytes);
+    EXPECT_LE(1u, chunk);
+    EXPECT_GT(100u, chunk);
+    EXPECT_LT(batch.bytes() - bytes, 4 * bytes);
+}
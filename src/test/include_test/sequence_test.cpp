@@ -7,6 +7,8 @@
 
 #include "sequence/sequence.hpp"
 #include "sequence/nucl.hpp"
+#include "sequence/suffix_prefix_hamming.hpp"
+#include <random>
 #include <string>
 #include <gtest/gtest.h>
 
@@ -43,3 +45,34 @@ TEST( Sequence, ReverseComplement ) {
     Sequence s2 = Sequence("ACG");
     EXPECT_EQ("CGT", (!s2).str());
 }
+
+TEST( Sequence, SuffixPrefixHamming ) {
+    std::mt19937 rnd(7);
+    auto random_seq = [&](size_t size) {
+        std::string s(size, 'A');
+        for (char &c : s)
+            c = nucl(char(rnd() % 4));
+        return Sequence(s);
+    };
+
+    for (size_t iter = 0; iter < 20; ++iter) {
+        // Views with offsets and reverse-complement ones are packed as well
+        Sequence left = random_seq(150).Subseq(iter), right = !random_seq(150 + iter);
+        // Make some of the overlaps similar
+        if (iter % 2)
+            right = left.Last(70) + right;
+
+        SuffixPrefixHamming hamming(left, right, 100);
+        for (size_t l = 0; l <= 100; ++l) {
+            Sequence s1 = left.Last(l), s2 = right.First(l);
+            size_t dist = 0;
+            for (size_t i = 0; i < l; ++i)
+                dist += s1[i] != s2[i];
+            EXPECT_EQ(dist, hamming.Distance(l));
+            EXPECT_EQ(dist <= 5, hamming.LimitedDistance(l, 5) <= 5);
+        }
+        if (iter % 2) {
+            EXPECT_EQ(0, hamming.Distance(70));
+        }
+    }
+}